@@ -7,6 +7,7 @@ extern "C" {
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #ifdef _WIN32
 	#ifdef _HPCS_BUILD_DLL
@@ -46,6 +47,22 @@ enum HPCS_RetCode {
 	HPCS_E_NOTIMPL
 };
 
+enum HPCS_IOBackend {
+	HPCS_IO_AUTO,	/* Memory-map data files, use stdio if mapping fails */
+	HPCS_IO_STDIO	/* Always read data files through stdio */
+};
+
+enum HPCS_AsyncBackend {
+	HPCS_ASYNC_AUTO,	/* Use io_uring if it is available, threads otherwise */
+	HPCS_ASYNC_THREADS,	/* Read files with blocking calls on worker threads */
+	HPCS_ASYNC_IO_URING	/* Read files through io_uring, parse them on worker threads */
+};
+
+enum HPCS_AsyncOp {
+	HPCS_ASYNC_MDATA,	/* Read as by hpcs_read_mdata() */
+	HPCS_ASYNC_MHEADER	/* Read as by hpcs_read_mheader() */
+};
+
 struct HPCS_Date {
 	uint32_t year;
 	uint8_t month;
@@ -65,6 +82,9 @@ struct HPCS_Wavelength {
 	uint16_t interval;
 };
 
+/* Opaque storage that is freed at once with the object that owns it */
+struct HPCS_Arena;
+
 struct HPCS_MeasuredData {
 	char* file_description;
 	char* sample_info;
@@ -80,6 +100,55 @@ struct HPCS_MeasuredData {
 	enum HPCS_FileType file_type;
 	struct HPCS_TVPair* data;
 	size_t data_count;
+	size_t predicted_count;		/* Number of samples predicted from the size of the file, also by hpcs_read_mheader().
+					   Exact for GC data, an upper bound for LC and CE data */
+	struct HPCS_Arena* arena;	/* Storage of the strings and the samples of an object allocated by
+					   hpcs_alloc_mdata_arena(), NULL otherwise */
+};
+
+/* Times of equally spaced samples, sample <tt>i</tt> is taken at <tt>t0 + i * dt</tt>.
+   Use \ref hpcs_time_axis_fill() to get the times as an array. */
+struct HPCS_TimeAxis {
+	double t0;		/* Time of the first sample, in minutes */
+	double dt;		/* Time between two samples, in minutes */
+	size_t count;		/* Number of samples */
+};
+
+/* Signal trace as a contiguous array of values */
+struct HPCS_Signal {
+	double* values;
+	struct HPCS_TimeAxis time;
+};
+
+/* Signal trace in single precision */
+struct HPCS_FloatSignal {
+	float* values;
+	struct HPCS_TimeAxis time;
+};
+
+/* Signal of a 30/130 data file as the integer counts of the detector. The signal value of a sample
+   is <tt>counts[i] * step + shift</tt>. */
+struct HPCS_RawSignal {
+	int32_t* counts;
+	struct HPCS_TimeAxis time;
+	double step;		/* Signal value of one count */
+	double shift;		/* Offset of the signal value */
+};
+
+/* Smallest, largest and mean value of the samples in each bucket of a signal trace. Bucket <tt>i</tt>
+   holds the samples taken from <tt>time.t0 + i * time.dt</tt> up to the start of the next bucket. */
+struct HPCS_Envelope {
+	double* min;
+	double* max;
+	double* mean;
+	struct HPCS_TimeAxis time;	/* Start and width of the buckets, count is the number of buckets */
+};
+
+/* Samples picked out of a signal trace, they are not equally spaced in time */
+struct HPCS_SampledSignal {
+	double* times;		/* Time of each sample, in minutes */
+	double* values;
+	size_t count;
 };
 
 struct HPCS_MethodInfoBlock {
@@ -87,11 +156,103 @@ struct HPCS_MethodInfoBlock {
 	char* value;
 };
 
+/* Opaque hash index of method information blocks by name */
+struct HPCS_MethodIndex;
+
+/* Names, values and the index are stored in the same allocation as the blocks */
 struct HPCS_MethodInfo {
 	struct HPCS_MethodInfoBlock* blocks;
 	size_t count;
+	struct HPCS_MethodIndex* index;
+};
+
+/**
+ * User-supplied storage from which a data file is read.
+ * All callbacks return zero on success and non-zero value on failure.
+ */
+struct HPCS_IOSource {
+	void* handle;	/* Passed as the first argument to the callbacks */
+	/* Reads up to <tt>length</tt> bytes from the current position. Zero bytes read indicates the end of the data */
+	int (LIBHPCS_CC *read)(void* handle, void* dst, const size_t length, size_t* bytes_read);
+	/* Moves the current position to <tt>offset</tt> bytes from the beginning */
+	int (LIBHPCS_CC *seek)(void* handle, const uint64_t offset);
+	/* Returns the total size of the data in bytes */
+	int (LIBHPCS_CC *size)(void* handle, uint64_t* size);
+};
+
+/**
+ * Memory allocation functions used by libHPCS instead of the C library, see \ref hpcs_set_allocator().
+ * The callbacks have the semantics of <tt>malloc()</tt>, <tt>realloc()</tt> and <tt>free()</tt>.
+ */
+struct HPCS_Allocator {
+	void* handle;	/* Passed as the first argument to the callbacks */
+	void* (LIBHPCS_CC *allocate)(void* handle, const size_t size);
+	/* Called with NULL <tt>ptr</tt> to allocate new memory as well */
+	void* (LIBHPCS_CC *reallocate)(void* handle, void* ptr, const size_t size);
+	/* Never called with NULL <tt>ptr</tt> */
+	void (LIBHPCS_CC *release)(void* handle, void* ptr);
+};
+
+/* State of the built-in memory source, see \ref hpcs_io_source_memory() */
+struct HPCS_IOMemory {
+	const char* bytes;
+	size_t length;
+	size_t position;
+};
+
+/* Outcome of a request submitted by \ref hpcs_async_submit() */
+struct HPCS_AsyncResult {
+	struct HPCS_MeasuredData* mdata;
+	void* user_data;
+	enum HPCS_RetCode code;
+};
+
+/* Data file of a run directory read by \ref hpcs_read_run() */
+struct HPCS_RunTrace {
+	char* name;			/* Name of the file within the run directory */
+	enum HPCS_FileType file_type;	/* Type of the signal determined by probing the header */
+	struct HPCS_MeasuredData* mdata;
+	enum HPCS_RetCode code;		/* Outcome of reading the file */
+};
+
+/* Method file of a run directory read by \ref hpcs_read_run() */
+struct HPCS_RunMethod {
+	char* name;			/* Path of the file relative to the run directory */
+	struct HPCS_MethodInfo* minfo;
+	enum HPCS_RetCode code;		/* Outcome of reading the file */
+};
+
+/* Content of a ChemStation run directory (.D) */
+struct HPCS_Run {
+	char* path;
+	struct HPCS_RunTrace* traces;
+	size_t trace_count;
+	struct HPCS_RunMethod* methods;
+	size_t method_count;
 };
 
+/* Opaque handle of a context for asynchronous reading */
+struct HPCS_AsyncContext;
+
+/* Opaque handle of a reader that reuses its buffers across files */
+struct HPCS_Reader;
+
+/* Opaque handle of a signal stream */
+struct HPCS_SignalStream;
+
+/* Opaque handle of a multi-resolution summary of a signal trace */
+struct HPCS_Pyramid;
+
+/**
+ * Receives a chunk of decoded samples from \ref hpcs_stream_mdata().
+ *
+ * \param pairs Decoded samples. The array is valid only during the call.
+ * \param count Number of samples in the chunk.
+ * \param user_data Pointer passed to \ref hpcs_stream_mdata().
+ * \return Zero to continue streaming, non-zero value to stop.
+ */
+typedef int (LIBHPCS_CC *HPCS_StreamCallback)(const struct HPCS_TVPair* pairs, const size_t count, void* user_data);
+
 /**
  * Allocates \ref HPCS_MeasuredData object.
  *
@@ -101,6 +262,19 @@ struct HPCS_MethodInfo {
  */
 LIBHPCS_API struct HPCS_MeasuredData* LIBHPCS_CC hpcs_alloc_mdata();
 
+/**
+ * Allocates \ref HPCS_MeasuredData object that keeps everything read into it in an arena.
+ *
+ * The strings are stored in the allocation of the object itself and the samples in one more block,
+ * reading a file thus makes two allocations instead of one for every string. The object can be
+ * passed to any function that reads \ref HPCS_MeasuredData; reading another file into it keeps the memory
+ * of the previous one until the object is freed.
+ * The allocated object must be freed by calling \ref hpcs_free_mdata() which frees all of it at once.
+ *
+ * \return Pointer to the allocated \ref HPCS_MeasuredData object.
+ */
+LIBHPCS_API struct HPCS_MeasuredData* LIBHPCS_CC hpcs_alloc_mdata_arena();
+
 /**
  * Allocates \ref HPCS_MethodInfo object.
  *
@@ -110,6 +284,65 @@ LIBHPCS_API struct HPCS_MeasuredData* LIBHPCS_CC hpcs_alloc_mdata();
  */
 LIBHPCS_API struct HPCS_MethodInfo* LIBHPCS_CC hpcs_alloc_minfo();
 
+/**
+ * Allocates \ref HPCS_Signal object.
+ *
+ * The allocated object must be freed by calling \ref hpcs_free_signal().
+ *
+ * \return Pointer to the allocated \ref HPCS_Signal object.
+ */
+LIBHPCS_API struct HPCS_Signal* LIBHPCS_CC hpcs_alloc_signal();
+
+/**
+ * Allocates \ref HPCS_FloatSignal object.
+ *
+ * The allocated object must be freed by calling \ref hpcs_free_float_signal().
+ *
+ * \return Pointer to the allocated \ref HPCS_FloatSignal object.
+ */
+LIBHPCS_API struct HPCS_FloatSignal* LIBHPCS_CC hpcs_alloc_float_signal();
+
+/**
+ * Allocates \ref HPCS_RawSignal object.
+ *
+ * The allocated object must be freed by calling \ref hpcs_free_raw_signal().
+ *
+ * \return Pointer to the allocated \ref HPCS_RawSignal object.
+ */
+LIBHPCS_API struct HPCS_RawSignal* LIBHPCS_CC hpcs_alloc_raw_signal();
+
+/**
+ * Allocates \ref HPCS_Envelope object.
+ *
+ * The allocated object must be freed by calling \ref hpcs_free_envelope().
+ *
+ * \return Pointer to the allocated \ref HPCS_Envelope object.
+ */
+LIBHPCS_API struct HPCS_Envelope* LIBHPCS_CC hpcs_alloc_envelope();
+
+/**
+ * Allocates \ref HPCS_SampledSignal object.
+ *
+ * The allocated object must be freed by calling \ref hpcs_free_sampled_signal().
+ *
+ * \return Pointer to the allocated \ref HPCS_SampledSignal object.
+ */
+LIBHPCS_API struct HPCS_SampledSignal* LIBHPCS_CC hpcs_alloc_sampled_signal();
+
+/**
+ * Frees \ref HPCS_Envelope object.
+ *
+ * \param envelope Pointer to object to free.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_free_envelope(struct HPCS_Envelope* const envelope);
+
+/**
+ * Frees \ref HPCS_FloatSignal object.
+ *
+ * \param signal Pointer to object to free.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_free_float_signal(struct HPCS_FloatSignal* const signal);
+
 /**
  * Frees \ref HPCS_MeasuredData object.
  *
@@ -124,6 +357,49 @@ LIBHPCS_API void LIBHPCS_CC hpcs_free_mdata(struct HPCS_MeasuredData* const mdat
  */
 LIBHPCS_API void LIBHPCS_CC hpcs_free_minfo(struct HPCS_MethodInfo* const minfo);
 
+/**
+ * Frees a pyramid built by \ref hpcs_build_pyramid().
+ *
+ * \param pyramid Pyramid to free. The signal the pyramid was built from is not freed.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_free_pyramid(struct HPCS_Pyramid* const pyramid);
+
+/**
+ * Frees \ref HPCS_RawSignal object.
+ *
+ * \param raw Pointer to object to free.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_free_raw_signal(struct HPCS_RawSignal* const raw);
+
+/**
+ * Frees \ref HPCS_Run object along with all traces and method information it holds.
+ *
+ * \param run Pointer to object to free.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_free_run(struct HPCS_Run* const run);
+
+/**
+ * Frees an array of \ref HPCS_Run objects returned by \ref hpcs_read_run_tree().
+ *
+ * \param runs Array to free.
+ * \param count Number of runs in the array.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_free_runs(struct HPCS_Run** const runs, const size_t count);
+
+/**
+ * Frees \ref HPCS_SampledSignal object.
+ *
+ * \param sampled Pointer to object to free.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_free_sampled_signal(struct HPCS_SampledSignal* const sampled);
+
+/**
+ * Frees \ref HPCS_Signal object.
+ *
+ * \param signal Pointer to object to free.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_free_signal(struct HPCS_Signal* const signal);
+
 /**
  * Translates \ref HPCS_RetCode to a string with human-readable error message.
  *
@@ -132,6 +408,56 @@ LIBHPCS_API void LIBHPCS_CC hpcs_free_minfo(struct HPCS_MethodInfo* const minfo)
  */
 LIBHPCS_API const char* LIBHPCS_CC hpcs_error_to_string(const enum HPCS_RetCode err);
 
+/**
+ * Sets the functions that allocate all memory used by libHPCS, including the objects returned to
+ * the caller. NULL or an allocator with any of the callbacks missing restores the C library functions.
+ *
+ * The setting is global. It must be changed only while no other thread uses libHPCS and while no
+ * object allocated by libHPCS exists, the objects are freed by the allocator that is set at the time.
+ *
+ * \param alloc \ref HPCS_Allocator to use, the structure is copied.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_set_allocator(const struct HPCS_Allocator* const alloc);
+
+/**
+ * Selects how \ref hpcs_read_mdata() accesses data files.
+ * \ref hpcs_read_mheader() always fetches the header with a single read.
+ *
+ * The default is \ref HPCS_IO_AUTO. The setting is global and should be
+ * changed only while no other thread is reading data files.
+ *
+ * \param backend \ref HPCS_IOBackend to use.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_set_io_backend(const enum HPCS_IOBackend backend);
+
+/**
+ * Sets up \ref HPCS_IOSource that reads from a file descriptor.
+ * The descriptor must be seekable and is not closed by libHPCS.
+ *
+ * \param io \ref HPCS_IOSource to set up.
+ * \param fd File descriptor to read from.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_io_source_fd(struct HPCS_IOSource* io, const int fd);
+
+/**
+ * Sets up \ref HPCS_IOSource that reads from a <tt>FILE</tt> stream.
+ * The stream must be opened in binary mode and is not closed by libHPCS.
+ *
+ * \param io \ref HPCS_IOSource to set up.
+ * \param fh Stream to read from.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_io_source_file(struct HPCS_IOSource* io, FILE* fh);
+
+/**
+ * Sets up \ref HPCS_IOSource that reads from memory.
+ *
+ * \param io \ref HPCS_IOSource to set up.
+ * \param memory \ref HPCS_IOMemory object that holds the state of the source. It must outlive the source.
+ * \param bytes Content of the data file.
+ * \param length Length of the content in bytes.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_io_source_memory(struct HPCS_IOSource* io, struct HPCS_IOMemory* memory, const void* bytes, const size_t length);
+
 /**
  * Reads content of a HP/Agilent ChemStation data file.
  *
@@ -141,6 +467,276 @@ LIBHPCS_API const char* LIBHPCS_CC hpcs_error_to_string(const enum HPCS_RetCode
  */
 LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata(const char* filename, struct HPCS_MeasuredData* mdata);
 
+/**
+ * Builds a checkpoint index of a HP/Agilent ChemStation data file.
+ *
+ * LC and CE data store differences between consecutive samples, reading a sample requires
+ * to decode everything that precedes it. The index stores the state of the decoder every
+ * <tt>interval</tt> samples so that \ref hpcs_read_signal_range() can start decoding close to
+ * any sample. The index is written next to the data file, its name is the name of the data file
+ * with <tt>.idx</tt> appended. It records the size and the modification time of the data file
+ * and is ignored once either of them changes.
+ *
+ * GC data can be read from any sample directly and are not indexed.
+ *
+ * \param filename Path to the data file to index.
+ * \param interval Number of samples between checkpoints. Pass zero to use the default interval.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_build_index(const char* filename, const size_t interval);
+
+/**
+ * Builds checkpoint indices of multiple HP/Agilent ChemStation data files in parallel.
+ *
+ * Each file is indexed as if by \ref hpcs_build_index(). A file that cannot be indexed
+ * does not abort the batch, the outcome of each file is reported in <tt>codes</tt>.
+ *
+ * \param paths Array of <tt>n</tt> paths to the files to index.
+ * \param n Number of files to index.
+ * \param interval Number of samples between checkpoints. Pass zero to use the default interval.
+ * \param codes Array of <tt>n</tt> \ref HPCS_RetCode elements set to the result of indexing each file.
+ * \param threads Number of threads to use. Pass zero to use one thread per online CPU.
+ * \return \ref HPCS_RetCode to indicate if the batch could be processed.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_build_index_batch(const char** paths, const size_t n, const size_t interval,
+								enum HPCS_RetCode* codes, int threads);
+
+/**
+ * Reads content of multiple HP/Agilent ChemStation data files in parallel.
+ *
+ * Each file is read as if by \ref hpcs_read_mdata(). A file that cannot be read
+ * does not abort the batch, the outcome of each file is reported in <tt>codes</tt>.
+ *
+ * \param paths Array of <tt>n</tt> paths to the files to read.
+ * \param n Number of files to read.
+ * \param out Array of <tt>n</tt> pointers to \ref HPCS_MeasuredData objects allocated by \ref hpcs_alloc_mdata().
+ * \param codes Array of <tt>n</tt> \ref HPCS_RetCode elements set to the result of reading each file.
+ * \param threads Number of threads to use. Pass zero to use one thread per online CPU.
+ * \return \ref HPCS_RetCode to indicate if the batch could be processed.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata_batch(const char** paths, const size_t n, struct HPCS_MeasuredData** out,
+							       enum HPCS_RetCode* codes, int threads);
+
+/**
+ * Creates a reader that keeps its temporary storage between reads of data files.
+ *
+ * Once the buffers of a reader have been allocated by the first files it has read,
+ * \ref hpcs_reader_read_mdata() allocates only the data it returns. A reader must not be used
+ * by more than one thread at a time, a worker thread is expected to have a reader of its own.
+ * The reader must be destroyed by calling \ref hpcs_reader_destroy().
+ *
+ * The storage of the reader itself can come from an allocator of its own, for example a memory pool
+ * of the worker thread. The objects read through the reader are allocated by the allocator set with
+ * \ref hpcs_set_allocator() because they are freed by the <tt>hpcs_free_*()</tt> functions.
+ *
+ * \param reader Set to the created reader.
+ * \param alloc \ref HPCS_Allocator of the storage of the reader, the structure is copied. NULL or an allocator
+ *        with any of the callbacks missing selects the one set with \ref hpcs_set_allocator().
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_reader_create(struct HPCS_Reader** reader, const struct HPCS_Allocator* const alloc);
+
+/**
+ * Destroys a reader created by \ref hpcs_reader_create().
+ * Objects read through the reader remain valid.
+ *
+ * \param reader Reader to destroy.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_reader_destroy(struct HPCS_Reader* reader);
+
+/**
+ * Reads content of HP/Agilent ChemStation data file as \ref hpcs_read_mdata() does, using the buffers of a reader.
+ *
+ * Temporary strings are kept by the reader and files read through stdio use its buffer.
+ * Combined with an object allocated by \ref hpcs_alloc_mdata_arena() a typical file is read with
+ * a single allocation for the samples besides the object itself.
+ *
+ * \param reader Reader created by \ref hpcs_reader_create().
+ * \param filename Path to the file to read.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_reader_read_mdata(struct HPCS_Reader* reader, const char* filename, struct HPCS_MeasuredData* mdata);
+
+/**
+ * Creates a context that reads data files in the background.
+ *
+ * The context must be destroyed by calling \ref hpcs_async_destroy().
+ *
+ * \param ctx Set to the created context.
+ * \param backend \ref HPCS_AsyncBackend to use. io_uring is used only on Linux and falls back to threads if the kernel does not support it.
+ * \param threads Number of worker threads. Pass zero to use one thread per online CPU.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_async_create(struct HPCS_AsyncContext** ctx, const enum HPCS_AsyncBackend backend, int threads);
+
+/**
+ * Destroys a context created by \ref hpcs_async_create().
+ * Waits for the requests in flight to complete, their results are discarded.
+ *
+ * \param ctx Context to destroy.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_async_destroy(struct HPCS_AsyncContext* ctx);
+
+/**
+ * Returns a file descriptor that becomes readable when results are available.
+ * The descriptor is an eventfd on Linux and a pipe on other UNIX systems. It can be
+ * waited on with <tt>poll()</tt> or <tt>epoll</tt> and must not be read or closed by the caller.
+ *
+ * \param ctx Context to query.
+ * \return File descriptor, or -1 if the platform has none.
+ */
+LIBHPCS_API int LIBHPCS_CC hpcs_async_fd(const struct HPCS_AsyncContext* ctx);
+
+/**
+ * Returns the \ref HPCS_AsyncBackend the context actually uses.
+ *
+ * \param ctx Context to query.
+ * \return Either \ref HPCS_ASYNC_THREADS or \ref HPCS_ASYNC_IO_URING, \ref HPCS_ASYNC_THREADS if \p ctx is <tt>NULL</tt>.
+ */
+LIBHPCS_API enum HPCS_AsyncBackend LIBHPCS_CC hpcs_async_get_backend(const struct HPCS_AsyncContext* ctx);
+
+/**
+ * Collects results of completed requests.
+ *
+ * \param ctx Context to collect the results from.
+ * \param results Array to be filled with up to <tt>max</tt> results.
+ * \param max Size of the <tt>results</tt> array.
+ * \param wait If non-zero, block until at least one result is available or no request is in flight.
+ * \return Number of results stored in <tt>results</tt>.
+ */
+LIBHPCS_API size_t LIBHPCS_CC hpcs_async_poll(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncResult* results, const size_t max, const int wait);
+
+/**
+ * Submits a data file to be read in the background. The function does not block on I/O.
+ *
+ * \param ctx Context to submit the request to.
+ * \param filename Path to the file to read.
+ * \param mdata \ref HPCS_MeasuredData object to be filled out. It must not be accessed until the result is collected.
+ * \param op \ref HPCS_AsyncOp selecting what to read.
+ * \param user_data Pointer returned along with the result.
+ * \return \ref HPCS_RetCode to indicate if the request was submitted.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_async_submit(struct HPCS_AsyncContext* ctx, const char* filename, struct HPCS_MeasuredData* mdata,
+							   const enum HPCS_AsyncOp op, void* user_data);
+
+/**
+ * Reads content of a HP/Agilent ChemStation data file that is stored in memory.
+ *
+ * The buffer is only read during the call, \ref HPCS_MeasuredData does not refer to it.
+ *
+ * \param bytes Content of the data file.
+ * \param length Length of the content in bytes.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata_buffer(const void* bytes, const size_t length, struct HPCS_MeasuredData* mdata);
+
+/**
+ * Reads content of a HP/Agilent ChemStation data file from user-supplied storage.
+ *
+ * \param io \ref HPCS_IOSource to read from.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata);
+
+/**
+ * Reads content of a HP/Agilent ChemStation data file with the signal trace in single precision.
+ * The header is read into \p mdata like \ref hpcs_read_mheader() does, \ref HPCS_MeasuredData::sampling_rate
+ * is set as well. The values are those of \ref hpcs_read_mdata() rounded to the nearest float.
+ *
+ * \param filename Path to the file to read.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param signal Pointer to \ref HPCS_FloatSignal object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata_float(const char* filename, struct HPCS_MeasuredData* mdata, struct HPCS_FloatSignal* signal);
+
+/**
+ * Reads content of a HP/Agilent ChemStation data file from user-supplied storage with the signal trace
+ * in single precision. See \ref hpcs_read_mdata_float() for details.
+ *
+ * \param io \ref HPCS_IOSource to read from.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param signal Pointer to \ref HPCS_FloatSignal object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata_float_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata,
+								  struct HPCS_FloatSignal* signal);
+
+/**
+ * Reads content of a HP/Agilent ChemStation data file with the signal trace as integer detector counts.
+ * The header is read into \p mdata like \ref hpcs_read_mheader() does, \ref HPCS_MeasuredData::sampling_rate
+ * is set as well. Only LC and CE data (generic types 30 and 130) store integer counts, GC data are rejected
+ * with \ref HPCS_E_INCOMPATIBLE_FILE.
+ *
+ * \ref hpcs_read_mdata() adds the shift to every delta between two jumps, the values from both
+ * functions agree only if the shift is zero.
+ *
+ * \param filename Path to the file to read.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param raw Pointer to \ref HPCS_RawSignal object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata_raw(const char* filename, struct HPCS_MeasuredData* mdata, struct HPCS_RawSignal* raw);
+
+/**
+ * Reads content of a HP/Agilent ChemStation data file from user-supplied storage with the signal trace
+ * as integer detector counts. See \ref hpcs_read_mdata_raw() for details.
+ *
+ * \param io \ref HPCS_IOSource to read from.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param raw Pointer to \ref HPCS_RawSignal object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata_raw_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata,
+								struct HPCS_RawSignal* raw);
+
+/**
+ * Reads content of a HP/Agilent ChemStation data file with the signal trace as a contiguous array of values.
+ * The header is read into \p mdata like \ref hpcs_read_mheader() does, \ref HPCS_MeasuredData::sampling_rate
+ * is set as well. The values are the same as those of \ref hpcs_read_mdata(). The times are described
+ * by \ref HPCS_TimeAxis and do not suffer from the rounding error of the running sum
+ * \ref hpcs_read_mdata() uses to compute them.
+ *
+ * \param filename Path to the file to read.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param signal Pointer to \ref HPCS_Signal object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata_signal(const char* filename, struct HPCS_MeasuredData* mdata, struct HPCS_Signal* signal);
+
+/**
+ * Reads content of a HP/Agilent ChemStation data file from user-supplied storage with the signal trace
+ * as a contiguous array of values. See \ref hpcs_read_mdata_signal() for details.
+ *
+ * \param io \ref HPCS_IOSource to read from.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param signal Pointer to \ref HPCS_Signal object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata_signal_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata,
+								   struct HPCS_Signal* signal);
+
+/**
+ * Reads a HP/Agilent ChemStation data file with the signal trace as an array of values, the signal
+ * is decoded on multiple threads. The result is the same as that of \ref hpcs_read_mdata_signal().
+ *
+ * GC signal is split into pieces of equal length. LC and CE signal stores differences between
+ * consecutive samples but the value is set to an absolute one wherever it jumps. The signal is
+ * scanned for the jumps first and split at those closest to an even split. Signal without jumps
+ * is decoded on one thread. So is any file that is read through stdio, see \ref hpcs_set_io_backend().
+ *
+ * \param filename Path to the file to read.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param signal Pointer to \ref HPCS_Signal object to be filled out by this function.
+ * \param threads Number of threads to use. Pass zero to use one thread per online CPU.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata_signal_parallel(const char* filename, struct HPCS_MeasuredData* mdata, struct HPCS_Signal* signal,
+									 int threads);
+
 /**
  * Reads content of a HP/Agilent ChemStation data file.
  * Unlike \ref hpcs_read_mdata() this function reads only the header (metadata)
@@ -152,15 +748,314 @@ LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mdata(const char* filename, s
  */
 LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mheader(const char* filename, struct HPCS_MeasuredData* mdata);
 
+/**
+ * Reads the header of a HP/Agilent ChemStation data file that is stored in memory.
+ * Unlike \ref hpcs_read_mdata_buffer() this function reads only the header (metadata)
+ * associated with the measurement but not the signal trace.
+ *
+ * \param bytes Content of the data file.
+ * \param length Length of the content in bytes.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mheader_buffer(const void* bytes, const size_t length, struct HPCS_MeasuredData* mdata);
+
+/**
+ * Reads the header of a HP/Agilent ChemStation data file from user-supplied storage.
+ * The header is fetched with a single request to the source.
+ *
+ * \param io \ref HPCS_IOSource to read from.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_mheader_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata);
+
 /**
  * Reads the method information block of a HP/Agilent ChemStation data file.
  *
+ * The file is UTF-16 text of <tt>name=value</tt> lines. It is read at once and every non-empty
+ * line becomes one block, the value is empty if the line has no equality sign.
+ *
  * \param filename Path to the file to read.
  * \param mdata Pointer to \ref HPCS_MethodInfo object to be filled out by this function.
  * \return \ref HPCS_RetCode to indicate if the operation succeeded.
  */
 LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_minfo(const char* filename, struct HPCS_MethodInfo* minfo);
 
+/**
+ * Looks up a value of a method information block by its name.
+ *
+ * Blocks read by \ref hpcs_read_minfo() are looked up in a hash index, other blocks are searched.
+ *
+ * \param minfo Method information to search.
+ * \param name Name of the block.
+ * \return Value of the first block with the given name or NULL if there is no such block.
+ */
+LIBHPCS_API const char* LIBHPCS_CC hpcs_minfo_get(const struct HPCS_MethodInfo* minfo, const char* name);
+
+/**
+ * Finds the next method information block whose name starts with a prefix.
+ *
+ * All blocks of a section, such as <tt>Section.</tt>, are visited in the order of the file by
+ * <tt>for (i = hpcs_minfo_next(minfo, "Section.", 0); i < minfo->count; i = hpcs_minfo_next(minfo, "Section.", i + 1))</tt>.
+ *
+ * \param minfo Method information to search.
+ * \param prefix Prefix of the name. Every block matches a NULL or empty prefix.
+ * \param from Index of the first block to consider.
+ * \return Index of the block or <tt>minfo->count</tt> if there are no more such blocks.
+ */
+LIBHPCS_API size_t LIBHPCS_CC hpcs_minfo_next(const struct HPCS_MethodInfo* minfo, const char* prefix, size_t from);
+
+/**
+ * Reads all data and method files of a ChemStation run directory (.D).
+ *
+ * Every <tt>.ch</tt> file in the directory becomes a trace. Its type is determined
+ * from the header, which is fetched with a single read, before the signal is loaded.
+ * Method files (<tt>.MTH</tt>) are read from the directory itself and from the
+ * method directories (<tt>.M</tt>) it contains. Files are opened relative to the
+ * directory and are read in parallel. A file that cannot be read does not abort
+ * the run, the outcome of each file is reported in its <tt>code</tt>.
+ *
+ * The run must be freed by calling \ref hpcs_free_run().
+ *
+ * \param path Path to the run directory.
+ * \param run Set to the read \ref HPCS_Run object.
+ * \param threads Number of threads to use. Pass zero to use one thread per online CPU.
+ * \return \ref HPCS_RetCode to indicate if the directory could be read.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_run(const char* path, struct HPCS_Run** run, int threads);
+
+/**
+ * Reads every ChemStation run directory (.D) found under a directory.
+ *
+ * Directories are searched recursively, symbolic links to directories are not followed.
+ * Each run is read as by \ref hpcs_read_run(), files of many small runs are read in parallel
+ * with each other. Subdirectories that cannot be opened are skipped.
+ *
+ * The runs must be freed by calling \ref hpcs_free_runs().
+ *
+ * \param path Path to the directory to search.
+ * \param runs Set to an array of the read \ref HPCS_Run objects. Directories are searched depth-first
+ *        and the entries of each directory are visited in the order of their names.
+ * \param count Set to the number of runs in the array.
+ * \param threads Number of threads to use. Pass zero to use one thread per online CPU.
+ * \return \ref HPCS_RetCode to indicate if the directory could be searched.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_run_tree(const char* path, struct HPCS_Run*** runs, size_t* count, int threads);
+
+/**
+ * Reads the samples of a HP/Agilent ChemStation data file that were taken within a time window.
+ * The header is read into \p mdata like \ref hpcs_read_mheader() does, \ref HPCS_MeasuredData::sampling_rate
+ * is set as well. The samples are returned like \ref hpcs_read_mdata_signal() does, the time axis
+ * starts at the first sample within the window.
+ *
+ * Only the window is decoded. GC data are read directly from the position of the first sample.
+ * LC and CE data store differences between consecutive samples. If the file has an up-to-date
+ * index built by \ref hpcs_build_index(), decoding starts from the last checkpoint before
+ * the window. Otherwise the file has to be scanned to find the number of samples and decoding
+ * starts from the last point before the window where the signal jumps to an absolute value.
+ *
+ * \param filename Path to the file to read.
+ * \param t_start Beginning of the window, in minutes.
+ * \param t_end End of the window, in minutes. Samples taken at exactly this time are included.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param signal Pointer to \ref HPCS_Signal object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_signal_range(const char* filename, const double t_start, const double t_end,
+								struct HPCS_MeasuredData* mdata, struct HPCS_Signal* signal);
+
+/**
+ * Reads the samples of a HP/Agilent ChemStation data file in user-supplied storage that were taken
+ * within a time window. See \ref hpcs_read_signal_range() for details. Indices are not used with
+ * user-supplied storage.
+ *
+ * \param io \ref HPCS_IOSource to read from.
+ * \param t_start Beginning of the window, in minutes.
+ * \param t_end End of the window, in minutes. Samples taken at exactly this time are included.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param signal Pointer to \ref HPCS_Signal object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_signal_range_io(const struct HPCS_IOSource* io, const double t_start, const double t_end,
+								   struct HPCS_MeasuredData* mdata, struct HPCS_Signal* signal);
+
+/**
+ * Reads a HP/Agilent ChemStation data file reduced to the smallest, the largest and the mean value in
+ * each of a given number of buckets. This is meant for plotting the signal trace, the memory used depends
+ * on the number of buckets, not on the length of the trace.
+ * The header is read into \p mdata like \ref hpcs_read_mheader() does, \ref HPCS_MeasuredData::sampling_rate
+ * is set as well.
+ *
+ * The signal is decoded only once. The samples are split among the buckets like \ref hpcs_pyramid_query()
+ * splits a window, the boundaries are taken from the number of samples estimated from the size of the file.
+ * The estimate is exact for GC data. It may be slightly larger than the number of samples for LC and CE data,
+ * the envelope may then hold a few buckets fewer than requested. There are also fewer buckets than requested
+ * if the signal trace holds fewer samples.
+ *
+ * \param filename Path to the file to read.
+ * \param buckets Number of buckets to split the signal trace into. Zero is treated as one.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param envelope Pointer to \ref HPCS_Envelope object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_envelope(const char* filename, const size_t buckets, struct HPCS_MeasuredData* mdata,
+							    struct HPCS_Envelope* envelope);
+
+/**
+ * Reads a HP/Agilent ChemStation data file from user-supplied storage reduced to the smallest, the
+ * largest and the mean value in each of a given number of buckets. See \ref hpcs_read_envelope() for details.
+ *
+ * \param io \ref HPCS_IOSource to read from.
+ * \param buckets Number of buckets to split the signal trace into. Zero is treated as one.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param envelope Pointer to \ref HPCS_Envelope object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_envelope_io(const struct HPCS_IOSource* io, const size_t buckets, struct HPCS_MeasuredData* mdata,
+							       struct HPCS_Envelope* envelope);
+
+/**
+ * Reads a HP/Agilent ChemStation data file downsampled to at most a given number of samples by the
+ * Largest-Triangle-Three-Buckets algorithm. The first and the last sample are always kept, one sample
+ * of each bucket in between is picked so that the shape of the signal trace is preserved.
+ * The header is read into \p mdata like \ref hpcs_read_mheader() does, \ref HPCS_MeasuredData::sampling_rate
+ * is set as well.
+ *
+ * The signal is decoded only once and the buckets are sized like \ref hpcs_read_envelope() does.
+ * Two buckets of samples are held in memory at a time.
+ *
+ * \param filename Path to the file to read.
+ * \param points Maximum number of samples to return. Values smaller than 3 are treated as 3.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param sampled Pointer to \ref HPCS_SampledSignal object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_lttb(const char* filename, const size_t points, struct HPCS_MeasuredData* mdata,
+							struct HPCS_SampledSignal* sampled);
+
+/**
+ * Reads a HP/Agilent ChemStation data file from user-supplied storage downsampled by the
+ * Largest-Triangle-Three-Buckets algorithm. See \ref hpcs_read_lttb() for details.
+ *
+ * \param io \ref HPCS_IOSource to read from.
+ * \param points Maximum number of samples to return. Values smaller than 3 are treated as 3.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param sampled Pointer to \ref HPCS_SampledSignal object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_read_lttb_io(const struct HPCS_IOSource* io, const size_t points, struct HPCS_MeasuredData* mdata,
+							   struct HPCS_SampledSignal* sampled);
+
+/**
+ * Builds a pyramid of a signal trace for interactive zooming. The pyramid holds the smallest, the
+ * largest and the sum of the values of the samples at decimation levels of 16, 32, 64... samples per
+ * bucket, all levels are computed in one pass over the signal. A summary of any time window can then
+ * be taken by \ref hpcs_pyramid_query() at a cost that depends on the number of buckets requested,
+ * not on the number of samples in the window. The levels take about three eighths of the memory
+ * of the signal.
+ *
+ * The pyramid refers to the values of the signal. The signal must not be modified or freed
+ * until the pyramid is freed by calling \ref hpcs_free_pyramid().
+ *
+ * \param signal Signal read by \ref hpcs_read_mdata_signal() or \ref hpcs_read_signal_range().
+ * \param pyramid Set to the built pyramid.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_build_pyramid(const struct HPCS_Signal* signal, struct HPCS_Pyramid** pyramid);
+
+/**
+ * Summarizes the samples of a signal taken between two times into a given number of buckets of
+ * equal width. The samples are read the same way as by \ref hpcs_read_signal_range(). The smallest,
+ * the largest and the mean value of each bucket are exact.
+ *
+ * Arrays already held by \p envelope are reallocated, the same object can be passed to repeated
+ * queries. There are fewer buckets than requested if the window holds fewer samples, each bucket
+ * then holds one sample.
+ *
+ * \param pyramid Pyramid built by \ref hpcs_build_pyramid().
+ * \param t_start Beginning of the window, in minutes.
+ * \param t_end End of the window, in minutes. Samples taken at exactly this time are included.
+ * \param buckets Number of buckets, typically the width of the plot in pixels.
+ * \param envelope Pointer to \ref HPCS_Envelope object to be filled out by this function.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_pyramid_query(const struct HPCS_Pyramid* pyramid, const double t_start, const double t_end,
+							    const size_t buckets, struct HPCS_Envelope* envelope);
+
+/**
+ * Opens a HP/Agilent ChemStation data file for streaming.
+ * The signal trace is decoded in chunks by \ref hpcs_stream_next() instead of being
+ * held in memory as a whole. The header is read the same way as by \ref hpcs_read_mheader(),
+ * <tt>data</tt> is set to <tt>NULL</tt> and <tt>data_count</tt> holds the number of samples
+ * the stream will deliver.
+ *
+ * The stream must be closed by calling \ref hpcs_close_stream().
+ *
+ * \param filename Path to the file to read.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param chunk_size Maximum number of samples in one chunk. Pass zero to use the default size.
+ * \param stream Set to the opened stream.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_open_stream(const char* filename, struct HPCS_MeasuredData* mdata, const size_t chunk_size,
+							  struct HPCS_SignalStream** stream);
+
+/**
+ * Opens a HP/Agilent ChemStation data file in user-supplied storage for streaming.
+ * See \ref hpcs_open_stream() for details. The source must remain valid until the stream is closed.
+ *
+ * \param io \ref HPCS_IOSource to read from.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out by this function.
+ * \param chunk_size Maximum number of samples in one chunk. Pass zero to use the default size.
+ * \param stream Set to the opened stream.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_open_stream_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata, const size_t chunk_size,
+							     struct HPCS_SignalStream** stream);
+
+/**
+ * Decodes the next chunk of samples from a stream.
+ *
+ * \param stream Stream opened by \ref hpcs_open_stream().
+ * \param pairs Set to the decoded samples. The array is owned by the stream and is
+ *        valid until the next call of \ref hpcs_stream_next() or \ref hpcs_close_stream().
+ * \param count Set to the number of decoded samples. Zero indicates the end of the signal.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_stream_next(struct HPCS_SignalStream* stream, const struct HPCS_TVPair** pairs, size_t* count);
+
+/**
+ * Closes a stream opened by \ref hpcs_open_stream().
+ *
+ * \param stream Stream to close.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_close_stream(struct HPCS_SignalStream* stream);
+
+/**
+ * Reads content of a HP/Agilent ChemStation data file and passes the signal trace
+ * to a callback in chunks of decoded samples.
+ *
+ * \param filename Path to the file to read.
+ * \param mdata Pointer to \ref HPCS_MeasuredData object to be filled out as described at \ref hpcs_open_stream().
+ * \param chunk_size Maximum number of samples in one chunk. Pass zero to use the default size.
+ * \param callback Function to call for each chunk.
+ * \param user_data Pointer passed to the callback.
+ * \return \ref HPCS_RetCode to indicate if the operation succeeded.
+ */
+LIBHPCS_API enum HPCS_RetCode LIBHPCS_CC hpcs_stream_mdata(const char* filename, struct HPCS_MeasuredData* mdata, const size_t chunk_size,
+							   HPCS_StreamCallback callback, void* user_data);
+
+/**
+ * Computes the times of a range of samples described by \ref HPCS_TimeAxis.
+ *
+ * \param axis Time axis of the signal.
+ * \param first Index of the first sample.
+ * \param count Number of samples.
+ * \param times Array of at least \p count elements to be filled with the times, in minutes.
+ */
+LIBHPCS_API void LIBHPCS_CC hpcs_time_axis_fill(const struct HPCS_TimeAxis* axis, const size_t first, const size_t count, double* times);
+
 #ifdef __cplusplus
 }
 #endif
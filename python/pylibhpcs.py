@@ -1,16 +1,17 @@
+from array import array
 from dataclasses import dataclass
 import platform
 from ctypes import (
-    c_uint8, c_uint16, c_uint32, c_int,
-    c_char_p, c_size_t,
-    c_double,
+    c_uint8, c_uint16, c_uint32, c_uint64, c_int,
+    c_int32, c_char_p, c_size_t,
+    c_double, c_float,
     c_void_p,
-    sizeof,
+    sizeof, memmove, string_at, cast,
     Structure, POINTER,
-    CDLL
+    CDLL, CFUNCTYPE
 )
 from enum import IntEnum
-from typing import Dict, List, Optional, Tuple
+from typing import Dict, List, Optional, Tuple, Union
 
 # Load the library based on the operating system
 if platform.system() == 'Windows':
@@ -137,6 +138,7 @@ containing both the signal trace and the associated metadata.
  - 'file_type': Type of the file. See `HPCS_FileType` for possible values
  - 'data': Array of `_HPCS_TVPair`s that represent the signal trace
  - 'data_count': Number of `_HPCS_TVPair`s in `data`
+ - 'predicted_count': Number of samples predicted from the size of the file. Exact for GC data, an upper bound for LC and CE data
 """
 class _HPCS_MeasuredData(Structure):
     _fields_ = [("file_description", c_char_p),
@@ -152,7 +154,86 @@ class _HPCS_MeasuredData(Structure):
                 ("dad_wavelength_ref", _HPCS_Wavelength),
                 ("file_type", c_int),  # Use c_int for enum
                 ("data", POINTER(_HPCS_TVPair)),
-                ("data_count", c_size_t)]
+                ("data_count", c_size_t),
+                # Appended fields, older builds of the library allocate the structure without them
+                ("predicted_count", c_size_t),
+                ("arena", c_void_p)]
+
+"""
+`_HPCS_TimeAxis` describes the times of equally spaced samples.
+Sample `i` is taken at `t0 + i * dt`.
+
+ - 't0': Time of the first sample, in minutes
+ - 'dt': Time between two samples, in minutes
+ - 'count': Number of samples
+"""
+class _HPCS_TimeAxis(Structure):
+    _fields_ = [("t0", c_double),
+                ("dt", c_double),
+                ("count", c_size_t)]
+
+"""
+`_HPCS_Signal` is a signal trace as a contiguous array of values.
+
+ - 'values': Array of signal values
+ - 'time': Times of the samples. See `_HPCS_TimeAxis`
+"""
+class _HPCS_Signal(Structure):
+    _fields_ = [("values", POINTER(c_double)),
+                ("time", _HPCS_TimeAxis)]
+
+"""
+`_HPCS_FloatSignal` is a signal trace in single precision.
+
+ - 'values': Array of signal values
+ - 'time': Times of the samples. See `_HPCS_TimeAxis`
+"""
+class _HPCS_FloatSignal(Structure):
+    _fields_ = [("values", POINTER(c_float)),
+                ("time", _HPCS_TimeAxis)]
+
+"""
+`_HPCS_RawSignal` is the signal trace of LC or CE data as integer detector counts.
+The signal value of a sample is `counts[i] * step + shift`.
+
+ - 'counts': Array of detector counts
+ - 'time': Times of the samples. See `_HPCS_TimeAxis`
+ - 'step': Signal value of one count
+ - 'shift': Offset of the signal value
+"""
+class _HPCS_RawSignal(Structure):
+    _fields_ = [("counts", POINTER(c_int32)),
+                ("time", _HPCS_TimeAxis),
+                ("step", c_double),
+                ("shift", c_double)]
+
+"""
+`_HPCS_Envelope` holds the lowest, the highest and the mean signal value within
+each bucket of equally wide runs of samples.
+
+ - 'min': Array of the lowest values in each bucket
+ - 'max': Array of the highest values in each bucket
+ - 'mean': Array of the mean values in each bucket
+ - 'time': Start and width of the buckets. See `_HPCS_TimeAxis`
+"""
+class _HPCS_Envelope(Structure):
+    _fields_ = [("min", POINTER(c_double)),
+                ("max", POINTER(c_double)),
+                ("mean", POINTER(c_double)),
+                ("time", _HPCS_TimeAxis)]
+
+"""
+`_HPCS_SampledSignal` is a set of samples picked out of a signal trace.
+The samples are not equally spaced in time.
+
+ - 'times': Array of sample times, in minutes
+ - 'values': Array of signal values
+ - 'count': Number of samples
+"""
+class _HPCS_SampledSignal(Structure):
+    _fields_ = [("times", POINTER(c_double)),
+                ("values", POINTER(c_double)),
+                ("count", c_size_t)]
 
 """
 `_HPCS_MethodInfoBlock` is a key-value pair of information
@@ -172,10 +253,74 @@ and the length of that array.
 
  - 'blocks': Array of `HPCS_MethodInfoBlock`s
  - 'count': Length of the array
+ - 'index': Hash index of the blocks by name
 """
 class _HPCS_MethodInfo(Structure):
     _fields_ = [("blocks", POINTER(_HPCS_MethodInfoBlock)),
-                ("count", c_size_t)]
+                ("count", c_size_t),
+                ("index", c_void_p)]
+
+"""
+`_HPCS_RunTrace` is a data file of a ChemStation run directory
+
+ - 'name': Name of the file within the run directory
+ - 'file_type': Type of the signal. See `HPCS_FileType` for possible values
+ - 'mdata': Measured data read from the file
+ - 'code': Outcome of reading the file. See `HPCS_RetCode` for possible values
+"""
+class _HPCS_RunTrace(Structure):
+    _fields_ = [("name", c_char_p),
+                ("file_type", c_int),
+                ("mdata", POINTER(_HPCS_MeasuredData)),
+                ("code", c_int)]
+
+"""
+`_HPCS_RunMethod` is a method file of a ChemStation run directory
+
+ - 'name': Path of the file relative to the run directory
+ - 'minfo': Method information read from the file
+ - 'code': Outcome of reading the file. See `HPCS_RetCode` for possible values
+"""
+class _HPCS_RunMethod(Structure):
+    _fields_ = [("name", c_char_p),
+                ("minfo", POINTER(_HPCS_MethodInfo)),
+                ("code", c_int)]
+
+"""
+`_HPCS_Run` is the content of a ChemStation run directory (.D)
+
+ - 'path': Path to the run directory
+ - 'traces': Array of `_HPCS_RunTrace`s
+ - 'trace_count': Length of `traces`
+ - 'methods': Array of `_HPCS_RunMethod`s
+ - 'method_count': Length of `methods`
+"""
+class _HPCS_Run(Structure):
+    _fields_ = [("path", c_char_p),
+                ("traces", POINTER(_HPCS_RunTrace)),
+                ("trace_count", c_size_t),
+                ("methods", POINTER(_HPCS_RunMethod)),
+                ("method_count", c_size_t)]
+
+
+_IORead = CFUNCTYPE(c_int, c_void_p, c_void_p, c_size_t, POINTER(c_size_t))
+_IOSeek = CFUNCTYPE(c_int, c_void_p, c_uint64)
+_IOSize = CFUNCTYPE(c_int, c_void_p, POINTER(c_uint64))
+
+"""
+`_HPCS_IOSource` is a set of callbacks through which libHPCS reads
+a data file from user-supplied storage.
+
+ - 'handle': Opaque pointer passed to the callbacks
+ - 'read': Reads data from the current position
+ - 'seek': Moves the current position
+ - 'size': Returns the total size of the data
+"""
+class _HPCS_IOSource(Structure):
+    _fields_ = [("handle", c_void_p),
+                ("read", _IORead),
+                ("seek", _IOSeek),
+                ("size", _IOSize)]
 
 
 @dataclass(frozen=True)
@@ -211,26 +356,127 @@ class HPCS_MeasuredData:
     data: List[Tuple[float, float]]
 
 
+@dataclass(frozen=True)
+class HPCS_TimeAxis:
+    t0: float
+    dt: float
+    count: int
+
+    def times(self):
+        return [self.t0 + idx * self.dt for idx in range(0, self.count)]
+
+
+@dataclass(frozen=True)
+class HPCS_Signal:
+    values: array
+    time: HPCS_TimeAxis
+
+
+@dataclass(frozen=True)
+class HPCS_FloatSignal:
+    values: array
+    time: HPCS_TimeAxis
+
+
+@dataclass(frozen=True)
+class HPCS_RawSignal:
+    counts: array
+    time: HPCS_TimeAxis
+    step: float
+    shift: float
+
+
+@dataclass(frozen=True)
+class HPCS_Envelope:
+    min: array
+    max: array
+    mean: array
+    time: HPCS_TimeAxis
+
+
+@dataclass(frozen=True)
+class HPCS_SampledSignal:
+    times: array
+    values: array
+
+
 @dataclass(frozen=True)
 class HPCS_MethodInfo:
     information: Dict[str, str]
 
 
+@dataclass(frozen=True)
+class HPCS_Run:
+    path: str
+    traces: Dict[str, Union[HPCS_MeasuredData, HPCSError]]
+    methods: Dict[str, Union[HPCS_MethodInfo, HPCSError]]
+
+
 def wrap_function(lib, funcname, restype, argtypes):
-    func = getattr(lib, funcname)
+    """
+    Binds a function of the library. Older builds of the library, such as the bundled
+    Windows DLLs, do not export every function. A missing function is bound to a stub
+    that raises `NotImplementedError` when called so that the rest of the module works.
+    """
+    func = getattr(lib, funcname, None)
+    if func is None:
+        def missing(*args):
+            raise NotImplementedError(f'{funcname} is not exported by {lib_name}')
+        return missing
+
     func.restype = restype
     func.argtypes = argtypes
     return func
 
 # Internal C functions. It is inadvisable to call these directly
 _error_to_string = wrap_function(libhpcs, "hpcs_error_to_string", c_char_p, [c_int])
+_build_index = wrap_function(libhpcs, "hpcs_build_index", c_int, [c_char_p, c_size_t])
+_build_index_batch = wrap_function(libhpcs, "hpcs_build_index_batch", c_int, [POINTER(c_char_p), c_size_t, c_size_t, POINTER(c_int), c_int])
 _read_mdata = wrap_function(libhpcs, "hpcs_read_mdata", c_int, [c_char_p, POINTER(_HPCS_MeasuredData)])
+_read_mdata_batch = wrap_function(libhpcs, "hpcs_read_mdata_batch", c_int, [POINTER(c_char_p), c_size_t, POINTER(POINTER(_HPCS_MeasuredData)), POINTER(c_int), c_int])
+_read_mdata_buffer = wrap_function(libhpcs, "hpcs_read_mdata_buffer", c_int, [c_char_p, c_size_t, POINTER(_HPCS_MeasuredData)])
 _read_mheader = wrap_function(libhpcs, "hpcs_read_mheader", c_int, [c_char_p, POINTER(_HPCS_MeasuredData)])
+_read_mheader_buffer = wrap_function(libhpcs, "hpcs_read_mheader_buffer", c_int, [c_char_p, c_size_t, POINTER(_HPCS_MeasuredData)])
+_read_mdata_io = wrap_function(libhpcs, "hpcs_read_mdata_io", c_int, [POINTER(_HPCS_IOSource), POINTER(_HPCS_MeasuredData)])
+_read_mheader_io = wrap_function(libhpcs, "hpcs_read_mheader_io", c_int, [POINTER(_HPCS_IOSource), POINTER(_HPCS_MeasuredData)])
+_read_mdata_signal = wrap_function(libhpcs, "hpcs_read_mdata_signal", c_int, [c_char_p, POINTER(_HPCS_MeasuredData), POINTER(_HPCS_Signal)])
+_read_mdata_signal_io = wrap_function(libhpcs, "hpcs_read_mdata_signal_io", c_int, [POINTER(_HPCS_IOSource), POINTER(_HPCS_MeasuredData), POINTER(_HPCS_Signal)])
+_read_mdata_signal_parallel = wrap_function(libhpcs, "hpcs_read_mdata_signal_parallel", c_int, [c_char_p, POINTER(_HPCS_MeasuredData), POINTER(_HPCS_Signal), c_int])
+_read_signal_range = wrap_function(libhpcs, "hpcs_read_signal_range", c_int, [c_char_p, c_double, c_double, POINTER(_HPCS_MeasuredData), POINTER(_HPCS_Signal)])
+_read_signal_range_io = wrap_function(libhpcs, "hpcs_read_signal_range_io", c_int, [POINTER(_HPCS_IOSource), c_double, c_double, POINTER(_HPCS_MeasuredData), POINTER(_HPCS_Signal)])
+_read_mdata_float = wrap_function(libhpcs, "hpcs_read_mdata_float", c_int, [c_char_p, POINTER(_HPCS_MeasuredData), POINTER(_HPCS_FloatSignal)])
+_read_mdata_float_io = wrap_function(libhpcs, "hpcs_read_mdata_float_io", c_int, [POINTER(_HPCS_IOSource), POINTER(_HPCS_MeasuredData), POINTER(_HPCS_FloatSignal)])
+_read_mdata_raw = wrap_function(libhpcs, "hpcs_read_mdata_raw", c_int, [c_char_p, POINTER(_HPCS_MeasuredData), POINTER(_HPCS_RawSignal)])
+_read_mdata_raw_io = wrap_function(libhpcs, "hpcs_read_mdata_raw_io", c_int, [POINTER(_HPCS_IOSource), POINTER(_HPCS_MeasuredData), POINTER(_HPCS_RawSignal)])
+_read_envelope = wrap_function(libhpcs, "hpcs_read_envelope", c_int, [c_char_p, c_size_t, POINTER(_HPCS_MeasuredData), POINTER(_HPCS_Envelope)])
+_read_envelope_io = wrap_function(libhpcs, "hpcs_read_envelope_io", c_int, [POINTER(_HPCS_IOSource), c_size_t, POINTER(_HPCS_MeasuredData), POINTER(_HPCS_Envelope)])
+_read_lttb = wrap_function(libhpcs, "hpcs_read_lttb", c_int, [c_char_p, c_size_t, POINTER(_HPCS_MeasuredData), POINTER(_HPCS_SampledSignal)])
+_read_lttb_io = wrap_function(libhpcs, "hpcs_read_lttb_io", c_int, [POINTER(_HPCS_IOSource), c_size_t, POINTER(_HPCS_MeasuredData), POINTER(_HPCS_SampledSignal)])
+_build_pyramid = wrap_function(libhpcs, "hpcs_build_pyramid", c_int, [POINTER(_HPCS_Signal), POINTER(c_void_p)])
+_pyramid_query = wrap_function(libhpcs, "hpcs_pyramid_query", c_int, [c_void_p, c_double, c_double, c_size_t, POINTER(_HPCS_Envelope)])
+_free_pyramid = wrap_function(libhpcs, "hpcs_free_pyramid", None, [c_void_p])
 _read_minfo = wrap_function(libhpcs, "hpcs_read_minfo", c_int, [c_char_p, POINTER(_HPCS_MethodInfo)])
+_alloc_envelope = wrap_function(libhpcs, "hpcs_alloc_envelope", POINTER(_HPCS_Envelope), [])
+_free_envelope = wrap_function(libhpcs, "hpcs_free_envelope", None, [POINTER(_HPCS_Envelope)])
+_alloc_sampled_signal = wrap_function(libhpcs, "hpcs_alloc_sampled_signal", POINTER(_HPCS_SampledSignal), [])
+_free_sampled_signal = wrap_function(libhpcs, "hpcs_free_sampled_signal", None, [POINTER(_HPCS_SampledSignal)])
 _alloc_mdata = wrap_function(libhpcs, "hpcs_alloc_mdata", POINTER(_HPCS_MeasuredData), [])
 _free_mdata = wrap_function(libhpcs, "hpcs_free_mdata", None, [POINTER(_HPCS_MeasuredData)])
 _alloc_minfo = wrap_function(libhpcs, "hpcs_alloc_minfo", POINTER(_HPCS_MethodInfo), [])
 _free_minfo = wrap_function(libhpcs, "hpcs_free_minfo", None, [POINTER(_HPCS_MethodInfo)])
+_alloc_signal = wrap_function(libhpcs, "hpcs_alloc_signal", POINTER(_HPCS_Signal), [])
+_free_signal = wrap_function(libhpcs, "hpcs_free_signal", None, [POINTER(_HPCS_Signal)])
+_alloc_float_signal = wrap_function(libhpcs, "hpcs_alloc_float_signal", POINTER(_HPCS_FloatSignal), [])
+_free_float_signal = wrap_function(libhpcs, "hpcs_free_float_signal", None, [POINTER(_HPCS_FloatSignal)])
+_alloc_raw_signal = wrap_function(libhpcs, "hpcs_alloc_raw_signal", POINTER(_HPCS_RawSignal), [])
+_free_raw_signal = wrap_function(libhpcs, "hpcs_free_raw_signal", None, [POINTER(_HPCS_RawSignal)])
+_open_stream = wrap_function(libhpcs, "hpcs_open_stream", c_int, [c_char_p, POINTER(_HPCS_MeasuredData), c_size_t, POINTER(c_void_p)])
+_stream_next = wrap_function(libhpcs, "hpcs_stream_next", c_int, [c_void_p, POINTER(POINTER(_HPCS_TVPair)), POINTER(c_size_t)])
+_close_stream = wrap_function(libhpcs, "hpcs_close_stream", None, [c_void_p])
+_read_run = wrap_function(libhpcs, "hpcs_read_run", c_int, [c_char_p, POINTER(POINTER(_HPCS_Run)), c_int])
+_read_run_tree = wrap_function(libhpcs, "hpcs_read_run_tree", c_int, [c_char_p, POINTER(POINTER(POINTER(_HPCS_Run))), POINTER(c_size_t), c_int])
+_free_run = wrap_function(libhpcs, "hpcs_free_run", None, [POINTER(_HPCS_Run)])
+_free_runs = wrap_function(libhpcs, "hpcs_free_runs", None, [POINTER(POINTER(_HPCS_Run)), c_size_t])
 
 def _make_date(raw_date):
     return HPCS_Date(
@@ -287,6 +533,92 @@ def _make_hpcs_measured_data(ptr):
     )
 
 
+def _make_time_axis(raw_axis):
+    return HPCS_TimeAxis(raw_axis.t0, raw_axis.dt, raw_axis.count)
+
+
+def _make_array(typecode, ptr, count, elem_type):
+    values = array(typecode)
+    if count > 0:
+        values.frombytes(string_at(ptr, count * sizeof(elem_type)))
+    return values
+
+
+def _make_hpcs_signal(ptr):
+    time = ptr.contents.time
+    return HPCS_Signal(
+        _make_array('d', ptr.contents.values, time.count, c_double),
+        _make_time_axis(time)
+    )
+
+
+def _make_hpcs_float_signal(ptr):
+    time = ptr.contents.time
+    return HPCS_FloatSignal(
+        _make_array('f', ptr.contents.values, time.count, c_float),
+        _make_time_axis(time)
+    )
+
+
+def _make_hpcs_raw_signal(ptr):
+    time = ptr.contents.time
+    return HPCS_RawSignal(
+        _make_array('i', ptr.contents.counts, time.count, c_int32),
+        _make_time_axis(time),
+        ptr.contents.step,
+        ptr.contents.shift
+    )
+
+
+def _make_hpcs_envelope(ptr):
+    time = ptr.contents.time
+    return HPCS_Envelope(
+        _make_array('d', ptr.contents.min, time.count, c_double),
+        _make_array('d', ptr.contents.max, time.count, c_double),
+        _make_array('d', ptr.contents.mean, time.count, c_double),
+        _make_time_axis(time)
+    )
+
+
+def _make_hpcs_sampled_signal(ptr):
+    count = ptr.contents.count
+    return HPCS_SampledSignal(
+        _make_array('d', ptr.contents.times, count, c_double),
+        _make_array('d', ptr.contents.values, count, c_double)
+    )
+
+
+def _make_io_source(fileobj):
+    """
+    Wraps a seekable binary file-like object into `_HPCS_IOSource`.
+    The callbacks must be kept alive for as long as the source is in use.
+    """
+    def read(handle, dst, length, bytes_read):
+        try:
+            chunk = fileobj.read(length)
+        except OSError:
+            return -1
+        memmove(dst, chunk, len(chunk))
+        bytes_read[0] = len(chunk)
+        return 0
+
+    def seek(handle, offset):
+        try:
+            fileobj.seek(offset)
+        except OSError:
+            return -1
+        return 0
+
+    def size(handle, out):
+        try:
+            out[0] = fileobj.seek(0, 2)
+        except OSError:
+            return -1
+        return 0
+
+    return _HPCS_IOSource(None, _IORead(read), _IOSeek(seek), _IOSize(size))
+
+
 def _make_hpcs_method_info(ptr):
     information = {}
 
@@ -297,11 +629,59 @@ def _make_hpcs_method_info(ptr):
     return HPCS_MethodInfo(information)
 
 
+def _make_hpcs_run(run):
+    traces = {}
+    methods = {}
+
+    for idx in range(0, run.trace_count):
+        t = run.traces[idx]
+        if t.code != HPCS_RetCode.HPCS_OK:
+            traces[t.name.decode('utf-8')] = HPCSError(t.code)
+        else:
+            traces[t.name.decode('utf-8')] = _make_hpcs_measured_data(t.mdata)
+
+    for idx in range(0, run.method_count):
+        m = run.methods[idx]
+        if m.code != HPCS_RetCode.HPCS_OK:
+            methods[m.name.decode('utf-8')] = HPCSError(m.code)
+        else:
+            methods[m.name.decode('utf-8')] = _make_hpcs_method_info(m.minfo)
+
+    return HPCS_Run(run.path.decode('utf-8'), traces, methods)
+
+
 # Error to string translation
 def error_to_string(err):
     return _error_to_string(err).decode('utf-8')
 
 
+# Indexing data files for random access
+def build_index(file_path, interval=0):
+    """
+    Writes a checkpoint index next to the data file that lets `read_signal_range`
+    start decoding close to the requested window.
+    """
+    ret = _build_index(str(file_path).encode('utf-8'), interval)
+    if ret != HPCS_RetCode.HPCS_OK:
+        raise HPCSError(ret)
+
+
+def build_index_batch(file_paths, interval=0, threads=0):
+    """
+    Indexes multiple data files in parallel. Returns a list with either
+    `None` or `HPCSError` for each file.
+    """
+    n = len(file_paths)
+    paths = (c_char_p * n)(*[str(p).encode('utf-8') for p in file_paths])
+    codes = (c_int * n)()
+
+    ret = _build_index_batch(paths, n, interval, codes, threads)
+    if ret != HPCS_RetCode.HPCS_OK:
+        raise HPCSError(ret)
+
+    return [None if code == HPCS_RetCode.HPCS_OK else HPCSError(code) for code in codes]
+
+
 # Reading measured data and method information
 def read_mdata(file_path):
     ptr = _alloc_mdata()
@@ -315,6 +695,45 @@ def read_mdata(file_path):
         return data
 
 
+def read_mdata_batch(file_paths, threads=0):
+    """
+    Reads multiple data files in parallel. Returns a list with either
+    `HPCS_MeasuredData` or `HPCSError` for each file.
+    """
+    n = len(file_paths)
+    paths = (c_char_p * n)(*[str(p).encode('utf-8') for p in file_paths])
+    ptrs = (POINTER(_HPCS_MeasuredData) * n)(*[_alloc_mdata() for _ in range(n)])
+    codes = (c_int * n)()
+
+    try:
+        ret = _read_mdata_batch(paths, n, ptrs, codes, threads)
+        if ret != HPCS_RetCode.HPCS_OK:
+            raise HPCSError(ret)
+
+        results = []
+        for idx in range(0, n):
+            if codes[idx] != HPCS_RetCode.HPCS_OK:
+                results.append(HPCSError(codes[idx]))
+            else:
+                results.append(_make_hpcs_measured_data(ptrs[idx]))
+        return results
+    finally:
+        for ptr in ptrs:
+            _free_mdata(ptr)
+
+
+def read_mdata_buffer(data):
+    ptr = _alloc_mdata()
+    ret = _read_mdata_buffer(bytes(data), len(data), ptr)
+    if ret != HPCS_RetCode.HPCS_OK:
+        _free_mdata(ptr)
+        raise HPCSError(ret)
+    else:
+        data = _make_hpcs_measured_data(ptr)
+        _free_mdata(ptr)
+        return data
+
+
 def read_mheader(file_path):
     ptr = _alloc_mdata()
     ret =  _read_mheader(str(file_path).encode('utf-8'), ptr)
@@ -327,6 +746,163 @@ def read_mheader(file_path):
         return data
 
 
+def read_mheader_buffer(data):
+    ptr = _alloc_mdata()
+    ret = _read_mheader_buffer(bytes(data), len(data), ptr)
+    if ret != HPCS_RetCode.HPCS_OK:
+        _free_mdata(ptr)
+        raise HPCSError(ret)
+    else:
+        data = _make_hpcs_measured_data(ptr)
+        _free_mdata(ptr)
+        return data
+
+
+def read_mdata_io(fileobj):
+    io = _make_io_source(fileobj)
+    ptr = _alloc_mdata()
+    ret = _read_mdata_io(io, ptr)
+    if ret != HPCS_RetCode.HPCS_OK:
+        _free_mdata(ptr)
+        raise HPCSError(ret)
+    else:
+        data = _make_hpcs_measured_data(ptr)
+        _free_mdata(ptr)
+        return data
+
+
+def read_mheader_io(fileobj):
+    io = _make_io_source(fileobj)
+    ptr = _alloc_mdata()
+    ret = _read_mheader_io(io, ptr)
+    if ret != HPCS_RetCode.HPCS_OK:
+        _free_mdata(ptr)
+        raise HPCSError(ret)
+    else:
+        data = _make_hpcs_measured_data(ptr)
+        _free_mdata(ptr)
+        return data
+
+
+def _read_signal(reader, source, alloc, free, make):
+    ptr = _alloc_mdata()
+    signal_ptr = alloc()
+    try:
+        ret = reader(source, ptr, signal_ptr)
+        if ret != HPCS_RetCode.HPCS_OK:
+            raise HPCSError(ret)
+        return _make_hpcs_measured_data(ptr), make(signal_ptr)
+    finally:
+        free(signal_ptr)
+        _free_mdata(ptr)
+
+
+def read_mdata_signal(file_path):
+    """
+    Reads a data file with the signal trace as an array of values and a time axis.
+    Returns a tuple of `HPCS_MeasuredData` with no data and `HPCS_Signal`.
+    """
+    return _read_signal(_read_mdata_signal, str(file_path).encode('utf-8'),
+                        _alloc_signal, _free_signal, _make_hpcs_signal)
+
+
+def read_mdata_signal_io(fileobj):
+    io = _make_io_source(fileobj)
+    return _read_signal(_read_mdata_signal_io, io,
+                        _alloc_signal, _free_signal, _make_hpcs_signal)
+
+
+def read_mdata_signal_parallel(file_path, threads=0):
+    """
+    Reads a data file like `read_mdata_signal` but decodes the signal trace on multiple threads.
+    Pass zero `threads` to use one thread per CPU.
+    """
+    reader = lambda source, ptr, signal_ptr: _read_mdata_signal_parallel(source, ptr, signal_ptr, threads)
+    return _read_signal(reader, str(file_path).encode('utf-8'),
+                        _alloc_signal, _free_signal, _make_hpcs_signal)
+
+
+def read_signal_range(file_path, t_start, t_end):
+    """
+    Reads only the samples taken between `t_start` and `t_end` minutes.
+    Returns a tuple of `HPCS_MeasuredData` with no data and `HPCS_Signal`.
+    """
+    reader = lambda source, ptr, signal_ptr: _read_signal_range(source, t_start, t_end, ptr, signal_ptr)
+    return _read_signal(reader, str(file_path).encode('utf-8'),
+                        _alloc_signal, _free_signal, _make_hpcs_signal)
+
+
+def read_signal_range_io(fileobj, t_start, t_end):
+    io = _make_io_source(fileobj)
+    reader = lambda source, ptr, signal_ptr: _read_signal_range_io(source, t_start, t_end, ptr, signal_ptr)
+    return _read_signal(reader, io,
+                        _alloc_signal, _free_signal, _make_hpcs_signal)
+
+
+def read_envelope(file_path, buckets):
+    """
+    Reads the lowest and the highest signal value within roughly `buckets` runs of samples.
+    Returns a tuple of `HPCS_MeasuredData` with no data and `HPCS_Envelope`.
+    """
+    reader = lambda source, ptr, envelope_ptr: _read_envelope(source, buckets, ptr, envelope_ptr)
+    return _read_signal(reader, str(file_path).encode('utf-8'),
+                        _alloc_envelope, _free_envelope, _make_hpcs_envelope)
+
+
+def read_envelope_io(fileobj, buckets):
+    io = _make_io_source(fileobj)
+    reader = lambda source, ptr, envelope_ptr: _read_envelope_io(source, buckets, ptr, envelope_ptr)
+    return _read_signal(reader, io,
+                        _alloc_envelope, _free_envelope, _make_hpcs_envelope)
+
+
+def read_lttb(file_path, points):
+    """
+    Reads the signal trace downsampled to about `points` samples that preserve its visual shape.
+    Returns a tuple of `HPCS_MeasuredData` with no data and `HPCS_SampledSignal`.
+    """
+    reader = lambda source, ptr, sampled_ptr: _read_lttb(source, points, ptr, sampled_ptr)
+    return _read_signal(reader, str(file_path).encode('utf-8'),
+                        _alloc_sampled_signal, _free_sampled_signal, _make_hpcs_sampled_signal)
+
+
+def read_lttb_io(fileobj, points):
+    io = _make_io_source(fileobj)
+    reader = lambda source, ptr, sampled_ptr: _read_lttb_io(source, points, ptr, sampled_ptr)
+    return _read_signal(reader, io,
+                        _alloc_sampled_signal, _free_sampled_signal, _make_hpcs_sampled_signal)
+
+
+def read_mdata_float(file_path):
+    """
+    Reads a data file with the signal trace in single precision.
+    Returns a tuple of `HPCS_MeasuredData` with no data and `HPCS_FloatSignal`.
+    """
+    return _read_signal(_read_mdata_float, str(file_path).encode('utf-8'),
+                        _alloc_float_signal, _free_float_signal, _make_hpcs_float_signal)
+
+
+def read_mdata_float_io(fileobj):
+    io = _make_io_source(fileobj)
+    return _read_signal(_read_mdata_float_io, io,
+                        _alloc_float_signal, _free_float_signal, _make_hpcs_float_signal)
+
+
+def read_mdata_raw(file_path):
+    """
+    Reads LC or CE data with the signal trace as integer detector counts.
+    Returns a tuple of `HPCS_MeasuredData` with no data and `HPCS_RawSignal`.
+    """
+    return _read_signal(_read_mdata_raw, str(file_path).encode('utf-8'),
+                        _alloc_raw_signal, _free_raw_signal, _make_hpcs_raw_signal)
+
+
+def read_mdata_raw_io(fileobj):
+    io = _make_io_source(fileobj)
+    return _read_signal(_read_mdata_raw_io, io,
+                        _alloc_raw_signal, _free_raw_signal, _make_hpcs_raw_signal)
+
+
 def read_minfo(file_path):
     ptr = _alloc_minfo()
     ret =  _read_minfo(str(file_path).encode('utf-8'), ptr)
@@ -337,3 +913,117 @@ def read_minfo(file_path):
         data = _make_hpcs_method_info(ptr)
         _free_minfo(ptr)
         return data
+
+
+# Reading ChemStation run directories
+def read_run(dir_path, threads=0):
+    """
+    Reads all data and method files of a run directory (.D). Files that
+    cannot be read are reported as `HPCSError` in place of their content.
+    """
+    ptr = POINTER(_HPCS_Run)()
+    ret = _read_run(str(dir_path).encode('utf-8'), ptr, threads)
+    if ret != HPCS_RetCode.HPCS_OK:
+        raise HPCSError(ret)
+
+    try:
+        return _make_hpcs_run(ptr.contents)
+    finally:
+        _free_run(ptr)
+
+
+def read_run_tree(dir_path, threads=0):
+    """
+    Reads every run directory (.D) found under a directory. Returns a list of `HPCS_Run`.
+    """
+    runs = POINTER(POINTER(_HPCS_Run))()
+    count = c_size_t()
+    ret = _read_run_tree(str(dir_path).encode('utf-8'), runs, count, threads)
+    if ret != HPCS_RetCode.HPCS_OK:
+        raise HPCSError(ret)
+
+    try:
+        return [_make_hpcs_run(runs[idx].contents) for idx in range(0, count.value)]
+    finally:
+        _free_runs(runs, count.value)
+
+
+# Streaming of signal traces
+def iter_signal(file_path, chunk_size=0):
+    """
+    Yields chunks of the signal trace as lists of (time, value) tuples.
+    Only one chunk is held in memory at a time.
+    """
+    ptr = _alloc_mdata()
+    stream = c_void_p()
+    ret = _open_stream(str(file_path).encode('utf-8'), ptr, chunk_size, stream)
+    _free_mdata(ptr)
+    if ret != HPCS_RetCode.HPCS_OK:
+        raise HPCSError(ret)
+
+    try:
+        pairs = POINTER(_HPCS_TVPair)()
+        count = c_size_t()
+        while True:
+            ret = _stream_next(stream, pairs, count)
+            if ret != HPCS_RetCode.HPCS_OK:
+                raise HPCSError(ret)
+            if count.value == 0:
+                break
+            yield _make_data(pairs, count.value)
+    finally:
+        _close_stream(stream)
+
+
+class HPCS_Pyramid:
+    """
+    Multi-resolution summary of a signal trace for interactive zooming.
+    Built by `build_pyramid`, the values of the signal must not be modified while the pyramid is open.
+    """
+
+    def __init__(self, signal):
+        # The pyramid refers to the values of the signal, they are kept alive with it
+        self._values = signal.values
+        address, _ = self._values.buffer_info()
+        self._signal = _HPCS_Signal(cast(address, POINTER(c_double)),
+                                    _HPCS_TimeAxis(signal.time.t0, signal.time.dt, signal.time.count))
+        self._handle = c_void_p()
+        ret = _build_pyramid(self._signal, self._handle)
+        if ret != HPCS_RetCode.HPCS_OK:
+            raise HPCSError(ret)
+
+    def query(self, t_start, t_end, buckets):
+        """
+        Summarizes the samples taken between `t_start` and `t_end` minutes into `buckets` buckets.
+        Returns `HPCS_Envelope`.
+        """
+        envelope_ptr = _alloc_envelope()
+        try:
+            ret = _pyramid_query(self._handle, t_start, t_end, buckets, envelope_ptr)
+            if ret != HPCS_RetCode.HPCS_OK:
+                raise HPCSError(ret)
+            return _make_hpcs_envelope(envelope_ptr)
+        finally:
+            _free_envelope(envelope_ptr)
+
+    def close(self):
+        if self._handle:
+            _free_pyramid(self._handle)
+            self._handle = c_void_p()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+
+def build_pyramid(signal):
+    """
+    Builds a pyramid of a `HPCS_Signal` returned by `read_mdata_signal` or `read_signal_range`.
+    Returns `HPCS_Pyramid`.
+    """
+    return HPCS_Pyramid(signal)
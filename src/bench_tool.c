@@ -0,0 +1,771 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libHPCS.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+enum IOKind {
+	IO_NONE,
+	IO_FILE,
+	IO_FD,
+	IO_MEMORY
+};
+
+/* Pairs of direct and HPCS_IOSource-based reads of the same data */
+struct IOCase {
+	const char* name;
+	enum IOKind kind;
+	int from_buffer;
+};
+
+static const struct IOCase IO_CASES[] = {
+	{ "buffer", IO_NONE, 1 },
+	{ "io-mem", IO_MEMORY, 1 },
+	{ "stdio", IO_NONE, 0 },
+	{ "io-file", IO_FILE, 0 },
+	{ "io-fd", IO_FD, 0 }
+};
+
+struct Backend {
+	const char* name;
+	enum HPCS_IOBackend backend;
+};
+
+static const struct Backend BACKENDS[] = {
+	{ "mmap", HPCS_IO_AUTO },
+	{ "stdio", HPCS_IO_STDIO }
+};
+
+static double now(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, cnt;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&cnt);
+	return (double)cnt.QuadPart / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1.0e9;
+#endif
+}
+
+static double file_size(const char* path)
+{
+	FILE* fh = fopen(path, "rb");
+	long size;
+
+	if (fh == NULL)
+		return -1.0;
+	fseek(fh, 0, SEEK_END);
+	size = ftell(fh);
+	fclose(fh);
+
+	return (double)size;
+}
+
+static int bench_mdata(const char* path, const int iterations, const double size)
+{
+	size_t idx;
+
+	for (idx = 0; idx < sizeof(BACKENDS) / sizeof(BACKENDS[0]); idx++) {
+		const struct Backend* b = &BACKENDS[idx];
+		size_t samples = 0;
+		double start, elapsed;
+		int it;
+
+		hpcs_set_io_backend(b->backend);
+
+		start = now();
+		for (it = 0; it < iterations; it++) {
+			struct HPCS_MeasuredData* mdata = hpcs_alloc_mdata();
+			enum HPCS_RetCode hret;
+
+			if (mdata == NULL) {
+				printf("Out of memory\n");
+				return EXIT_FAILURE;
+			}
+
+			hret = hpcs_read_mdata(path, mdata);
+			if (hret != HPCS_OK) {
+				printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+				hpcs_free_mdata(mdata);
+				return EXIT_FAILURE;
+			}
+			samples = mdata->data_count;
+			hpcs_free_mdata(mdata);
+		}
+		elapsed = now() - start;
+
+		printf("read_mdata   %-6s %10.2f MB/s %14.0f samples/s %10.3f ms/file\n",
+		       b->name,
+		       (size * iterations) / (elapsed * 1024.0 * 1024.0),
+		       (double)samples * iterations / elapsed,
+		       elapsed * 1000.0 / iterations);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static int bench_reader(const char* path, const int iterations, const double size)
+{
+	struct HPCS_Reader* reader;
+	size_t idx;
+
+	if (hpcs_reader_create(&reader, NULL) != HPCS_OK) {
+		printf("Out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	for (idx = 0; idx < sizeof(BACKENDS) / sizeof(BACKENDS[0]); idx++) {
+		const struct Backend* b = &BACKENDS[idx];
+		size_t samples = 0;
+		double start, elapsed;
+		int it;
+
+		hpcs_set_io_backend(b->backend);
+
+		start = now();
+		for (it = 0; it < iterations; it++) {
+			struct HPCS_MeasuredData* mdata = hpcs_alloc_mdata_arena();
+			enum HPCS_RetCode hret;
+
+			if (mdata == NULL) {
+				printf("Out of memory\n");
+				hpcs_reader_destroy(reader);
+				return EXIT_FAILURE;
+			}
+
+			hret = hpcs_reader_read_mdata(reader, path, mdata);
+			if (hret != HPCS_OK) {
+				printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+				hpcs_free_mdata(mdata);
+				hpcs_reader_destroy(reader);
+				return EXIT_FAILURE;
+			}
+			samples = mdata->data_count;
+			hpcs_free_mdata(mdata);
+		}
+		elapsed = now() - start;
+
+		printf("reader       %-6s %10.2f MB/s %14.0f samples/s %10.3f ms/file\n",
+		       b->name,
+		       (size * iterations) / (elapsed * 1024.0 * 1024.0),
+		       (double)samples * iterations / elapsed,
+		       elapsed * 1000.0 / iterations);
+	}
+
+	hpcs_reader_destroy(reader);
+	return EXIT_SUCCESS;
+}
+
+static int LIBHPCS_CC count_chunk(const struct HPCS_TVPair* pairs, const size_t count, void* user_data)
+{
+	(void)pairs;
+	*(size_t*)user_data += count;
+
+	return 0;
+}
+
+static int bench_stream(const char* path, const int iterations, const double size)
+{
+	size_t samples = 0;
+	double start, elapsed;
+	int it;
+
+	hpcs_set_io_backend(HPCS_IO_AUTO);
+
+	start = now();
+	for (it = 0; it < iterations; it++) {
+		struct HPCS_MeasuredData* mdata = hpcs_alloc_mdata();
+		enum HPCS_RetCode hret;
+
+		if (mdata == NULL) {
+			printf("Out of memory\n");
+			return EXIT_FAILURE;
+		}
+
+		samples = 0;
+		hret = hpcs_stream_mdata(path, mdata, 0, count_chunk, &samples);
+		hpcs_free_mdata(mdata);
+		if (hret != HPCS_OK) {
+			printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+			return EXIT_FAILURE;
+		}
+	}
+	elapsed = now() - start;
+
+	printf("stream_mdata        %10.2f MB/s %14.0f samples/s %10.3f ms/file\n",
+	       (size * iterations) / (elapsed * 1024.0 * 1024.0),
+	       (double)samples * iterations / elapsed,
+	       elapsed * 1000.0 / iterations);
+
+	return EXIT_SUCCESS;
+}
+
+static char* load_file(const char* path, size_t* length)
+{
+	FILE* fh = fopen(path, "rb");
+	char* bytes;
+	long size;
+
+	if (fh == NULL)
+		return NULL;
+	fseek(fh, 0, SEEK_END);
+	size = ftell(fh);
+	fseek(fh, 0, SEEK_SET);
+
+	bytes = malloc(size > 0 ? size : 1);
+	if (bytes != NULL)
+		*length = fread(bytes, 1, size, fh);
+	fclose(fh);
+
+	return bytes;
+}
+
+/* Decoding of a file that is already in memory, without any I/O */
+static int bench_decode(const char* path, const int iterations)
+{
+	size_t length;
+	size_t samples = 0;
+	double start, elapsed;
+	int it;
+	char* bytes = load_file(path, &length);
+
+	if (bytes == NULL) {
+		printf("Cannot load file\n");
+		return EXIT_FAILURE;
+	}
+
+	start = now();
+	for (it = 0; it < iterations; it++) {
+		struct HPCS_MeasuredData* mdata = hpcs_alloc_mdata();
+		enum HPCS_RetCode hret;
+
+		if (mdata == NULL) {
+			printf("Out of memory\n");
+			free(bytes);
+			return EXIT_FAILURE;
+		}
+
+		hret = hpcs_read_mdata_buffer(bytes, length, mdata);
+		samples = mdata->data_count;
+		hpcs_free_mdata(mdata);
+		if (hret != HPCS_OK) {
+			printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+			free(bytes);
+			return EXIT_FAILURE;
+		}
+	}
+	elapsed = now() - start;
+
+	printf("decode              %14.0f samples/s %10.3f ns/sample\n",
+	       (double)samples * iterations / elapsed,
+	       elapsed * 1.0e9 / ((double)samples * iterations));
+
+	free(bytes);
+	return EXIT_SUCCESS;
+}
+
+/* Reads the signal into a plain array of doubles or of floats */
+static int bench_decode_values(const char* path, const int iterations, const int single)
+{
+	size_t length;
+	size_t samples = 0;
+	double start, elapsed;
+	int it;
+	char* bytes = load_file(path, &length);
+
+	if (bytes == NULL) {
+		printf("Cannot load file\n");
+		return EXIT_FAILURE;
+	}
+
+	start = now();
+	for (it = 0; it < iterations; it++) {
+		struct HPCS_MeasuredData* mdata = hpcs_alloc_mdata();
+		struct HPCS_IOMemory memory;
+		struct HPCS_IOSource io;
+		enum HPCS_RetCode hret;
+
+		if (mdata == NULL) {
+			printf("Out of memory\n");
+			free(bytes);
+			return EXIT_FAILURE;
+		}
+
+		hpcs_io_source_memory(&io, &memory, bytes, length);
+		if (single) {
+			struct HPCS_FloatSignal* signal = hpcs_alloc_float_signal();
+
+			hret = hpcs_read_mdata_float_io(&io, mdata, signal);
+			samples = signal->time.count;
+			hpcs_free_float_signal(signal);
+		} else {
+			struct HPCS_Signal* signal = hpcs_alloc_signal();
+
+			hret = hpcs_read_mdata_signal_io(&io, mdata, signal);
+			samples = signal->time.count;
+			hpcs_free_signal(signal);
+		}
+		hpcs_free_mdata(mdata);
+		if (hret != HPCS_OK) {
+			printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+			free(bytes);
+			return EXIT_FAILURE;
+		}
+	}
+	elapsed = now() - start;
+
+	printf("%-19s %14.0f samples/s %10.3f ns/sample\n",
+	       single ? "decode_float" : "decode_values",
+	       (double)samples * iterations / elapsed,
+	       elapsed * 1.0e9 / ((double)samples * iterations));
+
+	free(bytes);
+	return EXIT_SUCCESS;
+}
+
+/* Decodes into the reused chunk of a stream so that only the decoder itself is measured */
+static int bench_decode_stream(const char* path, const int iterations)
+{
+	size_t length;
+	size_t samples = 0;
+	double start, elapsed;
+	int it;
+	char* bytes = load_file(path, &length);
+
+	if (bytes == NULL) {
+		printf("Cannot load file\n");
+		return EXIT_FAILURE;
+	}
+
+	start = now();
+	for (it = 0; it < iterations; it++) {
+		struct HPCS_MeasuredData* mdata = hpcs_alloc_mdata();
+		struct HPCS_IOMemory memory;
+		struct HPCS_IOSource io;
+		struct HPCS_SignalStream* stream;
+		const struct HPCS_TVPair* pairs;
+		size_t count;
+		enum HPCS_RetCode hret;
+
+		if (mdata == NULL) {
+			printf("Out of memory\n");
+			free(bytes);
+			return EXIT_FAILURE;
+		}
+
+		hpcs_io_source_memory(&io, &memory, bytes, length);
+		hret = hpcs_open_stream_io(&io, mdata, 0, &stream);
+		if (hret == HPCS_OK) {
+			samples = 0;
+			while ((hret = hpcs_stream_next(stream, &pairs, &count)) == HPCS_OK && count > 0)
+				samples += count;
+			hpcs_close_stream(stream);
+		}
+		hpcs_free_mdata(mdata);
+		if (hret != HPCS_OK) {
+			printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+			free(bytes);
+			return EXIT_FAILURE;
+		}
+	}
+	elapsed = now() - start;
+
+	printf("decode_stream       %14.0f samples/s %10.3f ns/sample\n",
+	       (double)samples * iterations / elapsed,
+	       elapsed * 1.0e9 / ((double)samples * iterations));
+
+	free(bytes);
+	return EXIT_SUCCESS;
+}
+
+static enum HPCS_RetCode read_io_case(const struct IOCase* c, const char* path, const char* bytes, const size_t length,
+				      struct HPCS_MeasuredData* mdata)
+{
+	struct HPCS_IOSource io;
+	struct HPCS_IOMemory memory;
+	enum HPCS_RetCode hret;
+	FILE* fh;
+
+	switch (c->kind) {
+	case IO_MEMORY:
+		hpcs_io_source_memory(&io, &memory, bytes, length);
+		return hpcs_read_mdata_io(&io, mdata);
+	case IO_FILE:
+	case IO_FD:
+		fh = fopen(path, "rb");
+		if (fh == NULL)
+			return HPCS_E_CANT_OPEN;
+		if (c->kind == IO_FILE)
+			hpcs_io_source_file(&io, fh);
+		else
+			hpcs_io_source_fd(&io, fileno(fh));
+		hret = hpcs_read_mdata_io(&io, mdata);
+		fclose(fh);
+		return hret;
+	default:
+		if (c->from_buffer)
+			return hpcs_read_mdata_buffer(bytes, length, mdata);
+		return hpcs_read_mdata(path, mdata);
+	}
+}
+
+static int bench_io(const char* path, const int iterations, const double size)
+{
+	size_t length;
+	size_t idx;
+	char* bytes = load_file(path, &length);
+
+	if (bytes == NULL) {
+		printf("Cannot load file\n");
+		return EXIT_FAILURE;
+	}
+
+	hpcs_set_io_backend(HPCS_IO_STDIO);
+
+	for (idx = 0; idx < sizeof(IO_CASES) / sizeof(IO_CASES[0]); idx++) {
+		const struct IOCase* c = &IO_CASES[idx];
+		double start, elapsed;
+		int it;
+
+		start = now();
+		for (it = 0; it < iterations; it++) {
+			struct HPCS_MeasuredData* mdata = hpcs_alloc_mdata();
+			enum HPCS_RetCode hret;
+
+			if (mdata == NULL) {
+				printf("Out of memory\n");
+				free(bytes);
+				return EXIT_FAILURE;
+			}
+
+			hret = read_io_case(c, path, bytes, length, mdata);
+			hpcs_free_mdata(mdata);
+			if (hret != HPCS_OK) {
+				printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+				free(bytes);
+				return EXIT_FAILURE;
+			}
+		}
+		elapsed = now() - start;
+
+		printf("io_source    %-7s %9.2f MB/s %10.3f ms/file\n",
+		       c->name,
+		       (size * iterations) / (elapsed * 1024.0 * 1024.0),
+		       elapsed * 1000.0 / iterations);
+	}
+
+	free(bytes);
+	return EXIT_SUCCESS;
+}
+
+static int bench_batch(const char* path, const int iterations, const double size)
+{
+	static const int THREADS[] = { 1, 2, 4, 8, 0 };
+	const size_t n = 64;
+	const char** paths;
+	struct HPCS_MeasuredData** out;
+	enum HPCS_RetCode* codes;
+	size_t idx;
+	size_t t;
+	int ret = EXIT_SUCCESS;
+
+	paths = malloc(sizeof(const char*) * n);
+	out = calloc(n, sizeof(struct HPCS_MeasuredData*));
+	codes = malloc(sizeof(enum HPCS_RetCode) * n);
+	if (paths == NULL || out == NULL || codes == NULL) {
+		printf("Out of memory\n");
+		ret = EXIT_FAILURE;
+		goto out;
+	}
+	for (idx = 0; idx < n; idx++)
+		paths[idx] = path;
+
+	hpcs_set_io_backend(HPCS_IO_AUTO);
+
+	for (t = 0; t < sizeof(THREADS) / sizeof(THREADS[0]); t++) {
+		double start, elapsed = 0.0;
+		int it;
+
+		for (it = 0; it < iterations; it++) {
+			for (idx = 0; idx < n; idx++) {
+				out[idx] = hpcs_alloc_mdata();
+				if (out[idx] == NULL) {
+					printf("Out of memory\n");
+					ret = EXIT_FAILURE;
+					goto out;
+				}
+			}
+
+			start = now();
+			hpcs_read_mdata_batch(paths, n, out, codes, THREADS[t]);
+			elapsed += now() - start;
+
+			for (idx = 0; idx < n; idx++) {
+				if (codes[idx] != HPCS_OK && ret == EXIT_SUCCESS) {
+					printf("Cannot parse file: %s\n", hpcs_error_to_string(codes[idx]));
+					ret = EXIT_FAILURE;
+				}
+				hpcs_free_mdata(out[idx]);
+				out[idx] = NULL;
+			}
+			if (ret != EXIT_SUCCESS)
+				goto out;
+		}
+
+		if (THREADS[t] == 0)
+			printf("read_batch   all CPUs  ");
+		else
+			printf("read_batch   %2d thr    ", THREADS[t]);
+		printf("%9.2f MB/s %10.3f ms/batch of %lu\n",
+		       (size * n * iterations) / (elapsed * 1024.0 * 1024.0),
+		       elapsed * 1000.0 / iterations,
+		       (unsigned long)n);
+	}
+
+out:
+	if (out != NULL) {
+		for (idx = 0; idx < n; idx++)
+			hpcs_free_mdata(out[idx]);
+	}
+	free(paths);
+	free(out);
+	free(codes);
+	return ret;
+}
+
+static int bench_parallel(const char* path, const int iterations, const double size)
+{
+	static const int THREADS[] = { 1, 2, 4, 8, 0 };
+	size_t t;
+
+	hpcs_set_io_backend(HPCS_IO_AUTO);
+
+	for (t = 0; t < sizeof(THREADS) / sizeof(THREADS[0]); t++) {
+		size_t samples = 0;
+		double start, elapsed;
+		int it;
+
+		start = now();
+		for (it = 0; it < iterations; it++) {
+			struct HPCS_MeasuredData* mdata = hpcs_alloc_mdata();
+			struct HPCS_Signal* signal = hpcs_alloc_signal();
+			enum HPCS_RetCode hret;
+
+			if (mdata == NULL || signal == NULL) {
+				printf("Out of memory\n");
+				hpcs_free_signal(signal);
+				hpcs_free_mdata(mdata);
+				return EXIT_FAILURE;
+			}
+
+			hret = hpcs_read_mdata_signal_parallel(path, mdata, signal, THREADS[t]);
+			if (hret != HPCS_OK) {
+				printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+				hpcs_free_signal(signal);
+				hpcs_free_mdata(mdata);
+				return EXIT_FAILURE;
+			}
+			samples = signal->time.count;
+			hpcs_free_signal(signal);
+			hpcs_free_mdata(mdata);
+		}
+		elapsed = now() - start;
+
+		if (THREADS[t] == 0)
+			printf("read_parallel all CPUs ");
+		else
+			printf("read_parallel %2d thr   ", THREADS[t]);
+		printf("%9.2f MB/s %14.0f samples/s %10.3f ms/file\n",
+		       (size * iterations) / (elapsed * 1024.0 * 1024.0),
+		       (double)samples * iterations / elapsed,
+		       elapsed * 1000.0 / iterations);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static int bench_async(const char* path, const int iterations, const double size)
+{
+	static const enum HPCS_AsyncBackend ASYNC_BACKENDS[] = { HPCS_ASYNC_THREADS, HPCS_ASYNC_IO_URING };
+	const size_t n = 64;
+	struct HPCS_AsyncResult results[16];
+	size_t b;
+
+	for (b = 0; b < sizeof(ASYNC_BACKENDS) / sizeof(ASYNC_BACKENDS[0]); b++) {
+		struct HPCS_AsyncContext* ctx;
+		double start, elapsed = 0.0;
+		int ret = EXIT_SUCCESS;
+		int it;
+
+		if (hpcs_async_create(&ctx, ASYNC_BACKENDS[b], 0) != HPCS_OK) {
+			printf("Cannot create async context\n");
+			return EXIT_FAILURE;
+		}
+		/* io_uring is not available everywhere */
+		if (hpcs_async_get_backend(ctx) != ASYNC_BACKENDS[b]) {
+			hpcs_async_destroy(ctx);
+			continue;
+		}
+
+		for (it = 0; it < iterations && ret == EXIT_SUCCESS; it++) {
+			size_t done = 0;
+			size_t idx;
+
+			start = now();
+			for (idx = 0; idx < n; idx++) {
+				struct HPCS_MeasuredData* mdata = hpcs_alloc_mdata();
+
+				if (mdata == NULL || hpcs_async_submit(ctx, path, mdata, HPCS_ASYNC_MDATA, NULL) != HPCS_OK) {
+					printf("Cannot submit request\n");
+					hpcs_free_mdata(mdata);
+					ret = EXIT_FAILURE;
+					break;
+				}
+			}
+
+			while (done < idx) {
+				const size_t count = hpcs_async_poll(ctx, results, sizeof(results) / sizeof(results[0]), 1);
+				size_t r;
+
+				for (r = 0; r < count; r++) {
+					if (results[r].code != HPCS_OK && ret == EXIT_SUCCESS) {
+						printf("Cannot parse file: %s\n", hpcs_error_to_string(results[r].code));
+						ret = EXIT_FAILURE;
+					}
+					hpcs_free_mdata(results[r].mdata);
+				}
+				done += count;
+			}
+			elapsed += now() - start;
+		}
+
+		hpcs_async_destroy(ctx);
+		if (ret != EXIT_SUCCESS)
+			return ret;
+
+		printf("read_async   %-8s %8.2f MB/s %10.3f ms/batch of %lu\n",
+		       ASYNC_BACKENDS[b] == HPCS_ASYNC_IO_URING ? "io_uring" : "threads",
+		       (size * n * iterations) / (elapsed * 1024.0 * 1024.0),
+		       elapsed * 1000.0 / iterations,
+		       (unsigned long)n);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static int bench_mheader(const char* path, const int iterations)
+{
+	double start, elapsed;
+	int it;
+
+	start = now();
+	for (it = 0; it < iterations; it++) {
+		struct HPCS_MeasuredData* mdata = hpcs_alloc_mdata();
+		enum HPCS_RetCode hret;
+
+		if (mdata == NULL) {
+			printf("Out of memory\n");
+			return EXIT_FAILURE;
+		}
+
+		hret = hpcs_read_mheader(path, mdata);
+		hpcs_free_mdata(mdata);
+		if (hret != HPCS_OK) {
+			printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+			return EXIT_FAILURE;
+		}
+	}
+	elapsed = now() - start;
+
+	printf("read_mheader        %10.0f headers/s %10.3f ms/file\n",
+	       iterations / elapsed,
+	       elapsed * 1000.0 / iterations);
+
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+	const char* path;
+	int iterations = 20;
+	double size;
+	int ret;
+
+	if (argc < 2) {
+		printf("Not enough arguments\n");
+		printf("Usage: bench_tool FILE [ITERATIONS]\n");
+		return EXIT_FAILURE;
+	}
+
+	path = argv[1];
+	if (argc > 2)
+		iterations = atoi(argv[2]);
+	if (iterations < 1)
+		iterations = 1;
+
+	size = file_size(path);
+	if (size < 0.0) {
+		printf("Cannot open file %s\n", path);
+		return EXIT_FAILURE;
+	}
+
+	printf("File: %s (%.0f bytes), %d iterations\n", path, size, iterations);
+
+	ret = bench_mdata(path, iterations, size);
+	if (ret != EXIT_SUCCESS)
+		return ret;
+
+	ret = bench_reader(path, iterations, size);
+	if (ret != EXIT_SUCCESS)
+		return ret;
+
+	ret = bench_stream(path, iterations, size);
+	if (ret != EXIT_SUCCESS)
+		return ret;
+
+	ret = bench_decode(path, iterations);
+	if (ret != EXIT_SUCCESS)
+		return ret;
+
+	ret = bench_decode_values(path, iterations, 0);
+	if (ret != EXIT_SUCCESS)
+		return ret;
+
+	ret = bench_decode_values(path, iterations, 1);
+	if (ret != EXIT_SUCCESS)
+		return ret;
+
+	ret = bench_decode_stream(path, iterations);
+	if (ret != EXIT_SUCCESS)
+		return ret;
+
+	ret = bench_io(path, iterations, size);
+	if (ret != EXIT_SUCCESS)
+		return ret;
+
+	ret = bench_batch(path, iterations, size);
+	if (ret != EXIT_SUCCESS)
+		return ret;
+
+	ret = bench_parallel(path, iterations, size);
+	if (ret != EXIT_SUCCESS)
+		return ret;
+
+	ret = bench_async(path, iterations, size);
+	if (ret != EXIT_SUCCESS)
+		return ret;
+
+	return bench_mheader(path, iterations);
+}
@@ -1,3 +1,10 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+#ifdef __linux__
+#define _DEFAULT_SOURCE /* syscall() and eventfd() */
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -5,6 +12,7 @@ extern "C" {
 #include <libHPCS.h>
 #include "libHPCS_p.h"
 #include <assert.h>
+#include <ctype.h>
 
 #ifdef _WIN32
 #include <sdkddkver.h>
@@ -17,16 +25,72 @@ extern "C" {
 #include <winnls.h>
 #endif
 #include <shlwapi.h>
+#include <io.h>
 #else
-#include <unicode/ustdio.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#ifdef _HPCS_HAVE_IO_URING
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#ifdef HPCS_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 #endif
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
+struct HPCS_FloatSignal* hpcs_alloc_float_signal()
+{
+	struct HPCS_FloatSignal* signal = mem_alloc(sizeof(struct HPCS_FloatSignal));
+	if (signal == NULL)
+		return NULL;
+
+	signal->values = NULL;
+	signal->time.count = 0;
+
+	return signal;
+}
+
 struct HPCS_MeasuredData* hpcs_alloc_mdata()
 {
-	struct HPCS_MeasuredData* mdata = malloc(sizeof(struct HPCS_MeasuredData));
+	struct HPCS_MeasuredData* mdata = mem_alloc(sizeof(struct HPCS_MeasuredData));
+	if (mdata == NULL)
+		return NULL;
+
+	mdata->file_description = NULL;
+	mdata->sample_info = NULL;
+	mdata->operator_name = NULL;
+	mdata->method_name = NULL;
+	mdata->cs_ver = NULL;
+	mdata->cs_rev = NULL;
+	mdata->y_units = NULL;
+	mdata->data = NULL;
+
+	mdata->data_count = 0;
+	mdata->predicted_count = 0;
+	mdata->arena = NULL;
+
+	return mdata;
+}
+
+struct HPCS_MeasuredData* hpcs_alloc_mdata_arena()
+{
+	const size_t header_size = arena_round(sizeof(struct HPCS_MeasuredData));
+	struct HPCS_MeasuredData* mdata = mem_alloc(header_size + arena_round(sizeof(struct HPCS_Arena)) + ARENA_CHUNK_SIZE);
 	if (mdata == NULL)
 		return NULL;
 
@@ -40,569 +104,3926 @@ struct HPCS_MeasuredData* hpcs_alloc_mdata()
 	mdata->data = NULL;
 
 	mdata->data_count = 0;
+	mdata->predicted_count = 0;
+
+	/* The first chunk shares the allocation of the object */
+	mdata->arena = (struct HPCS_Arena*)((char*)mdata + header_size);
+	mdata->arena->next = NULL;
+	mdata->arena->size = ARENA_CHUNK_SIZE;
+	mdata->arena->used = 0;
+	mdata->arena->allocator = NULL;
 
 	return mdata;
 }
 
 struct HPCS_MethodInfo* hpcs_alloc_minfo()
 {
-	struct HPCS_MethodInfo* minfo = malloc(sizeof(struct HPCS_MeasuredData));
+	struct HPCS_MethodInfo* minfo = mem_alloc(sizeof(struct HPCS_MethodInfo));
 	if (minfo == NULL)
 		return NULL;
 
 	minfo->blocks = NULL;
 	minfo->count = 0;
+	minfo->index = NULL;
 
 	return minfo;
 }
 
-const char* hpcs_error_to_string(const enum HPCS_RetCode err)
+struct HPCS_Signal* hpcs_alloc_signal()
 {
-	switch (err) {
-	case HPCS_OK:
-		return HPCS_OK_STR;
-	case HPCS_E_NULLPTR:
-		return HPCS_E_NULLPTR_STR;
-	case HPCS_E_CANT_OPEN:
-		return HPCS_E_CANT_OPEN_STR;
-	case HPCS_E_PARSE_ERROR:
-		return HPCS_E_PARSE_ERROR_STR;
-	case HPCS_E_UNKNOWN_TYPE:
-		return HPCS_E_UNKNOWN_TYPE_STR;
-	case HPCS_E_INCOMPATIBLE_FILE:
-		return HPCS_E_INCOMPATIBLE_FILE_STR;
-	default:
-		return HPCS_E__UNKNOWN_EC_STR;
-	}
+	struct HPCS_Signal* signal = mem_alloc(sizeof(struct HPCS_Signal));
+	if (signal == NULL)
+		return NULL;
+
+	signal->values = NULL;
+	signal->time.count = 0;
+
+	return signal;
 }
 
-void hpcs_free_mdata(struct HPCS_MeasuredData* const mdata)
+struct HPCS_RawSignal* hpcs_alloc_raw_signal()
 {
-	if (mdata == NULL)
-		return;
-	free(mdata->file_description);
-	free(mdata->sample_info);
-	free(mdata->operator_name);
-	free(mdata->method_name);
-	free(mdata->cs_ver);
-	free(mdata->cs_rev);
-	free(mdata->y_units);
-	free(mdata->data);
-	free(mdata);
+	struct HPCS_RawSignal* raw = mem_alloc(sizeof(struct HPCS_RawSignal));
+	if (raw == NULL)
+		return NULL;
+
+	raw->counts = NULL;
+	raw->time.count = 0;
+
+	return raw;
 }
 
-void hpcs_free_minfo(struct HPCS_MethodInfo* const minfo)
+struct HPCS_Envelope* hpcs_alloc_envelope()
 {
-	size_t idx;
+	struct HPCS_Envelope* envelope = mem_alloc(sizeof(struct HPCS_Envelope));
+	if (envelope == NULL)
+		return NULL;
 
-	if (minfo == NULL)
-		return;
+	envelope->min = NULL;
+	envelope->max = NULL;
+	envelope->mean = NULL;
+	envelope->time.count = 0;
 
-	for (idx = 0; idx < minfo->count; idx++) {
-		free(minfo->blocks[idx].name);
-		free(minfo->blocks[idx].value);
-	}
+	return envelope;
+}
+
+struct HPCS_SampledSignal* hpcs_alloc_sampled_signal()
+{
+	struct HPCS_SampledSignal* sampled = mem_alloc(sizeof(struct HPCS_SampledSignal));
+	if (sampled == NULL)
+		return NULL;
 
-	free(minfo->blocks);
-	free(minfo);
+	sampled->times = NULL;
+	sampled->values = NULL;
+	sampled->count = 0;
+
+	return sampled;
 }
 
-enum HPCS_RetCode hpcs_read_mdata(const char* filename, struct HPCS_MeasuredData* mdata)
+enum HPCS_RetCode hpcs_async_create(struct HPCS_AsyncContext** ctx, const enum HPCS_AsyncBackend backend, int threads)
 {
-	FILE* datafile;
-	enum HPCS_ParseCode pret;
-	enum HPCS_RetCode ret;
-	enum HPCS_GenType gentype;
-	enum HPCS_ChemStationVer cs_ver;
-	double signal_step;
-	double signal_shift;
-	HPCS_offset scans_start;
+	struct HPCS_AsyncContext* c;
+	size_t idx;
 
-	if (mdata == NULL)
+	if (ctx == NULL)
 		return HPCS_E_NULLPTR;
 
-	datafile = open_measurement_file(filename);
-	if (datafile == NULL)
-		return HPCS_E_CANT_OPEN;
+	c = mem_calloc(1, sizeof(struct HPCS_AsyncContext));
+	if (c == NULL)
+		return HPCS_E_PARSE_ERROR;
 
-	pret = read_generic_type(datafile, &gentype);
-	if (pret != PARSE_OK) {
-		PR_DEBUG("Cannot read generic file type\n");
-		ret = HPCS_E_PARSE_ERROR;
-		goto out;
+	if (!mutex_init(&c->lock))
+		goto err_free;
+	if (!cond_init(&c->work_cond))
+		goto err_lock;
+	if (!cond_init(&c->done_cond))
+		goto err_work_cond;
+	if (!async_notify_open(c))
+		goto err_done_cond;
+
+	c->backend = HPCS_ASYNC_THREADS;
+#ifdef _HPCS_HAVE_IO_URING
+	if (backend != HPCS_ASYNC_THREADS) {
+		if (__unix_uring_start(c))
+			c->backend = HPCS_ASYNC_IO_URING;
+		else
+			PR_DEBUG("io_uring is not available, using threads\n");
 	}
+#else
+	(void)backend;
+#endif
 
-	if (!gentype_is_readable(gentype)) {
-		PR_DEBUGF("%s: %d\n", "Incompatible file type", gentype);
-		ret = HPCS_E_INCOMPATIBLE_FILE;
-		goto out;
-	}
+	if (threads < 1)
+		threads = cpu_count();
+	c->workers = mem_alloc(sizeof(HPCS_Thread) * threads);
+	if (c->workers == NULL)
+		goto err_uring;
 
-	pret = read_file_type_description(datafile, &mdata->file_description, gentype);
-	if (pret != PARSE_OK) {
-		ret = HPCS_E_PARSE_ERROR;
-		goto out;
+	c->worker_start.func = async_worker;
+	c->worker_start.arg = c;
+	for (idx = 0; idx < (size_t)threads; idx++) {
+		if (!thread_create(&c->workers[idx], &c->worker_start))
+			break;
+		c->worker_count++;
 	}
-
-	if (!file_type_description_is_readable(mdata->file_description)) {
-		PR_DEBUGF("Incompatible file description: %s\n", mdata->file_description);
-		ret = HPCS_E_INCOMPATIBLE_FILE;
-		goto out;
+	if (c->worker_count == 0) {
+		mem_free(c->workers);
+		goto err_uring;
 	}
 
-	pret = read_file_header(datafile, &cs_ver, mdata, gentype);
-	if (pret != PARSE_OK) {
-		PR_DEBUG("Cannot read the header\n");
-		ret = HPCS_E_PARSE_ERROR;
-		goto out;
-	}
+	*ctx = c;
+	return HPCS_OK;
 
-	/* Old data formats do not containg sampling rate information, set it manually */
-	if (OLD_FORMAT(gentype)) {
-		switch (mdata->file_type) {
-		case HPCS_TYPE_CE_DAD:
-			mdata->sampling_rate = 20.0;
-			break;
-		case HPCS_TYPE_CE_ANALOG:
-			mdata->sampling_rate = 10.0;
-			break;
-		default:
-			mdata->sampling_rate = CE_WORK_PARAM_SAMPRATE;
-		}
-	}
+err_uring:
+#ifdef _HPCS_HAVE_IO_URING
+	if (c->backend == HPCS_ASYNC_IO_URING)
+		__unix_uring_stop(c);
+#endif
+	async_notify_close(c);
+err_done_cond:
+	cond_destroy(&c->done_cond);
+err_work_cond:
+	cond_destroy(&c->work_cond);
+err_lock:
+	mutex_destroy(&c->lock);
+err_free:
+	mem_free(c);
+	return HPCS_E_PARSE_ERROR;
+}
 
-	pret = fetch_signal_step(datafile, &signal_step, &signal_shift, OLD_FORMAT(gentype));
-	if (pret != PARSE_OK) {
-		PR_DEBUG("Cannot read signal step and shift\n");
-		ret = HPCS_E_PARSE_ERROR;
-		goto out;
+void hpcs_async_destroy(struct HPCS_AsyncContext* ctx)
+{
+	size_t idx;
+
+	if (ctx == NULL)
+		return;
+
+	/* Let the requests in flight finish, their results are discarded */
+	mutex_lock(&ctx->lock);
+	while (ctx->in_flight > 0)
+		cond_wait(&ctx->done_cond, &ctx->lock);
+	ctx->stopping = true;
+	cond_broadcast(&ctx->work_cond);
+	mutex_unlock(&ctx->lock);
+
+	for (idx = 0; idx < ctx->worker_count; idx++)
+		thread_join(ctx->workers[idx]);
+	mem_free(ctx->workers);
+
+#ifdef _HPCS_HAVE_IO_URING
+	if (ctx->backend == HPCS_ASYNC_IO_URING)
+		__unix_uring_stop(ctx);
+#endif
+
+	while (ctx->done_head != NULL) {
+		struct HPCS_AsyncRequest* req = ctx->done_head;
+		ctx->done_head = req->next;
+		async_free_request(req);
 	}
-	PR_DEBUGF("Signal step: %g, shift: %g\n", signal_step, signal_shift);
 
-	pret = read_scans_start(datafile, &scans_start);
-	if (pret != PARSE_OK) {
-		PR_DEBUG("Cannot read scans start offset\n");
-		ret = HPCS_E_PARSE_ERROR;
-		goto out;
+	async_notify_close(ctx);
+	cond_destroy(&ctx->done_cond);
+	cond_destroy(&ctx->work_cond);
+	mutex_destroy(&ctx->lock);
+	mem_free(ctx);
+}
+
+int hpcs_async_fd(const struct HPCS_AsyncContext* ctx)
+{
+	if (ctx == NULL)
+		return -1;
+
+	return ctx->notify_fd[0];
+}
+
+enum HPCS_AsyncBackend hpcs_async_get_backend(const struct HPCS_AsyncContext* ctx)
+{
+	if (ctx == NULL)
+		return HPCS_ASYNC_THREADS;
+
+	return ctx->backend;
+}
+
+size_t hpcs_async_poll(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncResult* results, const size_t max, const int wait)
+{
+	size_t count = 0;
+
+	if (ctx == NULL || results == NULL)
+		return 0;
+
+	async_notify_drain(ctx);
+
+	mutex_lock(&ctx->lock);
+	if (wait) {
+		while (ctx->done_head == NULL && ctx->in_flight > 0)
+			cond_wait(&ctx->done_cond, &ctx->lock);
 	}
 
-	pret = read_signal(datafile, &mdata->data, &mdata->data_count, scans_start, signal_step, signal_shift, gentype);
-	if (pret != PARSE_OK) {
-		PR_DEBUG("Cannot parse data in the file\n");
-		ret = HPCS_E_PARSE_ERROR;
+	while (count < max && ctx->done_head != NULL) {
+		struct HPCS_AsyncRequest* req = ctx->done_head;
+
+		ctx->done_head = req->next;
+		if (ctx->done_head == NULL)
+			ctx->done_tail = NULL;
+
+		results[count].mdata = req->mdata;
+		results[count].user_data = req->user_data;
+		results[count].code = req->code;
+		count++;
+
+		async_free_request(req);
 	}
-	else
-		ret = HPCS_OK;
 
-	pret = read_timing(datafile, mdata->data, &mdata->sampling_rate, mdata->data_count,
-			   gentype == GENTYPE_GC_B);
-	if (pret != PARSE_OK)
-		ret = HPCS_E_PARSE_ERROR;
+	/* Keep the descriptor readable while there are results left */
+	if (ctx->done_head != NULL)
+		async_notify_signal(ctx);
+	mutex_unlock(&ctx->lock);
 
-out:
-	fclose(datafile);
-	return ret;
+	return count;
 }
 
-enum HPCS_RetCode hpcs_read_mheader(const char* filename, struct HPCS_MeasuredData* mdata)
+enum HPCS_RetCode hpcs_async_submit(struct HPCS_AsyncContext* ctx, const char* filename, struct HPCS_MeasuredData* mdata,
+				    const enum HPCS_AsyncOp op, void* user_data)
 {
-	FILE* datafile;
-	enum HPCS_ParseCode pret;
+	struct HPCS_AsyncRequest* req;
+
+	if (ctx == NULL || filename == NULL || mdata == NULL)
+		return HPCS_E_NULLPTR;
+
+	req = mem_calloc(1, sizeof(struct HPCS_AsyncRequest));
+	if (req == NULL)
+		return HPCS_E_PARSE_ERROR;
+	req->filename = mem_alloc(strlen(filename) + 1);
+	if (req->filename == NULL) {
+		mem_free(req);
+		return HPCS_E_PARSE_ERROR;
+	}
+	strcpy(req->filename, filename);
+	req->mdata = mdata;
+	req->op = op;
+	req->user_data = user_data;
+	req->fd = -1;
+	req->state = ASYNC_LOAD;
+
+	mutex_lock(&ctx->lock);
+	ctx->in_flight++;
+	mutex_unlock(&ctx->lock);
+
+#ifdef _HPCS_HAVE_IO_URING
+	if (ctx->backend == HPCS_ASYNC_IO_URING) {
+		req->state = ASYNC_OPENING;
+		if (__unix_uring_submit(ctx, req))
+			return HPCS_OK;
+		/* Load the file on a worker if the ring does not accept the request */
+		req->state = ASYNC_LOAD;
+	}
+#endif
+
+	async_enqueue_work(ctx, req);
+	return HPCS_OK;
+}
+
+enum HPCS_RetCode hpcs_build_index(const char* filename, const size_t interval)
+{
+	struct HPCS_DataSource src;
+	struct HPCS_SignalIndex index;
 	enum HPCS_RetCode ret;
-	enum HPCS_GenType gentype;
-	enum HPCS_ChemStationVer cs_ver;
 
-	if (mdata == NULL)
+	if (filename == NULL)
 		return HPCS_E_NULLPTR;
 
-	datafile = open_measurement_file(filename);
-	if (datafile == NULL)
+	/* The file is stamped before it is read so that a change made meanwhile invalidates the index */
+	if (!file_stamp(filename, &index.file_size, &index.mtime, &index.mtime_nsec))
 		return HPCS_E_CANT_OPEN;
 
-	pret = read_generic_type(datafile, &gentype);
-	if (pret != PARSE_OK) {
-		PR_DEBUG("Cannot read generic file type\n");
-		ret = HPCS_E_PARSE_ERROR;
-		goto out;
-	}
-
-	if (!gentype_is_readable(gentype)) {
-		PR_DEBUGF("%s: %d\n", "Incompatible file type", gentype);
-		ret = HPCS_E_INCOMPATIBLE_FILE;
-		goto out;
-	}
+	if (open_data_source(filename, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
 
-	pret = read_file_type_description(datafile, &mdata->file_description, gentype);
-	if (pret != PARSE_OK) {
-		ret = HPCS_E_PARSE_ERROR;
-		goto out;
+	if (src.file_size != index.file_size) {
+		close_data_source(&src);
+		return HPCS_E_CANT_OPEN;
 	}
 
-	if (!file_type_description_is_readable(mdata->file_description)) {
-		PR_DEBUGF("Incompatible file description: %s\n", mdata->file_description);
-		ret = HPCS_E_INCOMPATIBLE_FILE;
-		goto out;
-	}
+	ret = build_signal_index(&src, interval > 0 ? interval : INDEX_DEFAULT_INTERVAL, &index);
+	close_data_source(&src);
 
-	pret = read_file_header(datafile, &cs_ver, mdata, gentype);
-	if (pret != PARSE_OK)
-		ret = HPCS_E_PARSE_ERROR;
-	else
-		ret = HPCS_OK;
+	if (ret == HPCS_OK && index.interval > 0 && !write_signal_index(filename, &index))
+		ret = HPCS_E_CANT_OPEN;
 
-out:
-	fclose(datafile);
+	mem_free(index.checkpoints.items);
 	return ret;
 }
 
-enum HPCS_RetCode hpcs_read_minfo(const char* filename, struct HPCS_MethodInfo* minfo)
+enum HPCS_RetCode hpcs_build_index_batch(const char** paths, const size_t n, const size_t interval, enum HPCS_RetCode* codes, int threads)
 {
-	enum HPCS_ParseCode pret;
-	HPCS_UFH fh;
+	struct HPCS_BatchIndex batch;
 
-	if (minfo == NULL)
+	if (paths == NULL || codes == NULL)
 		return HPCS_E_NULLPTR;
 
-	fh = open_data_file(filename);
-	if (fh == NULL)
-		return HPCS_E_CANT_OPEN;
+	batch.paths = paths;
+	batch.interval = interval;
+	batch.codes = codes;
 
-	pret = read_method_info_file(fh, minfo);
-	if (pret != PARSE_OK)
+	if (parallel_for(batch_index_task, &batch, n, threads) != PARSE_OK)
 		return HPCS_E_PARSE_ERROR;
 
 	return HPCS_OK;
 }
 
-static enum HPCS_ParseCode autodetect_file_type(FILE* datafile, enum HPCS_FileType* file_type, const bool p_means_pressure, const enum HPCS_GenType gentype)
+enum HPCS_RetCode hpcs_build_pyramid(const struct HPCS_Signal* signal, struct HPCS_Pyramid** pyramid)
 {
-	char* type_id;
-	enum HPCS_ParseCode pret;
-	const HPCS_offset devsig_info_offset = OLD_FORMAT(gentype) ? DATA_OFFSET_DEVSIG_INFO_OLD : DATA_OFFSET_DEVSIG_INFO;
+	struct HPCS_Pyramid* p;
+	struct HPCS_PyramidLevel* level;
+	const enum HPCS_SimdLevel simd = detect_simd_level();
+	size_t idx;
 
-	pret = read_string_at_offset(datafile, devsig_info_offset, &type_id, OLD_FORMAT(gentype));
-	if (pret != PARSE_OK)
-		return pret;
+	if (signal == NULL || pyramid == NULL)
+		return HPCS_E_NULLPTR;
 
-	if (!strcmp(type_id, FILE_TYPE_ID_ADC_A)) {
-		*file_type = HPCS_TYPE_CE_ANALOG;
-		goto out;
+	p = mem_calloc(1, sizeof(struct HPCS_Pyramid));
+	if (p == NULL)
+		return HPCS_E_PARSE_ERROR;
+
+	p->values = signal->values;
+	p->time = signal->time;
+
+	if (signal->time.count < PYRAMID_BASE) {
+		*pyramid = p;
+		return HPCS_OK;
 	}
-	if (!strcmp(type_id, FILE_TYPE_ID_ADC_B)) {
-		*file_type = HPCS_TYPE_CE_ANALOG;
-		goto out;
+
+	/* The finest level is the only one computed from the samples, every further level
+	   combines pairs of buckets of the level below */
+	if (!pyramid_add_level(p, signal->time.count / PYRAMID_BASE))
+		goto err;
+	level = &p->levels[0];
+	for (idx = 0; idx < level->count; idx++) {
+		const double* values = signal->values + idx * PYRAMID_BASE;
+		double lo = values[0];
+		double hi = values[0];
+		double sum = 0.0;
+
+		min_max_sum(values, PYRAMID_BASE, &lo, &hi, &sum, simd);
+		level->min[idx] = lo;
+		level->max[idx] = hi;
+		level->sum[idx] = sum;
 	}
 
-	if (strstr(type_id, FILE_TYPE_ID_DAD) == type_id)
-		*file_type = HPCS_TYPE_CE_DAD;
-	else if (strstr(type_id, FILE_TYPE_ID_HPCE) == type_id) {
-		const char hpce_id = type_id[strlen(FILE_TYPE_ID_HPCE) + 1];
+	while (p->levels_count < PYRAMID_MAX_LEVELS && p->levels[p->levels_count - 1].count >= 2) {
+		const struct HPCS_PyramidLevel* below = &p->levels[p->levels_count - 1];
 
-		if (hpce_id == FILE_TYPE_HPCE_CCD)
-			*file_type = HPCS_TYPE_CE_CCD;
-		else if (hpce_id == FILE_TYPE_HPCE_CURRENT)
-			*file_type = HPCS_TYPE_CE_CURRENT;
-		else if (hpce_id == FILE_TYPE_HPCE_POWER)
-			*file_type = HPCS_TYPE_CE_POWER;
-		else if (hpce_id == FILE_TYPE_HPCE_POWER_PRESSURE)
-			*file_type = p_means_pressure ? HPCS_TYPE_CE_PRESSURE : HPCS_TYPE_CE_POWER;
-		else if (hpce_id == FILE_TYPE_HPCE_TEMPERATURE)
-			*file_type = HPCS_TYPE_CE_TEMPERATURE;
-		else if (hpce_id == FILE_TYPE_HPCE_VOLTAGE)
-			*file_type = HPCS_TYPE_CE_VOLTAGE;
-		else
-			*file_type = HPCS_TYPE_UNKNOWN;
-	} else
-		*file_type = HPCS_TYPE_UNKNOWN;
+		if (!pyramid_add_level(p, below->count / 2))
+			goto err;
+		level = &p->levels[p->levels_count - 1];
+		for (idx = 0; idx < level->count; idx++) {
+			const size_t b = 2 * idx;
 
-out:
-	free(type_id);
+			level->min[idx] = below->min[b] < below->min[b + 1] ? below->min[b] : below->min[b + 1];
+			level->max[idx] = below->max[b] > below->max[b + 1] ? below->max[b] : below->max[b + 1];
+			level->sum[idx] = below->sum[b] + below->sum[b + 1];
+		}
+	}
 
-	return PARSE_OK;
+	*pyramid = p;
+	return HPCS_OK;
+
+err:
+	hpcs_free_pyramid(p);
+	return HPCS_E_PARSE_ERROR;
 }
 
-static enum HPCS_DataCheckCode check_for_marker(const char* segment, size_t* const next_marker_idx, const size_t segments_read)
+const char* hpcs_error_to_string(const enum HPCS_RetCode err)
 {
-	if (segment[0] == BIN_MARKER_A) {
-		if (segments_read != *next_marker_idx)
-			return DCHECK_NO_MARKER;
-
-		if (segment[1] == BIN_MARKER_END)
-			return DCHECK_NO_MARKER;
-
-		*next_marker_idx += (uint8_t)segment[1] + 1;
-		return DCHECK_GOT_MARKER;
-	} else
-		return DCHECK_NO_MARKER;
+	switch (err) {
+	case HPCS_OK:
+		return HPCS_OK_STR;
+	case HPCS_E_NULLPTR:
+		return HPCS_E_NULLPTR_STR;
+	case HPCS_E_CANT_OPEN:
+		return HPCS_E_CANT_OPEN_STR;
+	case HPCS_E_PARSE_ERROR:
+		return HPCS_E_PARSE_ERROR_STR;
+	case HPCS_E_UNKNOWN_TYPE:
+		return HPCS_E_UNKNOWN_TYPE_STR;
+	case HPCS_E_INCOMPATIBLE_FILE:
+		return HPCS_E_INCOMPATIBLE_FILE_STR;
+	default:
+		return HPCS_E__UNKNOWN_EC_STR;
+	}
 }
 
-static enum HPCS_ChemStationVer detect_chemstation_version(const char*const version_string)
+void hpcs_set_allocator(const struct HPCS_Allocator* const alloc)
 {
-	PR_DEBUGF("ChemStation version string: %s\n", version_string);
+	if (alloc == NULL || alloc->allocate == NULL || alloc->reallocate == NULL || alloc->release == NULL)
+		memset(&allocator, 0, sizeof(allocator));
+	else
+		allocator = *alloc;
+}
 
-	if (!strcmp(version_string, CHEMSTAT_B0625_STR)) {
-		PR_DEBUG("ChemStation B.06.25\n");
-		return CHEMSTAT_B0625;
-	}
-	else if (!strcmp(version_string, CHEMSTAT_B0626_STR)) {
-		PR_DEBUG("ChemStation B.06.26\n");
-		return CHEMSTAT_B0626;
-	}
-	else if (!strcmp(version_string, CHEMSTAT_B0643_STR)) {
-		PR_DEBUG("ChemStation B.06.43\n");
-		return CHEMSTAT_B0643;
-	}
-	else if (!strcmp(version_string, CHEMSTAT_B0644_STR)) {
-		PR_DEBUG("ChemStation B.06.44\n");
-		return CHEMSTAT_B0644;
-	}
-	else if (strlen(version_string) == 0) {
-		PR_DEBUG("ChemStation Untagged\n");
-		return CHEMSTAT_UNTAGGED;
-	}
+void hpcs_set_io_backend(const enum HPCS_IOBackend backend)
+{
+	io_backend = backend;
+}
 
-	PR_DEBUG("Unknown ChemStation version\n");
-	return CHEMSTAT_UNKNOWN;
+void hpcs_free_envelope(struct HPCS_Envelope* const envelope)
+{
+	if (envelope == NULL)
+		return;
+	mem_free(envelope->min);
+	mem_free(envelope->max);
+	mem_free(envelope->mean);
+	mem_free(envelope);
 }
 
-static enum HPCS_ParseCode expand_storage(struct HPCS_TVPair** pairs, size_t* const alloc_size)
+void hpcs_free_float_signal(struct HPCS_FloatSignal* const signal)
 {
-	struct HPCS_TVPair* nptr;
-	*alloc_size += (size_t)((60 * 25));
-	nptr = realloc(*pairs, sizeof(struct HPCS_TVPair) * (*alloc_size));
+	if (signal == NULL)
+		return;
+	mem_free(signal->values);
+	mem_free(signal);
+}
 
-	if (nptr == NULL) {
-		free(*pairs);
-		*pairs = NULL;
-		return PARSE_E_NO_MEM;
+void hpcs_free_mdata(struct HPCS_MeasuredData* const mdata)
+{
+	if (mdata == NULL)
+		return;
+	if (mdata->arena != NULL) {
+		arena_release(mdata->arena, (struct HPCS_Arena*)((char*)mdata + arena_round(sizeof(struct HPCS_MeasuredData))));
+		mem_free(mdata);
+		return;
 	}
+	mem_free(mdata->file_description);
+	mem_free(mdata->sample_info);
+	mem_free(mdata->operator_name);
+	mem_free(mdata->method_name);
+	mem_free(mdata->cs_ver);
+	mem_free(mdata->cs_rev);
+	mem_free(mdata->y_units);
+	mem_free(mdata->data);
+	mem_free(mdata);
+}
 
-	*pairs = nptr;
+void hpcs_free_minfo(struct HPCS_MethodInfo* const minfo)
+{
+	if (minfo == NULL)
+		return;
 
-	return PARSE_OK;
+	/* Names and values are stored together with the blocks */
+	mem_free(minfo->blocks);
+	mem_free(minfo);
 }
 
-static enum HPCS_ParseCode fetch_signal_step(FILE *datafile, double *step, double *shift, bool old_format)
+void hpcs_free_pyramid(struct HPCS_Pyramid* const pyramid)
 {
-	int32_t version;
-	double _step;
-	double _shift;
-	HPCS_offset veroff;
-	HPCS_offset shiftoff;
-	HPCS_offset stepoff;
+	size_t idx;
 
-	if (old_format) {
-		veroff = DATA_OFFSET_SIGSTEP_VERSION_OLD;
-		shiftoff = DATA_OFFSET_SIGSTEP_SHIFT_OLD;
-		stepoff = DATA_OFFSET_SIGSTEP_STEP_OLD;
-	} else {
-		veroff = DATA_OFFSET_SIGSTEP_VERSION;
-		shiftoff = DATA_OFFSET_SIGSTEP_SHIFT;
-		stepoff = DATA_OFFSET_SIGSTEP_STEP;
+	if (pyramid == NULL)
+		return;
+	for (idx = 0; idx < pyramid->levels_count; idx++) {
+		mem_free(pyramid->levels[idx].min);
+		mem_free(pyramid->levels[idx].max);
+		mem_free(pyramid->levels[idx].sum);
 	}
+	mem_free(pyramid);
+}
 
-	fseek(datafile, veroff, SEEK_SET);
-	if (feof(datafile))
-		return PARSE_E_OUT_OF_RANGE;
-	if (ferror(datafile))
-		return PARSE_E_CANT_READ;
-        if (fread(&version, LARGE_SEGMENT_SIZE, 1, datafile) < 1)
-		return PARSE_E_CANT_READ;
+void hpcs_free_raw_signal(struct HPCS_RawSignal* const raw)
+{
+	if (raw == NULL)
+		return;
+	mem_free(raw->counts);
+	mem_free(raw);
+}
 
-	be_to_cpu_val(version);
-	switch (version) {
-	case 1:
-		*step = SIGSTEP_V1;
-		*shift = 0.0;
-		return PARSE_OK;
-	case 2:
-		*step = SIGSTEP_V2;
-		*shift = 0.0;
-		return PARSE_OK;
-	default:
-		break;
+void hpcs_free_run(struct HPCS_Run* const run)
+{
+	size_t idx;
+
+	if (run == NULL)
+		return;
+
+	for (idx = 0; idx < run->trace_count; idx++) {
+		mem_free(run->traces[idx].name);
+		hpcs_free_mdata(run->traces[idx].mdata);
+	}
+	for (idx = 0; idx < run->method_count; idx++) {
+		mem_free(run->methods[idx].name);
+		hpcs_free_minfo(run->methods[idx].minfo);
 	}
 
-	fseek(datafile, shiftoff, SEEK_SET);
-	if (feof(datafile))
-		return PARSE_E_OUT_OF_RANGE;
-	if (ferror(datafile))
-		return PARSE_E_CANT_READ;
-        if (fread(&_shift, DOUBLE_SEGMENT_SIZE, 1, datafile) < 1)
-		return PARSE_E_CANT_READ;
+	mem_free(run->traces);
+	mem_free(run->methods);
+	mem_free(run->path);
+	mem_free(run);
+}
 
-	fseek(datafile, stepoff, SEEK_SET);
-	if (feof(datafile))
-		return PARSE_E_OUT_OF_RANGE;
-	if (ferror(datafile))
-		return PARSE_E_CANT_READ;
-        if (fread(&_step, DOUBLE_SEGMENT_SIZE, 1, datafile) < 1)
-		return PARSE_E_CANT_READ;
+void hpcs_free_runs(struct HPCS_Run** const runs, const size_t count)
+{
+	size_t idx;
 
-	be_to_cpu_val(_shift);
-	be_to_cpu_val(_step);
-	*shift = _shift;
-	*step = _step;
+	if (runs == NULL)
+		return;
 
-	return PARSE_OK;
+	for (idx = 0; idx < count; idx++)
+		hpcs_free_run(runs[idx]);
+	mem_free(runs);
 }
 
-static bool file_type_description_is_readable(const char*const description)
+void hpcs_free_sampled_signal(struct HPCS_SampledSignal* const sampled)
 {
-	if (!strcmp(FILE_DESC_LC_DATA_FILE, description))
-		return true;
-	else if (!strcmp(FILE_DESC_GC_DATA_FILE, description))
-		return true;
-	else
-		return false;
+	if (sampled == NULL)
+		return;
+	mem_free(sampled->times);
+	mem_free(sampled->values);
+	mem_free(sampled);
 }
 
-static bool gentype_is_readable(const enum HPCS_GenType gentype)
+void hpcs_free_signal(struct HPCS_Signal* const signal)
 {
-	switch (gentype) {
-	case GENTYPE_ADC_LC:
-	case GENTYPE_ADC_LC2:
-	case GENTYPE_GC_B:
-		return true;
-	default:
-		return false;
-	}
+	if (signal == NULL)
+		return;
+	mem_free(signal->values);
+	mem_free(signal);
 }
 
-static uint8_t month_to_number(const char* month)
+void hpcs_io_source_fd(struct HPCS_IOSource* io, const int fd)
 {
-	if (strcmp(MON_JAN_STR, month) == 0)
-		return 1;
-	else if (strcmp(MON_FEB_STR, month) == 0)
-		return 2;
-	else if (strcmp(MON_MAR_STR, month) == 0)
-		return 3;
-	else if (strcmp(MON_APR_STR, month) == 0)
-		return 4;
-	else if (strcmp(MON_MAY_STR, month) == 0)
-		return 5;
-	else if (strcmp(MON_JUN_STR, month) == 0)
-		return 6;
-	else if (strcmp(MON_JUL_STR, month) == 0)
-		return 7;
-	else if (strcmp(MON_AUG_STR, month) == 0)
-		return 8;
-	else if (strcmp(MON_SEP_STR, month) == 0)
-		return 9;
-	else if (strcmp(MON_OCT_STR, month) == 0)
-		return 10;
-	else if (strcmp(MON_NOV_STR, month) == 0)
-		return 11;
-	else if (strcmp(MON_DEC_STR, month) == 0)
-		return 12;
-	else
-		return 0;
+	io->handle = (void*)(intptr_t)fd;
+	io->read = io_fd_read;
+	io->seek = io_fd_seek;
+	io->size = io_fd_size;
 }
 
-static enum HPCS_ParseCode next_native_line(HPCS_UFH fh, HPCS_NChar* line, int32_t length)
+void hpcs_io_source_file(struct HPCS_IOSource* io, FILE* fh)
 {
-#ifdef _WIN32
-	return __win32_next_native_line(fh, line, length);
-#else
-	return __unix_next_native_line(fh, line, length);
-#endif
+	io->handle = fh;
+	io->read = io_file_read;
+	io->seek = io_file_seek;
+	io->size = io_file_size;
 }
 
-static HPCS_UFH open_data_file(const char* filename)
+void hpcs_io_source_memory(struct HPCS_IOSource* io, struct HPCS_IOMemory* memory, const void* bytes, const size_t length)
 {
-#ifdef _WIN32
-	return __win32_open_data_file(filename);
-#else
-	return __unix_open_data_file(filename);
-#endif
+	memory->bytes = bytes;
+	memory->length = length;
+	memory->position = 0;
+
+	io->handle = memory;
+	io->read = io_memory_read;
+	io->seek = io_memory_seek;
+	io->size = io_memory_size;
 }
 
-static FILE* open_measurement_file(const char* filename)
+enum HPCS_RetCode hpcs_read_mdata(const char* filename, struct HPCS_MeasuredData* mdata)
 {
-#ifdef _WIN32
-	FILE* f;
-	wchar_t *win_filename;
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
 
-	if (!__win32_utf8_to_wchar(&win_filename, filename))
-		return NULL;
+	if (mdata == NULL)
+		return HPCS_E_NULLPTR;
 
-	f = _wfopen(win_filename, L"rb");
-	free(win_filename);
-	return f;
-#else
-	return fopen(filename, "rb");
-#endif
-}
+	if (open_data_source(filename, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
 
-static bool p_means_pressure(const enum HPCS_ChemStationVer version)
-{
-	if (version == CHEMSTAT_B0625)
-		return false;
+	ret = read_measurement(&src, mdata, false);
 
-	return true;
+	close_data_source(&src);
+	return ret;
 }
 
-static enum HPCS_ParseCode parse_native_method_info_line(char** name, char** value, HPCS_NChar* line)
+enum HPCS_RetCode hpcs_read_mdata_batch(const char** paths, const size_t n, struct HPCS_MeasuredData** out, enum HPCS_RetCode* codes, int threads)
 {
-#ifdef _WIN32
-	return __win32_parse_native_method_info_line(name, value, line);
-#else
-	return __unix_parse_native_method_info_line(name, value, line);
-#endif
+	struct HPCS_BatchRead batch;
+
+	if (paths == NULL || out == NULL || codes == NULL)
+		return HPCS_E_NULLPTR;
+
+	batch.paths = paths;
+	batch.out = out;
+	batch.codes = codes;
+
+	if (parallel_for(batch_read_task, &batch, n, threads) != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	return HPCS_OK;
 }
 
-static enum HPCS_ParseCode read_dad_wavelength(FILE* datafile, struct HPCS_Wavelength* const measured, struct HPCS_Wavelength* const reference, const enum HPCS_GenType gentype)
+enum HPCS_RetCode hpcs_reader_create(struct HPCS_Reader** reader, const struct HPCS_Allocator* const alloc)
 {
-	char* start_idx, *interv_idx, *end_idx, *temp, *str;
-	size_t len, tmp_len;
-	enum HPCS_ParseCode pret, ret;
-	const HPCS_offset devsig_info_offset = OLD_FORMAT(gentype) ? DATA_OFFSET_DEVSIG_INFO_OLD : DATA_OFFSET_DEVSIG_INFO;
+	const size_t header_size = arena_round(sizeof(struct HPCS_Reader));
+	const size_t size = header_size + arena_round(sizeof(struct HPCS_Arena)) + ARENA_CHUNK_SIZE;
+	struct HPCS_Reader* r;
+	struct HPCS_Arena* first;
+	bool has_allocator;
 
-	measured->wavelength = 0;
-	measured->interval = 0;
-	reference->wavelength = 0;
-	reference->interval = 0;
-	pret = read_string_at_offset(datafile, devsig_info_offset, &str, OLD_FORMAT(gentype));
-	if (pret != PARSE_OK)
-		return pret;
+	if (reader == NULL)
+		return HPCS_E_NULLPTR;
 
-	/* Read MEASURED wavelength */
-	start_idx = strstr(str, WAVELENGTH_MEASURED_TEXT);
-	if (start_idx == NULL) {
-		ret = PARSE_W_NO_DATA;
-		goto out;
-	}
+	has_allocator = alloc != NULL && alloc->allocate != NULL && alloc->reallocate != NULL && alloc->release != NULL;
 
-	start_idx += strlen(WAVELENGTH_MEASURED_TEXT);
-	interv_idx = strchr(start_idx, WAVELENGTH_DELIMITER_TEXT);
-	if (interv_idx == NULL) {
-		PR_DEBUG("No spectral interval value\n");
-		ret = PARSE_E_NOT_FOUND;
-		goto out;
-	}
-	end_idx = strchr(interv_idx, WAVELENGTH_END_TEXT);
-	if (end_idx == NULL) {
-		PR_DEBUG("No measured/reference wavelength delimiter found\n");
-		ret = PARSE_E_NOT_FOUND;
-		goto out;
-	}
+	r = has_allocator ? alloc->allocate(alloc->handle, size) : mem_alloc(size);
+	if (r == NULL)
+		return HPCS_E_PARSE_ERROR;
 
-	if (start_idx >= interv_idx) {
-		PR_DEBUG("start_idx >= interv_idx\n");
-		ret = PARSE_E_CANT_READ;
-		goto out;
-	}
+	r->has_allocator = has_allocator;
+	if (has_allocator)
+		r->allocator = *alloc;
 
-	len = interv_idx - start_idx;
-	temp = malloc(len + 1);
-	if (temp == NULL) {
-		PR_DEBUG("No memory for temporary string\n");
-		ret = PARSE_E_NO_MEM;
-		goto out;
-	}
-	memcpy(temp, start_idx, len);
-	temp[len] = 0;
-	measured->wavelength = (uint16_t)strtoul(temp, NULL, 10);
+	/* The first chunk of the scratch arena shares the allocation of the reader */
+	first = reader_first_chunk(r);
+	first->next = NULL;
+	first->size = ARENA_CHUNK_SIZE;
+	first->used = 0;
+	first->allocator = reader_allocator(r);
+	r->scratch = first;
+
+	r->buffer = NULL;
+
+	*reader = r;
+	return HPCS_OK;
+}
+
+void hpcs_reader_destroy(struct HPCS_Reader* reader)
+{
+	if (reader == NULL)
+		return;
+
+	arena_release(reader->scratch, reader_first_chunk(reader));
+	allocator_free(reader_allocator(reader), reader->buffer);
+	if (reader->has_allocator) {
+		/* The allocator is stored in the memory being released */
+		const struct HPCS_Allocator allocator = reader->allocator;
+
+		allocator.release(allocator.handle, reader);
+	} else
+		mem_free(reader);
+}
+
+enum HPCS_RetCode hpcs_reader_read_mdata(struct HPCS_Reader* reader, const char* filename, struct HPCS_MeasuredData* mdata)
+{
+	struct HPCS_DataSource src;
+	struct HPCS_Cursor cursor;
+	struct HPCS_Arena* first;
+	enum HPCS_GenType gentype;
+	enum HPCS_RetCode ret;
+
+	if (reader == NULL || mdata == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (reader_open_source(reader, filename, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	/* Temporary strings of the previous file are not needed anymore */
+	first = reader_first_chunk(reader);
+	arena_release(reader->scratch, first);
+	first->next = NULL;
+	first->used = 0;
+	reader->scratch = first;
+
+	cursor_init(&cursor, &src);
+
+	ret = read_measurement_header(&cursor, mdata, &gentype, &reader->scratch);
+	if (ret == HPCS_OK)
+		ret = read_measurement_signal(&cursor, mdata, gentype);
+
+	/* The buffer belongs to the reader */
+	src.buffer = NULL;
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_mdata_buffer(const void* bytes, const size_t length, struct HPCS_MeasuredData* mdata)
+{
+	struct HPCS_DataSource src;
+
+	if (mdata == NULL || bytes == NULL)
+		return HPCS_E_NULLPTR;
+
+	open_memory_source(bytes, length, &src);
+
+	return read_measurement(&src, mdata, false);
+}
+
+enum HPCS_RetCode hpcs_read_mdata_float(const char* filename, struct HPCS_MeasuredData* mdata, struct HPCS_FloatSignal* signal)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || signal == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_data_source(filename, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_float(&src, mdata, signal);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_mdata_float_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata, struct HPCS_FloatSignal* signal)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || signal == NULL || io == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_io_source(io, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_float(&src, mdata, signal);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_mdata_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || io == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_io_source(io, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement(&src, mdata, false);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_mdata_raw(const char* filename, struct HPCS_MeasuredData* mdata, struct HPCS_RawSignal* raw)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || raw == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_data_source(filename, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_raw(&src, mdata, raw);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_mdata_raw_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata, struct HPCS_RawSignal* raw)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || raw == NULL || io == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_io_source(io, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_raw(&src, mdata, raw);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_mdata_signal(const char* filename, struct HPCS_MeasuredData* mdata, struct HPCS_Signal* signal)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || signal == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_data_source(filename, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_values(&src, mdata, signal);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_mdata_signal_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata, struct HPCS_Signal* signal)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || signal == NULL || io == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_io_source(io, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_values(&src, mdata, signal);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_mdata_signal_parallel(const char* filename, struct HPCS_MeasuredData* mdata, struct HPCS_Signal* signal, int threads)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || signal == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_data_source(filename, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_values_parallel(&src, mdata, signal, threads);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_mheader(const char* filename, struct HPCS_MeasuredData* mdata)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_header_source(filename, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement(&src, mdata, true);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_mheader_buffer(const void* bytes, const size_t length, struct HPCS_MeasuredData* mdata)
+{
+	struct HPCS_DataSource src;
+
+	if (mdata == NULL || bytes == NULL)
+		return HPCS_E_NULLPTR;
+
+	open_memory_source(bytes, length, &src);
+
+	return read_measurement(&src, mdata, true);
+}
+
+enum HPCS_RetCode hpcs_read_mheader_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || io == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_io_header_source(io, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement(&src, mdata, true);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_minfo(const char* filename, struct HPCS_MethodInfo* minfo)
+{
+	enum HPCS_ParseCode pret;
+	FILE* fh;
+
+	if (minfo == NULL)
+		return HPCS_E_NULLPTR;
+
+	fh = open_measurement_file(filename);
+	if (fh == NULL)
+		return HPCS_E_CANT_OPEN;
+
+	pret = read_method_info_file(fh, minfo);
+	fclose(fh);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	return HPCS_OK;
+}
+
+const char* hpcs_minfo_get(const struct HPCS_MethodInfo* minfo, const char* name)
+{
+	const struct HPCS_MethodInfoBlock* block;
+	size_t idx;
+
+	if (minfo == NULL || name == NULL)
+		return NULL;
+
+	if (minfo->index != NULL) {
+		block = method_index_find(minfo->index, minfo->blocks, name);
+		return block == NULL ? NULL : block->value;
+	}
+
+	for (idx = 0; idx < minfo->count; idx++) {
+		if (strcmp(minfo->blocks[idx].name, name) == 0)
+			return minfo->blocks[idx].value;
+	}
+
+	return NULL;
+}
+
+size_t hpcs_minfo_next(const struct HPCS_MethodInfo* minfo, const char* prefix, size_t from)
+{
+	size_t length;
+
+	if (minfo == NULL)
+		return 0;
+	if (prefix == NULL)
+		return from < minfo->count ? from : minfo->count;
+
+	length = strlen(prefix);
+	for (; from < minfo->count; from++) {
+		if (strncmp(minfo->blocks[from].name, prefix, length) == 0)
+			return from;
+	}
+
+	return minfo->count;
+}
+
+enum HPCS_RetCode hpcs_read_run(const char* path, struct HPCS_Run** run, int threads)
+{
+	struct HPCS_RunScan scan;
+	struct HPCS_Run* r = NULL;
+	enum HPCS_ParseCode pret;
+	size_t dir_idx;
+
+	if (path == NULL || run == NULL)
+		return HPCS_E_NULLPTR;
+
+	memset(&scan, 0, sizeof(scan));
+
+	pret = run_scan_open_dir(&scan, NULL, path, &dir_idx);
+	if (pret != PARSE_OK)
+		goto out;
+
+	r = run_alloc(scan.dirs[dir_idx].path);
+	if (r == NULL) {
+		pret = PARSE_E_NO_MEM;
+		goto out;
+	}
+
+	pret = run_scan(&scan, dir_idx, r);
+	if (pret == PARSE_OK)
+		pret = run_load(&scan, threads);
+
+out:
+	run_scan_free(&scan);
+	if (pret != PARSE_OK) {
+		hpcs_free_run(r);
+		return pret == PARSE_E_CANT_READ ? HPCS_E_CANT_OPEN : HPCS_E_PARSE_ERROR;
+	}
+
+	*run = r;
+	return HPCS_OK;
+}
+
+enum HPCS_RetCode hpcs_read_run_tree(const char* path, struct HPCS_Run*** runs, size_t* count, int threads)
+{
+	struct HPCS_RunTree tree;
+	struct HPCS_RunDir root;
+	enum HPCS_ParseCode pret;
+
+	if (path == NULL || runs == NULL || count == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (!dir_open(NULL, path, &root))
+		return HPCS_E_CANT_OPEN;
+
+	memset(&tree, 0, sizeof(tree));
+	tree.max_dirs = run_tree_max_dirs();
+	tree.threads = threads;
+
+	pret = run_tree_walk(&tree, &root);
+	dir_close(&root);
+	if (pret == PARSE_OK)
+		pret = run_load(&tree.scan, threads);
+	run_scan_free(&tree.scan);
+
+	if (pret != PARSE_OK) {
+		hpcs_free_runs(tree.runs, tree.count);
+		return pret == PARSE_E_CANT_READ ? HPCS_E_CANT_OPEN : HPCS_E_PARSE_ERROR;
+	}
+
+	*runs = tree.runs;
+	*count = tree.count;
+	return HPCS_OK;
+}
+
+enum HPCS_RetCode hpcs_read_signal_range(const char* filename, const double t_start, const double t_end, struct HPCS_MeasuredData* mdata,
+					 struct HPCS_Signal* signal)
+{
+	struct HPCS_DataSource src;
+	struct HPCS_SignalIndex index;
+	bool indexed;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || signal == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_data_source(filename, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	indexed = load_signal_index(filename, &index) && index.file_size == src.file_size;
+	ret = read_measurement_range(&src, t_start, t_end, mdata, signal, indexed ? &index : NULL);
+
+	mem_free(index.checkpoints.items);
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_signal_range_io(const struct HPCS_IOSource* io, const double t_start, const double t_end, struct HPCS_MeasuredData* mdata,
+					    struct HPCS_Signal* signal)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || signal == NULL || io == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_io_source(io, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_range(&src, t_start, t_end, mdata, signal, NULL);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_envelope(const char* filename, const size_t buckets, struct HPCS_MeasuredData* mdata, struct HPCS_Envelope* envelope)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || envelope == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_data_source(filename, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_envelope(&src, buckets, mdata, envelope);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_envelope_io(const struct HPCS_IOSource* io, const size_t buckets, struct HPCS_MeasuredData* mdata,
+					struct HPCS_Envelope* envelope)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || envelope == NULL || io == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_io_source(io, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_envelope(&src, buckets, mdata, envelope);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_lttb(const char* filename, const size_t points, struct HPCS_MeasuredData* mdata, struct HPCS_SampledSignal* sampled)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || sampled == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_data_source(filename, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_lttb(&src, points, mdata, sampled);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_read_lttb_io(const struct HPCS_IOSource* io, const size_t points, struct HPCS_MeasuredData* mdata,
+				    struct HPCS_SampledSignal* sampled)
+{
+	struct HPCS_DataSource src;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || sampled == NULL || io == NULL)
+		return HPCS_E_NULLPTR;
+
+	if (open_io_source(io, &src) != PARSE_OK)
+		return HPCS_E_CANT_OPEN;
+
+	ret = read_measurement_lttb(&src, points, mdata, sampled);
+
+	close_data_source(&src);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_pyramid_query(const struct HPCS_Pyramid* pyramid, const double t_start, const double t_end,
+				     const size_t buckets, struct HPCS_Envelope* envelope)
+{
+	size_t first;
+	size_t end;
+	size_t span;
+	size_t count;
+	size_t idx;
+	double* min;
+	double* max;
+	double* mean;
+
+	if (pyramid == NULL || envelope == NULL)
+		return HPCS_E_NULLPTR;
+
+	window_samples(&pyramid->time, t_start, t_end, &first, &end);
+	span = end - first;
+	count = buckets < span ? buckets : span;
+
+	/* Each array is kept by the envelope as soon as it is reallocated so that nothing leaks if a later one fails */
+	min = mem_realloc(envelope->min, sizeof(double) * (count > 0 ? count : 1));
+	if (min != NULL)
+		envelope->min = min;
+	max = mem_realloc(envelope->max, sizeof(double) * (count > 0 ? count : 1));
+	if (max != NULL)
+		envelope->max = max;
+	mean = mem_realloc(envelope->mean, sizeof(double) * (count > 0 ? count : 1));
+	if (mean != NULL)
+		envelope->mean = mean;
+	if (min == NULL || max == NULL || mean == NULL) {
+		envelope->time.count = 0;
+		return HPCS_E_PARSE_ERROR;
+	}
+
+	/* Bucket i holds the samples from i * span / count up to (i + 1) * span / count, rounded up */
+	for (idx = 0; idx < count; idx++) {
+		const size_t a = first + (size_t)(((uint64_t)span * idx + count - 1) / count);
+		const size_t b = first + (size_t)(((uint64_t)span * (idx + 1) + count - 1) / count);
+		double sum;
+
+		pyramid_reduce(pyramid, a, b, &min[idx], &max[idx], &sum);
+		mean[idx] = sum / (double)(b - a);
+	}
+
+	envelope->time.t0 = pyramid->time.t0 + first * pyramid->time.dt;
+	envelope->time.dt = count > 0 ? pyramid->time.dt * span / count : pyramid->time.dt;
+	envelope->time.count = count;
+
+	return HPCS_OK;
+}
+
+void hpcs_close_stream(struct HPCS_SignalStream* stream)
+{
+	if (stream == NULL)
+		return;
+
+	close_data_source(&stream->src);
+	mem_free(stream->chunk);
+	mem_free(stream);
+}
+
+enum HPCS_RetCode hpcs_open_stream(const char* filename, struct HPCS_MeasuredData* mdata, const size_t chunk_size, struct HPCS_SignalStream** stream)
+{
+	struct HPCS_SignalStream* s;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || stream == NULL)
+		return HPCS_E_NULLPTR;
+
+	s = mem_alloc(sizeof(struct HPCS_SignalStream));
+	if (s == NULL)
+		return HPCS_E_PARSE_ERROR;
+
+	if (open_data_source(filename, &s->src) != PARSE_OK) {
+		mem_free(s);
+		return HPCS_E_CANT_OPEN;
+	}
+
+	ret = open_signal_stream(s, mdata, chunk_size);
+	if (ret != HPCS_OK) {
+		hpcs_close_stream(s);
+		return ret;
+	}
+
+	*stream = s;
+	return HPCS_OK;
+}
+
+enum HPCS_RetCode hpcs_open_stream_io(const struct HPCS_IOSource* io, struct HPCS_MeasuredData* mdata, const size_t chunk_size, struct HPCS_SignalStream** stream)
+{
+	struct HPCS_SignalStream* s;
+	enum HPCS_RetCode ret;
+
+	if (mdata == NULL || stream == NULL || io == NULL)
+		return HPCS_E_NULLPTR;
+
+	s = mem_alloc(sizeof(struct HPCS_SignalStream));
+	if (s == NULL)
+		return HPCS_E_PARSE_ERROR;
+
+	if (open_io_source(io, &s->src) != PARSE_OK) {
+		mem_free(s);
+		return HPCS_E_CANT_OPEN;
+	}
+
+	ret = open_signal_stream(s, mdata, chunk_size);
+	if (ret != HPCS_OK) {
+		hpcs_close_stream(s);
+		return ret;
+	}
+
+	*stream = s;
+	return HPCS_OK;
+}
+
+enum HPCS_RetCode hpcs_stream_mdata(const char* filename, struct HPCS_MeasuredData* mdata, const size_t chunk_size,
+				    HPCS_StreamCallback callback, void* user_data)
+{
+	struct HPCS_SignalStream* stream;
+	const struct HPCS_TVPair* pairs;
+	size_t count;
+	enum HPCS_RetCode ret;
+
+	if (callback == NULL)
+		return HPCS_E_NULLPTR;
+
+	ret = hpcs_open_stream(filename, mdata, chunk_size, &stream);
+	if (ret != HPCS_OK)
+		return ret;
+
+	while (true) {
+		ret = hpcs_stream_next(stream, &pairs, &count);
+		if (ret != HPCS_OK || count == 0)
+			break;
+		if (callback(pairs, count, user_data) != 0)
+			break;
+	}
+
+	hpcs_close_stream(stream);
+	return ret;
+}
+
+enum HPCS_RetCode hpcs_stream_next(struct HPCS_SignalStream* stream, const struct HPCS_TVPair** pairs, size_t* count)
+{
+	size_t decoded;
+	size_t idx;
+	double t;
+	enum HPCS_ParseCode pret;
+
+	if (stream == NULL || pairs == NULL || count == NULL)
+		return HPCS_E_NULLPTR;
+
+	*pairs = stream->chunk;
+	*count = 0;
+	if (stream->decoder.finished)
+		return HPCS_OK;
+
+	pret = decoder_decode(&stream->decoder, &stream->chunk[0].value, sizeof(struct HPCS_TVPair), stream->chunk_size, &decoded);
+	if (pret != PARSE_OK) {
+		PR_DEBUG("Cannot parse data in the file\n");
+		return HPCS_E_PARSE_ERROR;
+	}
+
+	/* Continue the running sum so that the times match hpcs_read_mdata() exactly */
+	t = stream->time;
+	for (idx = 0; idx < decoded; idx++) {
+		stream->chunk[idx].time = t;
+		t += stream->time_step;
+	}
+	stream->time = t;
+
+	*count = decoded;
+	return HPCS_OK;
+}
+
+void hpcs_time_axis_fill(const struct HPCS_TimeAxis* axis, const size_t first, const size_t count, double* times)
+{
+	size_t idx;
+
+	for (idx = 0; idx < count; idx++)
+		times[idx] = axis->t0 + (double)(first + idx) * axis->dt;
+}
+
+/* Allocates with the given allocator, or with mem_alloc() if it is NULL */
+static void* allocator_alloc(const struct HPCS_Allocator* allocator, const size_t size)
+{
+	if (allocator == NULL)
+		return mem_alloc(size);
+	return allocator->allocate(allocator->handle, size);
+}
+
+static void allocator_free(const struct HPCS_Allocator* allocator, void* ptr)
+{
+	if (allocator == NULL)
+		mem_free(ptr);
+	else if (ptr != NULL)
+		allocator->release(allocator->handle, ptr);
+}
+
+/* Appends a bucket to an envelope */
+static bool append_bucket(struct HPCS_Envelope* envelope, size_t* allocated, const double lo, const double hi, const double mean)
+{
+	const size_t count = envelope->time.count;
+
+	if (count == *allocated) {
+		size_t min_allocated = *allocated;
+		size_t max_allocated = *allocated;
+		size_t mean_allocated = *allocated;
+		double* nmin;
+		double* nmax;
+		double* nmean;
+
+		nmin = grow_array(envelope->min, &min_allocated, count + 1, sizeof(double));
+		if (nmin == NULL)
+			return false;
+		envelope->min = nmin;
+
+		nmax = grow_array(envelope->max, &max_allocated, count + 1, sizeof(double));
+		if (nmax == NULL)
+			return false;
+		envelope->max = nmax;
+
+		nmean = grow_array(envelope->mean, &mean_allocated, count + 1, sizeof(double));
+		if (nmean == NULL)
+			return false;
+		envelope->mean = nmean;
+
+		*allocated = min_allocated;
+	}
+
+	envelope->min[count] = lo;
+	envelope->max[count] = hi;
+	envelope->mean[count] = mean;
+	envelope->time.count++;
+	return true;
+}
+
+/* Appends a pair of values to two arrays of the same length */
+static bool append_pair(double** first, double** second, size_t* allocated, const size_t count, const double a, const double b)
+{
+	if (count == *allocated) {
+		size_t first_allocated = *allocated;
+		size_t second_allocated = *allocated;
+		double* nfirst;
+		double* nsecond;
+
+		nfirst = grow_array(*first, &first_allocated, count + 1, sizeof(double));
+		if (nfirst == NULL)
+			return false;
+		*first = nfirst;
+
+		nsecond = grow_array(*second, &second_allocated, count + 1, sizeof(double));
+		if (nsecond == NULL)
+			return false;
+		*second = nsecond;
+
+		*allocated = first_allocated;
+	}
+
+	(*first)[count] = a;
+	(*second)[count] = b;
+	return true;
+}
+
+/* Allocates from the arena, or with mem_alloc() if there is no arena. Allocations that do not fit
+   into the current chunk get a chunk of their own, large ones are kept out of the way of small ones. */
+static void* arena_alloc(struct HPCS_Arena** arena, const size_t size)
+{
+	const size_t header_size = arena_round(sizeof(struct HPCS_Arena));
+	struct HPCS_Arena* chunk;
+	size_t rounded;
+	char* ptr;
+
+	if (arena == NULL || *arena == NULL)
+		return mem_alloc(size);
+
+	if (size > (size_t)-1 - header_size - ARENA_ALIGNMENT)
+		return NULL;
+	rounded = arena_round(size);
+
+	chunk = *arena;
+	if (chunk->size - chunk->used < rounded) {
+		const size_t chunk_size = rounded > ARENA_CHUNK_SIZE ? rounded : ARENA_CHUNK_SIZE;
+
+		chunk = allocator_alloc((*arena)->allocator, header_size + chunk_size);
+		if (chunk == NULL)
+			return NULL;
+		chunk->size = chunk_size;
+		chunk->used = 0;
+		chunk->allocator = (*arena)->allocator;
+
+		if (chunk_size > ARENA_CHUNK_SIZE) {
+			chunk->next = (*arena)->next;
+			(*arena)->next = chunk;
+		} else {
+			chunk->next = *arena;
+			*arena = chunk;
+		}
+	}
+
+	ptr = (char*)chunk + header_size + chunk->used;
+	chunk->used += rounded;
+	return ptr;
+}
+
+/* Frees memory returned by arena_alloc() unless it belongs to an arena */
+static void arena_free(struct HPCS_Arena** arena, void* ptr)
+{
+	if (arena == NULL || *arena == NULL)
+		mem_free(ptr);
+}
+
+/* Frees all chunks of an arena except for the one that shares the allocation of its owner */
+static void arena_release(struct HPCS_Arena* chunk, const struct HPCS_Arena* keep)
+{
+	while (chunk != NULL) {
+		struct HPCS_Arena* next = chunk->next;
+
+		if (chunk != keep)
+			allocator_free(chunk->allocator, chunk);
+		chunk = next;
+	}
+}
+
+static size_t arena_round(const size_t size)
+{
+	return (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+}
+
+/* Moves a finished request to the list of results */
+static void async_complete(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncRequest* req)
+{
+	mem_free(req->bytes);
+	req->bytes = NULL;
+	req->next = NULL;
+
+	mutex_lock(&ctx->lock);
+	if (ctx->done_tail != NULL)
+		ctx->done_tail->next = req;
+	else
+		ctx->done_head = req;
+	ctx->done_tail = req;
+	ctx->in_flight--;
+	cond_broadcast(&ctx->done_cond);
+	async_notify_signal(ctx);
+	mutex_unlock(&ctx->lock);
+}
+
+static void async_enqueue_work(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncRequest* req)
+{
+	req->next = NULL;
+
+	mutex_lock(&ctx->lock);
+	if (ctx->work_tail != NULL)
+		ctx->work_tail->next = req;
+	else
+		ctx->work_head = req;
+	ctx->work_tail = req;
+	cond_signal(&ctx->work_cond);
+	mutex_unlock(&ctx->lock);
+}
+
+static void async_free_request(struct HPCS_AsyncRequest* req)
+{
+	mem_free(req->filename);
+	mem_free(req->bytes);
+	mem_free(req);
+}
+
+static void async_notify_close(struct HPCS_AsyncContext* ctx)
+{
+#ifdef _WIN32
+	(void)ctx;
+#else
+	__unix_notify_close(ctx);
+#endif
+}
+
+static void async_notify_drain(struct HPCS_AsyncContext* ctx)
+{
+#ifdef _WIN32
+	(void)ctx;
+#else
+	__unix_notify_drain(ctx);
+#endif
+}
+
+static bool async_notify_open(struct HPCS_AsyncContext* ctx)
+{
+#ifdef _WIN32
+	ctx->notify_fd[0] = -1;
+	ctx->notify_fd[1] = -1;
+	return true;
+#else
+	return __unix_notify_open(ctx);
+#endif
+}
+
+static void async_notify_signal(struct HPCS_AsyncContext* ctx)
+{
+#ifdef _WIN32
+	(void)ctx;
+#else
+	__unix_notify_signal(ctx);
+#endif
+}
+
+/* Either loads and parses a file, or parses a file that has been loaded by io_uring */
+static void async_process(struct HPCS_AsyncRequest* req)
+{
+	const bool header_only = req->op == HPCS_ASYNC_MHEADER;
+
+	if (req->state == ASYNC_PARSE) {
+		struct HPCS_DataSource src;
+
+		open_memory_source(req->bytes, req->done, &src);
+		src.file_size = req->file_size;
+		req->code = read_measurement(&src, req->mdata, header_only);
+	} else if (header_only)
+		req->code = hpcs_read_mheader(req->filename, req->mdata);
+	else
+		req->code = hpcs_read_mdata(req->filename, req->mdata);
+}
+
+static void async_worker(void* arg)
+{
+	struct HPCS_AsyncContext* ctx = arg;
+
+	mutex_lock(&ctx->lock);
+	while (true) {
+		struct HPCS_AsyncRequest* req;
+
+		while (ctx->work_head == NULL && !ctx->stopping)
+			cond_wait(&ctx->work_cond, &ctx->lock);
+		if (ctx->work_head == NULL)
+			break;
+
+		req = ctx->work_head;
+		ctx->work_head = req->next;
+		if (ctx->work_head == NULL)
+			ctx->work_tail = NULL;
+		mutex_unlock(&ctx->lock);
+
+		async_process(req);
+		async_complete(ctx, req);
+
+		mutex_lock(&ctx->lock);
+	}
+	mutex_unlock(&ctx->lock);
+}
+
+static enum HPCS_ParseCode autodetect_file_type(struct HPCS_Cursor* cursor, enum HPCS_FileType* file_type, const bool p_means_pressure, const enum HPCS_GenType gentype,
+						struct HPCS_Arena** arena)
+{
+	char* type_id;
+	enum HPCS_ParseCode pret;
+	const HPCS_offset devsig_info_offset = OLD_FORMAT(gentype) ? DATA_OFFSET_DEVSIG_INFO_OLD : DATA_OFFSET_DEVSIG_INFO;
+
+	pret = read_string_at_offset(cursor, devsig_info_offset, &type_id, OLD_FORMAT(gentype), arena);
+	if (pret != PARSE_OK)
+		return pret;
+
+	if (!strcmp(type_id, FILE_TYPE_ID_ADC_A)) {
+		*file_type = HPCS_TYPE_CE_ANALOG;
+		goto out;
+	}
+	if (!strcmp(type_id, FILE_TYPE_ID_ADC_B)) {
+		*file_type = HPCS_TYPE_CE_ANALOG;
+		goto out;
+	}
+
+	if (strstr(type_id, FILE_TYPE_ID_DAD) == type_id)
+		*file_type = HPCS_TYPE_CE_DAD;
+	else if (strstr(type_id, FILE_TYPE_ID_HPCE) == type_id) {
+		const char hpce_id = type_id[strlen(FILE_TYPE_ID_HPCE) + 1];
+
+		if (hpce_id == FILE_TYPE_HPCE_CCD)
+			*file_type = HPCS_TYPE_CE_CCD;
+		else if (hpce_id == FILE_TYPE_HPCE_CURRENT)
+			*file_type = HPCS_TYPE_CE_CURRENT;
+		else if (hpce_id == FILE_TYPE_HPCE_POWER)
+			*file_type = HPCS_TYPE_CE_POWER;
+		else if (hpce_id == FILE_TYPE_HPCE_POWER_PRESSURE)
+			*file_type = p_means_pressure ? HPCS_TYPE_CE_PRESSURE : HPCS_TYPE_CE_POWER;
+		else if (hpce_id == FILE_TYPE_HPCE_TEMPERATURE)
+			*file_type = HPCS_TYPE_CE_TEMPERATURE;
+		else if (hpce_id == FILE_TYPE_HPCE_VOLTAGE)
+			*file_type = HPCS_TYPE_CE_VOLTAGE;
+		else
+			*file_type = HPCS_TYPE_UNKNOWN;
+	} else
+		*file_type = HPCS_TYPE_UNKNOWN;
+
+out:
+	arena_free(arena, type_id);
+
+	return PARSE_OK;
+}
+
+static void batch_index_task(void* ctx, const size_t idx)
+{
+	struct HPCS_BatchIndex* batch = ctx;
+
+	batch->codes[idx] = hpcs_build_index(batch->paths[idx], batch->interval);
+}
+
+static void batch_read_task(void* ctx, const size_t idx)
+{
+	struct HPCS_BatchRead* batch = ctx;
+
+	if (batch->out[idx] == NULL)
+		batch->codes[idx] = HPCS_E_NULLPTR;
+	else
+		batch->codes[idx] = hpcs_read_mdata(batch->paths[idx], batch->out[idx]);
+}
+
+/* Decodes the whole signal and takes a checkpoint every interval samples */
+static enum HPCS_RetCode build_signal_index(struct HPCS_DataSource* src, const size_t interval, struct HPCS_SignalIndex* index)
+{
+	double block[NARROW_BLOCK_SIZE];
+	struct HPCS_Cursor cursor;
+	struct HPCS_SignalParams params;
+	struct HPCS_SignalDecoder decoder;
+	struct HPCS_MeasuredData* mdata;
+	struct HPCS_CheckpointList* checkpoints = &index->checkpoints;
+	enum HPCS_ParseCode pret;
+	enum HPCS_RetCode ret;
+
+	checkpoints->items = NULL;
+	checkpoints->count = 0;
+	checkpoints->allocated = 0;
+	checkpoints->failed = false;
+	index->sample_count = 0;
+	index->interval = interval;
+
+	mdata = hpcs_alloc_mdata_arena();
+	if (mdata == NULL)
+		return HPCS_E_PARSE_ERROR;
+
+	cursor_init(&cursor, src);
+
+	ret = read_measurement_header(&cursor, mdata, &params.gentype, &mdata->arena);
+	hpcs_free_mdata(mdata);
+	if (ret != HPCS_OK)
+		return ret;
+
+	pret = read_signal_params(&cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	/* 179 signal is seeked to directly */
+	if (params.gentype == GENTYPE_GC_B) {
+		index->interval = 0;
+		return HPCS_OK;
+	}
+
+	pret = decoder_init(&decoder, &cursor, &params);
+	while (pret == PARSE_OK && !decoder.finished) {
+		size_t capacity = interval - decoder.samples % interval;
+		size_t decoded;
+
+		if (capacity > NARROW_BLOCK_SIZE)
+			capacity = NARROW_BLOCK_SIZE;
+
+		pret = decoder_decode(&decoder, block, sizeof(double), capacity, &decoded);
+		if (pret == PARSE_OK && decoded == capacity && decoder.samples % interval == 0)
+			checkpoints_add(checkpoints, &cursor, decoder.value, decoder.samples, decoder.segments_read, decoder.next_marker_idx);
+	}
+	if (pret != PARSE_OK || checkpoints->failed)
+		return HPCS_E_PARSE_ERROR;
+
+	/* A checkpoint at the very end of the signal is of no use */
+	if (checkpoints->count > 0 && checkpoints->items[checkpoints->count - 1].sample_idx >= decoder.samples)
+		checkpoints->count--;
+	index->sample_count = decoder.samples;
+
+	return HPCS_OK;
+}
+
+static enum HPCS_DataCheckCode check_for_marker(const char* segment, size_t* const next_marker_idx, const size_t segments_read)
+{
+	if (segment[0] == BIN_MARKER_A) {
+		if (segments_read != *next_marker_idx)
+			return DCHECK_NO_MARKER;
+
+		if (segment[1] == BIN_MARKER_END)
+			return DCHECK_NO_MARKER;
+
+		*next_marker_idx += (uint8_t)segment[1] + 1;
+		return DCHECK_GOT_MARKER;
+	} else
+		return DCHECK_NO_MARKER;
+}
+
+/* Records the state of a decoder whose cursor points at the next segment */
+static void checkpoints_add(struct HPCS_CheckpointList* list, const struct HPCS_Cursor* cursor, const double value, const size_t sample_idx,
+			    const size_t segments_read, const size_t next_marker_idx)
+{
+	struct HPCS_Checkpoint* items;
+	struct HPCS_Checkpoint* cp;
+
+	items = grow_array(list->items, &list->allocated, list->count + 1, sizeof(struct HPCS_Checkpoint));
+	if (items == NULL) {
+		list->failed = true;
+		return;
+	}
+	list->items = items;
+
+	cp = &list->items[list->count++];
+	cp->offset = cursor->offset + cursor->pos;
+	cp->sample_idx = sample_idx;
+	cp->segments_read = segments_read;
+	cp->next_marker_idx = next_marker_idx;
+	cp->value = value;
+}
+
+static void close_data_source(struct HPCS_DataSource* src)
+{
+	switch (src->kind) {
+	case SOURCE_MAPPED:
+#ifdef _WIN32
+		__win32_unmap_measurement_file(src);
+#else
+		__unix_unmap_measurement_file(src);
+#endif
+		break;
+	case SOURCE_STDIO:
+		fclose(src->fh);
+		break;
+	default:
+		break;
+	}
+	mem_free(src->buffer);
+}
+
+static int compare_dir_entries(const void* a, const void* b)
+{
+	return strcmp(((const struct HPCS_DirEntry*)a)->name, ((const struct HPCS_DirEntry*)b)->name);
+}
+
+static void cond_broadcast(HPCS_Cond* cond)
+{
+#ifdef _WIN32
+	WakeAllConditionVariable(cond);
+#else
+	pthread_cond_broadcast(cond);
+#endif
+}
+
+static void cond_destroy(HPCS_Cond* cond)
+{
+#ifdef _WIN32
+	(void)cond;
+#else
+	pthread_cond_destroy(cond);
+#endif
+}
+
+static bool cond_init(HPCS_Cond* cond)
+{
+#ifdef _WIN32
+	InitializeConditionVariable(cond);
+	return true;
+#else
+	return pthread_cond_init(cond, NULL) == 0;
+#endif
+}
+
+static void cond_signal(HPCS_Cond* cond)
+{
+#ifdef _WIN32
+	WakeConditionVariable(cond);
+#else
+	pthread_cond_signal(cond);
+#endif
+}
+
+static void cond_wait(HPCS_Cond* cond, HPCS_Mutex* mutex)
+{
+#ifdef _WIN32
+	SleepConditionVariableCS(cond, mutex, INFINITE);
+#else
+	pthread_cond_wait(cond, mutex);
+#endif
+}
+
+static int cpu_count(void)
+{
+#ifdef _WIN32
+	return __win32_cpu_count();
+#else
+	return __unix_cpu_count();
+#endif
+}
+
+static void cursor_init(struct HPCS_Cursor* cursor, struct HPCS_DataSource* src)
+{
+	cursor->src = src;
+	cursor->offset = 0;
+	cursor->view = NULL;
+	cursor->available = 0;
+	cursor->pos = 0;
+}
+
+static enum HPCS_ParseCode cursor_read(struct HPCS_Cursor* cursor, void* dst, const size_t length)
+{
+	enum HPCS_ParseCode pret = cursor_require(cursor, length);
+	if (pret == PARSE_W_NO_DATA)
+		return PARSE_E_CANT_READ;
+	if (pret != PARSE_OK)
+		return pret;
+
+	memcpy(dst, cursor->view + cursor->pos, length);
+	cursor->pos += length;
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode cursor_read_at(struct HPCS_Cursor* cursor, const HPCS_offset offset, void* dst, const size_t length)
+{
+	enum HPCS_ParseCode pret = cursor_seek(cursor, offset);
+	if (pret != PARSE_OK)
+		return pret;
+
+	return cursor_read(cursor, dst, length);
+}
+
+/* Reads a NUL-terminated string at the position of the cursor without copying it.
+   The string remains valid until the cursor is moved outside of its current view. */
+static enum HPCS_ParseCode cursor_read_cstring(struct HPCS_Cursor* cursor, const char** string, size_t* length)
+{
+	const char* terminator;
+	enum HPCS_ParseCode pret;
+	size_t remaining;
+
+	pret = cursor_require(cursor, SMALL_SEGMENT_SIZE);
+	while (pret == PARSE_OK) {
+		remaining = cursor->available - cursor->pos;
+		terminator = memchr(cursor->view + cursor->pos, '\0', remaining);
+		if (terminator != NULL) {
+			*string = cursor->view + cursor->pos;
+			*length = terminator - *string;
+			cursor->pos += *length + SMALL_SEGMENT_SIZE;
+			return PARSE_OK;
+		}
+
+		/* The view cannot be extended any further */
+		if (cursor->pos == 0 && remaining >= SOURCE_BUFFER_SIZE)
+			return PARSE_E_CANT_READ;
+
+		pret = cursor_require(cursor, remaining + SMALL_SEGMENT_SIZE);
+	}
+
+	return pret == PARSE_W_NO_DATA ? PARSE_E_CANT_READ : pret;
+}
+
+/* Makes sure that at least "length" bytes are available at the position
+   of the cursor. Returns PARSE_W_NO_DATA if the end of the source has been reached. */
+static enum HPCS_ParseCode cursor_require(struct HPCS_Cursor* cursor, const size_t length)
+{
+	struct HPCS_DataSource* src = cursor->src;
+	enum HPCS_ParseCode pret;
+
+	if (cursor->available - cursor->pos >= length)
+		return PARSE_OK;
+
+	/* The view already reaches the end of the source */
+	if (cursor->view != NULL && cursor->offset + cursor->available >= src->size)
+		return PARSE_W_NO_DATA;
+
+	cursor->offset += cursor->pos;
+	cursor->pos = 0;
+	pret = source_view(src, cursor->offset, src->size - cursor->offset, &cursor->view, &cursor->available);
+	if (pret != PARSE_OK) {
+		cursor->view = NULL;
+		cursor->available = 0;
+		return pret;
+	}
+
+	if (cursor->available < length)
+		return PARSE_W_NO_DATA;
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode cursor_seek(struct HPCS_Cursor* cursor, const HPCS_offset offset)
+{
+	if ((size_t)offset > cursor->src->size)
+		return PARSE_E_OUT_OF_RANGE;
+
+	/* Reuse the current view if it contains the requested offset */
+	if (cursor->view != NULL && offset >= cursor->offset && offset <= cursor->offset + (HPCS_offset)cursor->available) {
+		cursor->pos = offset - cursor->offset;
+		return PARSE_OK;
+	}
+
+	cursor->offset = offset;
+	cursor->view = NULL;
+	cursor->available = 0;
+	cursor->pos = 0;
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode decoder_decode(struct HPCS_SignalDecoder* decoder, double* out, const size_t stride, const size_t capacity, size_t* decoded)
+{
+	switch (decoder->params.gentype) {
+	case GENTYPE_ADC_LC:
+	case GENTYPE_ADC_LC2:
+		return decode_signal_30_130(decoder, out, stride, capacity, decoded);
+	case GENTYPE_GC_B:
+		return decode_signal_179(decoder, out, stride, capacity, decoded);
+	default:
+		assert("Invalid gentype");
+		return PARSE_E_INTERNAL;
+	}
+}
+
+static enum HPCS_ParseCode decoder_init(struct HPCS_SignalDecoder* decoder, struct HPCS_Cursor* cursor, const struct HPCS_SignalParams* params)
+{
+	const char* raw;
+	enum HPCS_ParseCode pret;
+	enum HPCS_DataCheckCode dret;
+
+	decoder->cursor = cursor;
+	decoder->params = *params;
+	decoder->value = 0;
+	decoder->counts = 0;
+	decoder->segments_read = 0;
+	decoder->next_marker_idx = 0;
+	decoder->samples = 0;
+	decoder->checkpoints = NULL;
+	decoder->finished = false;
+	decoder->simd = detect_simd_level();
+
+	pret = cursor_seek(cursor, params->scans_start);
+	if (pret != PARSE_OK)
+		return pret;
+
+	switch (params->gentype) {
+	case GENTYPE_ADC_LC:
+	case GENTYPE_ADC_LC2:
+		break;
+	case GENTYPE_GC_B:
+		PR_DEBUG("Reading 179 signal\n");
+		return PARSE_OK;
+	default:
+		assert("Invalid gentype");
+		return PARSE_E_INTERNAL;
+	}
+
+	/* 30/130 signal must begin with a marker */
+	pret = cursor_require(cursor, SEGMENT_SIZE);
+	if (pret != PARSE_OK)
+		return pret == PARSE_W_NO_DATA ? PARSE_E_CANT_READ : pret;
+	raw = cursor->view + cursor->pos;
+	cursor->pos += SEGMENT_SIZE;
+
+	dret = check_for_marker(raw, &decoder->next_marker_idx, decoder->segments_read);
+	switch (dret) {
+	case DCHECK_EOF:
+		PR_DEBUG("File contains no data\n");
+		return PARSE_E_CANT_READ;
+	case DCHECK_NO_MARKER:
+		PR_DEBUG("Leading marker not present\n");
+		return PARSE_E_NOT_FOUND;
+	default:
+		break;
+	}
+	decoder->segments_read++;
+
+	PR_DEBUGF("Reading 30/130 signal, first mid-marker expected at segment %lu\n", decoder->next_marker_idx);
+
+	return PARSE_OK;
+}
+
+/* Only the floating-point value is restored, detector counts cannot be decoded from a checkpoint */
+static enum HPCS_ParseCode decoder_resume(struct HPCS_SignalDecoder* decoder, const struct HPCS_Checkpoint* checkpoint)
+{
+	enum HPCS_ParseCode pret;
+
+	pret = cursor_seek(decoder->cursor, checkpoint->offset);
+	if (pret != PARSE_OK)
+		return pret;
+
+	decoder->value = checkpoint->value;
+	decoder->segments_read = checkpoint->segments_read;
+	decoder->next_marker_idx = checkpoint->next_marker_idx;
+	decoder->samples = checkpoint->sample_idx;
+	decoder->finished = false;
+
+	return PARSE_OK;
+}
+
+/* Positions the decoder so that the next decoded sample is the one at sample_idx. 179 signal is
+   seeked to directly. 30/130 signal resumes from the last checkpoint before the sample, if there
+   is one ahead of the decoder, and the samples in between are decoded and dropped. */
+static enum HPCS_ParseCode decoder_seek(struct HPCS_SignalDecoder* decoder, const size_t sample_idx, const struct HPCS_CheckpointList* checkpoints)
+{
+	double block[NARROW_BLOCK_SIZE];
+	enum HPCS_ParseCode pret;
+
+	if (decoder->params.gentype == GENTYPE_GC_B) {
+		pret = cursor_seek(decoder->cursor, decoder->params.scans_start + sample_idx * DOUBLE_SEGMENT_SIZE);
+		if (pret != PARSE_OK)
+			return pret;
+		decoder->samples = sample_idx;
+		return PARSE_OK;
+	}
+
+	if (checkpoints != NULL && checkpoints->count > 0) {
+		size_t lo = 0;
+		size_t hi = checkpoints->count;
+
+		/* Find the first checkpoint past the sample, the one before it is the closest */
+		while (lo < hi) {
+			const size_t mid = lo + (hi - lo) / 2;
+			if (checkpoints->items[mid].sample_idx <= sample_idx)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo > 0 && checkpoints->items[lo - 1].sample_idx > decoder->samples) {
+			pret = decoder_resume(decoder, &checkpoints->items[lo - 1]);
+			if (pret != PARSE_OK)
+				return pret;
+		}
+	}
+
+	while (decoder->samples < sample_idx && !decoder->finished) {
+		size_t capacity = sample_idx - decoder->samples;
+		size_t decoded;
+
+		if (capacity > NARROW_BLOCK_SIZE)
+			capacity = NARROW_BLOCK_SIZE;
+
+		pret = decoder_decode(decoder, block, sizeof(double), capacity, &decoded);
+		if (pret != PARSE_OK)
+			return pret;
+	}
+
+	return PARSE_OK;
+}
+
+/* Decodes a run of deltas and returns the last value. The values are summed up one by one
+   exactly like the scalar decoder does to produce bit-identical output, only the conversion
+   of the deltas is vectorized. */
+static double decode_deltas(const char* raw, size_t count, const double step, const double shift, double value, double* out, const size_t stride,
+			    const enum HPCS_SimdLevel simd)
+{
+	double increments[DELTA_BLOCK_SIZE];
+	char* dst = (char*)out;
+
+	while (count > 0) {
+		const size_t block = count < DELTA_BLOCK_SIZE ? count : DELTA_BLOCK_SIZE;
+		size_t idx;
+
+		delta_increments(raw, block, step, shift, increments, simd);
+		for (idx = 0; idx < block; idx++) {
+			value += increments[idx];
+			*(double*)dst = value;
+			dst += stride;
+		}
+
+		raw += block * SEGMENT_SIZE;
+		count -= block;
+	}
+
+	return value;
+}
+
+static enum HPCS_ParseCode decode_signal_30_130(struct HPCS_SignalDecoder* decoder, double* out, const size_t stride, const size_t capacity, size_t* decoded)
+{
+	struct HPCS_Cursor* cursor = decoder->cursor;
+	const double signal_step = decoder->params.step;
+	const double signal_shift = decoder->params.shift;
+	double value = decoder->value;
+	size_t segments_read = decoder->segments_read;
+	size_t next_marker_idx = decoder->next_marker_idx;
+	size_t data_segments_read = 0;
+	char* dst = (char*)out;
+	const char* raw;
+	enum HPCS_ParseCode pret = PARSE_OK;
+
+	while (data_segments_read < capacity) {
+		enum HPCS_SegmentKind kind;
+		int32_t number;
+		size_t run;
+
+		pret = cursor_require(cursor, SEGMENT_SIZE);
+		if (pret == PARSE_W_NO_DATA) {
+			decoder->finished = true;
+			pret = PARSE_OK;
+			break;
+		}
+		if (pret != PARSE_OK) {
+			PR_DEBUG("Error reading stream\n");
+			break;
+		}
+		raw = cursor->view + cursor->pos;
+
+		/* Deltas between the markers and the jumps are decoded in bulk */
+		run = (cursor->available - cursor->pos) / SEGMENT_SIZE;
+		if (run > capacity - data_segments_read)
+			run = capacity - data_segments_read;
+		if (next_marker_idx >= segments_read && run > next_marker_idx - segments_read)
+			run = next_marker_idx - segments_read;
+		run = delta_run_length(raw, run, decoder->simd);
+		if (run > 0) {
+			/* Without an output buffer only the number of samples is counted */
+			if (dst != NULL) {
+				value = decode_deltas(raw, run, signal_step, signal_shift, value, (double*)dst, stride, decoder->simd);
+				dst += run * stride;
+			}
+			cursor->pos += run * SEGMENT_SIZE;
+			segments_read += run;
+			data_segments_read += run;
+			continue;
+		}
+
+		pret = decode_segment_30_130(cursor, &next_marker_idx, segments_read, &kind, &number);
+		if (pret != PARSE_OK)
+			goto out;
+
+		if (kind != SEGMENT_MARKER) {
+			if (kind == SEGMENT_JUMP) {
+				value = number * signal_step + signal_shift;
+				if (decoder->checkpoints != NULL)
+					checkpoints_add(decoder->checkpoints, cursor, value, decoder->samples + data_segments_read + 1, segments_read + 1,
+							next_marker_idx);
+			} else
+				value += number * signal_step + signal_shift;
+
+			/* Without an output buffer only the number of samples is counted */
+			if (dst != NULL) {
+				*(double*)dst = value;
+				dst += stride;
+			}
+			data_segments_read++;
+		}
+		segments_read++;
+	}
+
+out:
+	decoder->value = value;
+	decoder->samples += data_segments_read;
+	decoder->segments_read = segments_read;
+	decoder->next_marker_idx = next_marker_idx;
+	*decoded = data_segments_read;
+	return pret;
+}
+
+/* Same as decode_signal_30_130() but reconstructs the integer detector counts. Counts wrap around
+   on overflow exactly like the 32-bit registers of the detector. */
+static enum HPCS_ParseCode decode_counts_30_130(struct HPCS_SignalDecoder* decoder, int32_t* out, const size_t capacity, size_t* decoded)
+{
+	struct HPCS_Cursor* cursor = decoder->cursor;
+	uint32_t counts = decoder->counts;
+	size_t segments_read = decoder->segments_read;
+	size_t next_marker_idx = decoder->next_marker_idx;
+	size_t data_segments_read = 0;
+	const char* raw;
+	enum HPCS_ParseCode pret = PARSE_OK;
+
+	while (data_segments_read < capacity) {
+		enum HPCS_SegmentKind kind;
+		int32_t number;
+		size_t run;
+		size_t idx;
+
+		pret = cursor_require(cursor, SEGMENT_SIZE);
+		if (pret == PARSE_W_NO_DATA) {
+			decoder->finished = true;
+			pret = PARSE_OK;
+			break;
+		}
+		if (pret != PARSE_OK) {
+			PR_DEBUG("Error reading stream\n");
+			break;
+		}
+		raw = cursor->view + cursor->pos;
+
+		run = (cursor->available - cursor->pos) / SEGMENT_SIZE;
+		if (run > capacity - data_segments_read)
+			run = capacity - data_segments_read;
+		if (next_marker_idx >= segments_read && run > next_marker_idx - segments_read)
+			run = next_marker_idx - segments_read;
+		run = delta_run_length(raw, run, decoder->simd);
+		if (run > 0) {
+			const unsigned char* segment = (const unsigned char*)raw;
+
+			for (idx = 0; idx < run; idx++) {
+				counts += (uint32_t)(int16_t)((segment[0] << 8) | segment[1]);
+				out[data_segments_read + idx] = (int32_t)counts;
+				segment += SEGMENT_SIZE;
+			}
+			cursor->pos += run * SEGMENT_SIZE;
+			segments_read += run;
+			data_segments_read += run;
+			continue;
+		}
+
+		pret = decode_segment_30_130(cursor, &next_marker_idx, segments_read, &kind, &number);
+		if (pret != PARSE_OK)
+			goto out;
+
+		if (kind != SEGMENT_MARKER) {
+			if (kind == SEGMENT_JUMP)
+				counts = (uint32_t)number;
+			else
+				counts += (uint32_t)number;
+			out[data_segments_read++] = (int32_t)counts;
+		}
+		segments_read++;
+	}
+
+out:
+	decoder->counts = counts;
+	decoder->samples += data_segments_read;
+	decoder->segments_read = segments_read;
+	decoder->next_marker_idx = next_marker_idx;
+	*decoded = data_segments_read;
+	return pret;
+}
+
+/* Reads the segment at the cursor that is not a plain delta in the middle of a run, i.e. a marker,
+   a jump to an absolute value or a delta that directly follows one of them */
+static enum HPCS_ParseCode decode_segment_30_130(struct HPCS_Cursor* cursor, size_t* next_marker_idx, const size_t segments_read,
+						 enum HPCS_SegmentKind* kind, int32_t* number)
+{
+	const char* raw = cursor->view + cursor->pos;
+	enum HPCS_ParseCode pret;
+	enum HPCS_DataCheckCode dret;
+
+	cursor->pos += SEGMENT_SIZE;
+
+	/* Check for markers */
+	dret = check_for_marker(raw, next_marker_idx, segments_read);
+	switch (dret) {
+	case DCHECK_GOT_MARKER:
+#ifndef NDEBUG
+	{
+		const size_t pos = cursor->offset + cursor->pos - SEGMENT_SIZE;
+		fprintf(stderr, "Got marker at segment %lu, byte 0x%lx, next marker expected at %lu\n", segments_read, pos, *next_marker_idx);
+	}
+#endif
+		*kind = SEGMENT_MARKER;
+		return PARSE_OK;
+	case DCHECK_NO_MARKER:
+#ifndef NDEBUG
+		if (segments_read == *next_marker_idx)
+			fprintf(stderr, "Warning - marker expected but not found at segment %lu\n", segments_read);
+#endif
+		/* Check for a sudden jump of value */
+		if (raw[0] == BIN_MARKER_JUMP && raw[1] == BIN_MARKER_END) {
+			char lraw[4];
+#ifndef NDEBUG
+			const size_t pos = cursor->offset + cursor->pos - SEGMENT_SIZE;
+			fprintf(stderr, "Value has jumped at %lu, byte 0x%lx\n", segments_read, pos);
+#endif
+			pret = cursor_require(cursor, LARGE_SEGMENT_SIZE);
+			if (pret != PARSE_OK)
+				return PARSE_E_CANT_READ;
+			memcpy(lraw, cursor->view + cursor->pos, LARGE_SEGMENT_SIZE);
+			cursor->pos += LARGE_SEGMENT_SIZE;
+
+			be_to_cpu(lraw);
+			*number = *(int32_t*)lraw;
+			*kind = SEGMENT_JUMP;
+		} else {
+			char sraw[2];
+
+			memcpy(sraw, raw, SEGMENT_SIZE);
+			be_to_cpu(sraw);
+			*number = *(int16_t*)sraw;
+			*kind = SEGMENT_DELTA;
+		}
+		return PARSE_OK;
+	default:
+		PR_DEBUG("Invalid value from check_for_marker()\n");
+		return PARSE_E_CANT_READ;
+	}
+}
+
+static enum HPCS_ParseCode decode_signal_179(struct HPCS_SignalDecoder* decoder, double* out, const size_t stride, const size_t capacity, size_t* decoded)
+{
+	struct HPCS_Cursor* cursor = decoder->cursor;
+	const double signal_step = decoder->params.step;
+	const double signal_shift = decoder->params.shift;
+	size_t segments_read = 0;
+	char* dst = (char*)out;
+	enum HPCS_ParseCode pret = PARSE_OK;
+
+	while (segments_read < capacity) {
+		size_t run;
+
+		pret = cursor_require(cursor, DOUBLE_SEGMENT_SIZE);
+		if (pret == PARSE_W_NO_DATA) {
+			decoder->finished = true;
+			pret = PARSE_OK;
+			break;
+		}
+		if (pret != PARSE_OK) {
+			PR_DEBUG("Error reading stream\n");
+			break;
+		}
+
+		/* Everything the cursor has in view is scaled in one go */
+		run = (cursor->available - cursor->pos) / DOUBLE_SEGMENT_SIZE;
+		if (run > capacity - segments_read)
+			run = capacity - segments_read;
+
+		/* Without an output buffer only the number of samples is counted */
+		if (dst != NULL) {
+			scale_doubles(cursor->view + cursor->pos, run, signal_step, signal_shift, dst, stride, decoder->simd);
+			dst += run * stride;
+		}
+		cursor->pos += run * DOUBLE_SEGMENT_SIZE;
+		segments_read += run;
+	}
+
+	decoder->samples += segments_read;
+	*decoded = segments_read;
+	return pret;
+}
+
+/* Converts big-endian 16-bit deltas to the increments of the signal value */
+static void delta_increments(const char* raw, const size_t count, const double step, const double shift, double* increments,
+			     const enum HPCS_SimdLevel simd)
+{
+	size_t idx = 0;
+
+#ifdef HPCS_SIMD_X86
+	if (simd == SIMD_AVX2)
+		idx = __avx2_delta_increments(raw, count, step, shift, increments);
+	else if (simd == SIMD_SSE2)
+		idx = __sse2_delta_increments(raw, count, step, shift, increments);
+#else
+	(void)simd;
+#endif
+
+	for (; idx < count; idx++) {
+		char sraw[2];
+		int16_t _v;
+
+		memcpy(sraw, raw + idx * SEGMENT_SIZE, SEGMENT_SIZE);
+		be_to_cpu(sraw);
+		_v = *(int16_t*)sraw;
+		increments[idx] = _v * step + shift;
+	}
+}
+
+/* Returns the number of leading segments that are plain deltas, i.e. not value jumps */
+static size_t delta_run_length(const char* raw, const size_t count, const enum HPCS_SimdLevel simd)
+{
+	size_t idx = 0;
+
+#ifdef HPCS_SIMD_X86
+	if (simd == SIMD_AVX2)
+		idx = __avx2_delta_run_length(raw, count);
+	else if (simd == SIMD_SSE2)
+		idx = __sse2_delta_run_length(raw, count);
+#else
+	(void)simd;
+#endif
+
+	for (; idx < count; idx++) {
+		const char* segment = raw + idx * SEGMENT_SIZE;
+		if (segment[0] == BIN_MARKER_JUMP && segment[1] == BIN_MARKER_END)
+			break;
+	}
+
+	return idx;
+}
+
+/* Converts little-endian doubles to signal values */
+static void scale_doubles(const char* raw, const size_t count, const double step, const double shift, char* dst, const size_t stride,
+			  const enum HPCS_SimdLevel simd)
+{
+	size_t idx = 0;
+
+#ifdef HPCS_SIMD_X86
+	if (simd == SIMD_AVX2)
+		idx = __avx2_scale_doubles(raw, count, step, shift, dst, stride);
+	else if (simd == SIMD_SSE2)
+		idx = __sse2_scale_doubles(raw, count, step, shift, dst, stride);
+#else
+	(void)simd;
+#endif
+
+	dst += idx * stride;
+	for (; idx < count; idx++) {
+		char draw[8];
+		double value;
+
+		memcpy(draw, raw + idx * DOUBLE_SEGMENT_SIZE, DOUBLE_SEGMENT_SIZE);
+		le_to_cpu(draw);
+		value = *(double*)(&draw);
+		*(double*)dst = value * step + shift;
+		dst += stride;
+	}
+}
+
+/* Gives back the unused end of an array. A small surplus is kept because shrinking may cause
+   the allocator to return memory that the next read has to fault in again. */
+static void* shrink_array(void* array, const size_t allocated, const size_t count, const size_t elem_size)
+{
+	void* nptr;
+
+	if (count == 0 || allocated - count <= allocated / SIGNAL_SHRINK_RATIO)
+		return array;
+
+	nptr = mem_realloc(array, count * elem_size);
+	return nptr != NULL ? nptr : array;
+}
+
+static enum HPCS_ChemStationVer detect_chemstation_version(const char*const version_string)
+{
+	PR_DEBUGF("ChemStation version string: %s\n", version_string);
+
+	if (!strcmp(version_string, CHEMSTAT_B0625_STR)) {
+		PR_DEBUG("ChemStation B.06.25\n");
+		return CHEMSTAT_B0625;
+	}
+	else if (!strcmp(version_string, CHEMSTAT_B0626_STR)) {
+		PR_DEBUG("ChemStation B.06.26\n");
+		return CHEMSTAT_B0626;
+	}
+	else if (!strcmp(version_string, CHEMSTAT_B0643_STR)) {
+		PR_DEBUG("ChemStation B.06.43\n");
+		return CHEMSTAT_B0643;
+	}
+	else if (!strcmp(version_string, CHEMSTAT_B0644_STR)) {
+		PR_DEBUG("ChemStation B.06.44\n");
+		return CHEMSTAT_B0644;
+	}
+	else if (strlen(version_string) == 0) {
+		PR_DEBUG("ChemStation Untagged\n");
+		return CHEMSTAT_UNTAGGED;
+	}
+
+	PR_DEBUG("Unknown ChemStation version\n");
+	return CHEMSTAT_UNKNOWN;
+}
+
+static enum HPCS_SimdLevel detect_simd_level(void)
+{
+#if defined(HPCS_SIMD_X86) && defined(_MSC_VER)
+	int info[4];
+
+	/* AVX2 also requires the OS to preserve the YMM registers */
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6) {
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5))
+			return SIMD_AVX2;
+	}
+	return SIMD_SSE2;
+#elif defined(HPCS_SIMD_X86)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? SIMD_AVX2 : SIMD_SSE2;
+#else
+	return SIMD_NONE;
+#endif
+}
+
+static void dir_close(struct HPCS_RunDir* dir)
+{
+#ifndef _WIN32
+	close(dir->fd);
+#endif
+	mem_free(dir->path);
+}
+
+/* Appends an entry to a directory listing, the listing takes over the name */
+static enum HPCS_ParseCode dir_entries_add(struct HPCS_DirEntry** entries, size_t* count, size_t* allocated, char* name, const enum HPCS_DirEntryKind kind)
+{
+	struct HPCS_DirEntry* nptr;
+
+	if (name == NULL)
+		return PARSE_E_NO_MEM;
+
+	nptr = grow_array(*entries, allocated, *count + 1, sizeof(struct HPCS_DirEntry));
+	if (nptr == NULL) {
+		mem_free(name);
+		return PARSE_E_NO_MEM;
+	}
+	*entries = nptr;
+
+	nptr[*count].name = name;
+	nptr[*count].kind = kind;
+	(*count)++;
+
+	return PARSE_OK;
+}
+
+static void dir_entries_free(struct HPCS_DirEntry* entries, const size_t count)
+{
+	size_t idx;
+
+	for (idx = 0; idx < count; idx++)
+		mem_free(entries[idx].name);
+	mem_free(entries);
+}
+
+/* Lists a directory without the "." and ".." entries. Entries are sorted by name. */
+static enum HPCS_ParseCode dir_list(const struct HPCS_RunDir* dir, struct HPCS_DirEntry** entries, size_t* count)
+{
+	enum HPCS_ParseCode pret;
+
+	*entries = NULL;
+	*count = 0;
+
+#ifdef _WIN32
+	pret = __win32_dir_list(dir->path, entries, count);
+#else
+	pret = __unix_dir_list(dir->fd, entries, count);
+#endif
+	if (pret != PARSE_OK) {
+		dir_entries_free(*entries, *count);
+		*entries = NULL;
+		*count = 0;
+		return pret;
+	}
+
+	if (*count > 1)
+		qsort(*entries, *count, sizeof(struct HPCS_DirEntry), compare_dir_entries);
+
+	return PARSE_OK;
+}
+
+/* Opens a directory. If parent is given, name is relative to it and a symbolic link is not followed. */
+static bool dir_open(const struct HPCS_RunDir* parent, const char* name, struct HPCS_RunDir* dir)
+{
+	dir->path = parent == NULL ? duplicate_string(name) : join_path(parent->path, name);
+	if (dir->path == NULL)
+		return false;
+
+#ifdef _WIN32
+	if (!__win32_dir_open(dir->path)) {
+#else
+	dir->fd = parent == NULL ? __unix_dir_open(AT_FDCWD, name, false) : __unix_dir_open(parent->fd, name, true);
+	if (dir->fd < 0) {
+#endif
+		mem_free(dir->path);
+		return false;
+	}
+
+	return true;
+}
+
+static char* duplicate_string(const char* s)
+{
+	char* ns = mem_alloc(strlen(s) + 1);
+	if (ns == NULL)
+		return NULL;
+
+	strcpy(ns, s);
+	return ns;
+}
+
+static enum HPCS_ParseCode expand_storage(struct HPCS_TVPair** pairs, size_t* const alloc_size)
+{
+	struct HPCS_TVPair* nptr;
+	*alloc_size *= 2;
+	nptr = mem_realloc(*pairs, sizeof(struct HPCS_TVPair) * (*alloc_size));
+
+	if (nptr == NULL) {
+		mem_free(*pairs);
+		*pairs = NULL;
+		return PARSE_E_NO_MEM;
+	}
+
+	*pairs = nptr;
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode fetch_signal_step(struct HPCS_Cursor* cursor, double *step, double *shift, bool old_format)
+{
+	int32_t version;
+	double _step;
+	double _shift;
+	enum HPCS_ParseCode pret;
+	HPCS_offset veroff;
+	HPCS_offset shiftoff;
+	HPCS_offset stepoff;
+
+	if (old_format) {
+		veroff = DATA_OFFSET_SIGSTEP_VERSION_OLD;
+		shiftoff = DATA_OFFSET_SIGSTEP_SHIFT_OLD;
+		stepoff = DATA_OFFSET_SIGSTEP_STEP_OLD;
+	} else {
+		veroff = DATA_OFFSET_SIGSTEP_VERSION;
+		shiftoff = DATA_OFFSET_SIGSTEP_SHIFT;
+		stepoff = DATA_OFFSET_SIGSTEP_STEP;
+	}
+
+	pret = cursor_read_at(cursor, veroff, &version, LARGE_SEGMENT_SIZE);
+	if (pret != PARSE_OK)
+		return pret;
+
+	be_to_cpu_val(version);
+	switch (version) {
+	case 1:
+		*step = SIGSTEP_V1;
+		*shift = 0.0;
+		return PARSE_OK;
+	case 2:
+		*step = SIGSTEP_V2;
+		*shift = 0.0;
+		return PARSE_OK;
+	default:
+		break;
+	}
+
+	pret = cursor_read_at(cursor, shiftoff, &_shift, DOUBLE_SEGMENT_SIZE);
+	if (pret != PARSE_OK)
+		return pret;
+
+	pret = cursor_read_at(cursor, stepoff, &_step, DOUBLE_SEGMENT_SIZE);
+	if (pret != PARSE_OK)
+		return pret;
+
+	be_to_cpu_val(_shift);
+	be_to_cpu_val(_step);
+	*shift = _shift;
+	*step = _step;
+
+	return PARSE_OK;
+}
+
+/* Gets the size and the modification time of a file at full resolution without opening it */
+static bool file_stamp(const char* filename, uint64_t* size, int64_t* mtime, uint32_t* mtime_nsec)
+{
+#ifdef _WIN32
+	return __win32_file_stamp(filename, size, mtime, mtime_nsec);
+#else
+	return __unix_file_stamp(filename, size, mtime, mtime_nsec);
+#endif
+}
+
+static bool file_type_description_is_readable(const char*const description)
+{
+	if (!strcmp(FILE_DESC_LC_DATA_FILE, description))
+		return true;
+	else if (!strcmp(FILE_DESC_GC_DATA_FILE, description))
+		return true;
+	else
+		return false;
+}
+
+static bool gentype_is_readable(const enum HPCS_GenType gentype)
+{
+	switch (gentype) {
+	case GENTYPE_ADC_LC:
+	case GENTYPE_ADC_LC2:
+	case GENTYPE_GC_B:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Makes room for at least count elements, returns NULL and leaves the array intact if it cannot be enlarged */
+static void* grow_array(void* array, size_t* allocated, const size_t count, const size_t elem_size)
+{
+	size_t to_allocate;
+	void* nptr;
+
+	if (count <= *allocated)
+		return array;
+
+	to_allocate = *allocated == 0 ? 16 : *allocated * 2;
+	if (to_allocate < count)
+		to_allocate = count;
+
+	nptr = mem_realloc(array, to_allocate * elem_size);
+	if (nptr == NULL)
+		return NULL;
+
+	*allocated = to_allocate;
+	return nptr;
+}
+
+/* Case-insensitive check of the extension of a file name */
+static bool has_extension(const char* name, const char* ext)
+{
+	const size_t name_length = strlen(name);
+	const size_t ext_length = strlen(ext);
+	size_t idx;
+
+	if (name_length <= ext_length)
+		return false;
+
+	name += name_length - ext_length;
+	for (idx = 0; idx < ext_length; idx++) {
+		if (tolower((unsigned char)name[idx]) != tolower((unsigned char)ext[idx]))
+			return false;
+	}
+
+	return true;
+}
+
+static uint64_t index_get_u64(const char* bytes)
+{
+	uint64_t value;
+
+	memcpy(&value, bytes, sizeof(value));
+	le_to_cpu_val(value);
+	return value;
+}
+
+static void index_put_u64(char* bytes, uint64_t value)
+{
+	le_to_cpu_val(value);
+	memcpy(bytes, &value, sizeof(value));
+}
+
+static int LIBHPCS_CC io_fd_read(void* handle, void* dst, const size_t length, size_t* bytes_read)
+{
+#ifdef _WIN32
+	return __win32_io_fd_read((int)(intptr_t)handle, dst, length, bytes_read);
+#else
+	return __unix_io_fd_read((int)(intptr_t)handle, dst, length, bytes_read);
+#endif
+}
+
+static int LIBHPCS_CC io_fd_seek(void* handle, const uint64_t offset)
+{
+#ifdef _WIN32
+	return _lseeki64((int)(intptr_t)handle, (__int64)offset, SEEK_SET) < 0 ? -1 : 0;
+#else
+	if ((uint64_t)(off_t)offset != offset)
+		return -1;
+	return lseek((int)(intptr_t)handle, (off_t)offset, SEEK_SET) < 0 ? -1 : 0;
+#endif
+}
+
+static int LIBHPCS_CC io_fd_size(void* handle, uint64_t* size)
+{
+#ifdef _WIN32
+	const __int64 length = _filelengthi64((int)(intptr_t)handle);
+	if (length < 0)
+		return -1;
+	*size = (uint64_t)length;
+#else
+	struct stat st;
+
+	if (fstat((int)(intptr_t)handle, &st) != 0 || st.st_size < 0)
+		return -1;
+	*size = (uint64_t)st.st_size;
+#endif
+	return 0;
+}
+
+static int LIBHPCS_CC io_file_read(void* handle, void* dst, const size_t length, size_t* bytes_read)
+{
+	FILE* fh = handle;
+
+	*bytes_read = fread(dst, SMALL_SEGMENT_SIZE, length, fh);
+	return ferror(fh) ? -1 : 0;
+}
+
+static int LIBHPCS_CC io_file_seek(void* handle, const uint64_t offset)
+{
+	if (offset > LONG_MAX)
+		return -1;
+	return fseek(handle, (long)offset, SEEK_SET);
+}
+
+static int LIBHPCS_CC io_file_size(void* handle, uint64_t* size)
+{
+	long length;
+
+	if (fseek(handle, 0, SEEK_END) != 0)
+		return -1;
+	length = ftell(handle);
+	if (length < 0)
+		return -1;
+
+	*size = (uint64_t)length;
+	return 0;
+}
+
+static int LIBHPCS_CC io_memory_read(void* handle, void* dst, const size_t length, size_t* bytes_read)
+{
+	struct HPCS_IOMemory* memory = handle;
+	size_t to_read = 0;
+
+	if (memory->position < memory->length)
+		to_read = memory->length - memory->position;
+	if (to_read > length)
+		to_read = length;
+
+	memcpy(dst, memory->bytes + memory->position, to_read);
+	memory->position += to_read;
+
+	*bytes_read = to_read;
+	return 0;
+}
+
+static int LIBHPCS_CC io_memory_seek(void* handle, const uint64_t offset)
+{
+	struct HPCS_IOMemory* memory = handle;
+
+	if (offset > memory->length)
+		return -1;
+
+	memory->position = (size_t)offset;
+	return 0;
+}
+
+static int LIBHPCS_CC io_memory_size(void* handle, uint64_t* size)
+{
+	struct HPCS_IOMemory* memory = handle;
+
+	*size = memory->length;
+	return 0;
+}
+
+/* Reads a block from a user-supplied source. The read callback may return
+   less data than requested so it is called until the block is complete
+   or the end of the source is reached. */
+static enum HPCS_ParseCode io_read_at(const struct HPCS_IOSource* io, const HPCS_offset offset, char* dst, const size_t length, size_t* bytes_read)
+{
+	size_t total = 0;
+
+	if (io->seek(io->handle, (uint64_t)offset) != 0)
+		return PARSE_E_CANT_READ;
+
+	while (total < length) {
+		size_t got;
+
+		if (io->read(io->handle, dst + total, length - total, &got) != 0)
+			return PARSE_E_CANT_READ;
+		if (got == 0)
+			break;
+		total += got;
+	}
+
+	*bytes_read = total;
+	return PARSE_OK;
+}
+
+static char* join_path(const char* dir, const char* name)
+{
+	size_t dir_length = strlen(dir);
+	char* path = mem_alloc(dir_length + strlen(name) + 2);
+	if (path == NULL)
+		return NULL;
+
+	strcpy(path, dir);
+	if (dir_length > 0 && dir[dir_length - 1] != PATH_SEPARATOR && dir[dir_length - 1] != '/')
+		path[dir_length++] = PATH_SEPARATOR;
+	strcpy(path + dir_length, name);
+
+	return path;
+}
+
+/* Converts an ISO-8859-1 string to UTF-8 with a single allocation. Every byte is a code point of its own. */
+static enum HPCS_ParseCode latin1_to_utf8(char** target, const char* s, const size_t length, struct HPCS_Arena** arena)
+{
+	const unsigned char* bytes = (const unsigned char*)s;
+	size_t utf8_size = 0;
+	size_t idx;
+	char* dst;
+
+	for (idx = 0; idx < length && bytes[idx] != 0; idx++)
+		utf8_size += utf8_put(NULL, bytes[idx]);
+
+	*target = arena_alloc(arena, utf8_size + 1);
+	if (*target == NULL)
+		return PARSE_E_NO_MEM;
+
+	dst = *target;
+	for (idx = 0; idx < length && bytes[idx] != 0; idx++)
+		dst += utf8_put(dst, bytes[idx]);
+	*dst = '\0';
+
+	return PARSE_OK;
+}
+
+/* Loads the index of a data file. An index that is missing, damaged or out of date is not loaded.
+   The checkpoints must be freed even if the index is not loaded. */
+static bool load_signal_index(const char* filename, struct HPCS_SignalIndex* index)
+{
+	char header[INDEX_HEADER_SIZE];
+	char* records = NULL;
+	struct HPCS_Checkpoint* items = NULL;
+	uint64_t file_size;
+	int64_t mtime;
+	uint32_t mtime_nsec;
+	uint64_t sample_count;
+	uint64_t interval;
+	uint64_t count;
+	uint64_t prev_offset = 0;
+	uint64_t prev_sample = 0;
+	size_t idx;
+	FILE* fh;
+
+	index->checkpoints.items = NULL;
+	index->checkpoints.count = 0;
+	index->checkpoints.allocated = 0;
+	index->checkpoints.failed = false;
+
+	if (!file_stamp(filename, &file_size, &mtime, &mtime_nsec))
+		return false;
+
+	fh = open_index_file(filename, false);
+	if (fh == NULL)
+		return false;
+
+	if (fread(header, INDEX_HEADER_SIZE, 1, fh) != 1 || memcmp(header, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0)
+		goto fail;
+
+	index->file_size = index_get_u64(header + 8);
+	index->mtime = (int64_t)index_get_u64(header + 16);
+	index->mtime_nsec = (uint32_t)index_get_u64(header + 24);
+	sample_count = index_get_u64(header + 32);
+	interval = index_get_u64(header + 40);
+	count = index_get_u64(header + 48);
+	if (index->file_size != file_size || index->mtime != mtime || index->mtime_nsec != mtime_nsec) {
+		PR_DEBUG("Index is out of date\n");
+		goto fail;
+	}
+	if (sample_count > (size_t)-1 || interval == 0 || interval > (size_t)-1 || count > sample_count ||
+	    count > ((size_t)-1) / INDEX_RECORD_SIZE || count > ((size_t)-1) / sizeof(struct HPCS_Checkpoint))
+		goto fail;
+
+	records = mem_alloc((size_t)count * INDEX_RECORD_SIZE + 1);
+	items = mem_alloc((size_t)count * sizeof(struct HPCS_Checkpoint) + 1);
+	if (records == NULL || items == NULL)
+		goto fail;
+
+	/* The index must end right after the last checkpoint */
+	if (fread(records, INDEX_RECORD_SIZE, (size_t)count, fh) != (size_t)count || fgetc(fh) != EOF)
+		goto fail;
+
+	for (idx = 0; idx < (size_t)count; idx++) {
+		const char* record = records + idx * INDEX_RECORD_SIZE;
+		const uint64_t offset = index_get_u64(record);
+		const uint64_t sample_idx = index_get_u64(record + 8);
+		const uint64_t segments_read = index_get_u64(record + 16);
+		const uint64_t next_marker_idx = index_get_u64(record + 24);
+		const uint64_t value = index_get_u64(record + 32);
+
+		/* Checkpoints must be ordered and lie within the data file */
+		if (offset <= prev_offset || offset > file_size || sample_idx <= prev_sample || sample_idx > sample_count ||
+		    segments_read > (size_t)-1 || next_marker_idx > (size_t)-1)
+			goto fail;
+		prev_offset = offset;
+		prev_sample = sample_idx;
+
+		items[idx].offset = (HPCS_offset)offset;
+		items[idx].sample_idx = (size_t)sample_idx;
+		items[idx].segments_read = (size_t)segments_read;
+		items[idx].next_marker_idx = (size_t)next_marker_idx;
+		memcpy(&items[idx].value, &value, sizeof(double));
+	}
+
+	fclose(fh);
+	mem_free(records);
+
+	index->sample_count = (size_t)sample_count;
+	index->interval = (size_t)interval;
+	index->checkpoints.items = items;
+	index->checkpoints.count = (size_t)count;
+	index->checkpoints.allocated = (size_t)count;
+	return true;
+
+fail:
+	fclose(fh);
+	mem_free(records);
+	mem_free(items);
+	return false;
+}
+
+/* Collects samples, a sample is picked from the current bucket each time the next bucket is complete */
+static bool lttb_collect(struct HPCS_Lttb* lttb, const double* values, size_t count)
+{
+	while (count > 0) {
+		size_t take;
+
+		/* The first sample is always kept */
+		if (lttb->samples == 0) {
+			if (!lttb_keep(lttb, 0, values[0]))
+				return false;
+			values++;
+			count--;
+			lttb->samples++;
+			continue;
+		}
+
+		if (lttb->samples == lttb->next_stop) {
+			if (lttb->current_count > 0 && !lttb_pick(lttb, lttb->next_start + (lttb->next_count - 1) / 2.0,
+								  lttb_mean(lttb->next, lttb->next_count)))
+				return false;
+			lttb_rotate(lttb);
+			lttb->next_stop = 1 + bucket_end(lttb->bucket_samples, lttb->buckets, ++lttb->bucket);
+		}
+
+		take = lttb->next_stop - lttb->samples;
+		if (take > count)
+			take = count;
+		if (lttb->next_count == 0)
+			lttb->next_start = lttb->samples;
+
+		memcpy(lttb->next + lttb->next_count, values, take * sizeof(double));
+		lttb->next_count += take;
+		lttb->samples += take;
+		values += take;
+		count -= take;
+	}
+
+	return true;
+}
+
+/* Picks samples from the buckets that are left and keeps the last sample */
+static bool lttb_finish(struct HPCS_Lttb* lttb)
+{
+	double last;
+
+	if (lttb->samples < 2)
+		return true;
+
+	/* Every sample but the first one goes to the next bucket */
+	last = lttb->next[--lttb->next_count];
+
+	if (lttb->next_count > 0) {
+		if (lttb->current_count > 0 && !lttb_pick(lttb, lttb->next_start + (lttb->next_count - 1) / 2.0,
+							  lttb_mean(lttb->next, lttb->next_count)))
+			return false;
+		lttb_rotate(lttb);
+	}
+	if (lttb->current_count > 0 && !lttb_pick(lttb, (double)(lttb->samples - 1), last))
+		return false;
+
+	return lttb_keep(lttb, lttb->samples - 1, last);
+}
+
+static bool lttb_keep(struct HPCS_Lttb* lttb, const size_t sample_idx, const double value)
+{
+	struct HPCS_SampledSignal* sampled = lttb->sampled;
+
+	if (!append_pair(&sampled->times, &sampled->values, &lttb->allocated, sampled->count, (double)sample_idx, value))
+		return false;
+	sampled->count++;
+
+	lttb->picked_idx = (double)sample_idx;
+	lttb->picked_value = value;
+	return true;
+}
+
+static double lttb_mean(const double* values, const size_t count)
+{
+	double sum = 0.0;
+	size_t idx;
+
+	for (idx = 0; idx < count; idx++)
+		sum += values[idx];
+
+	return sum / count;
+}
+
+/* Keeps the sample of the current bucket that forms the largest triangle with the last kept sample
+   and the given point. Samples are equally spaced, their indices serve as the times. */
+static bool lttb_pick(struct HPCS_Lttb* lttb, const double next_idx, const double next_value)
+{
+	const double dx = lttb->picked_idx - next_idx;
+	const double dy = next_value - lttb->picked_value;
+	double x = (double)lttb->current_start;
+	double best_area = -1.0;
+	size_t best = 0;
+	size_t idx;
+
+	for (idx = 0; idx < lttb->current_count; idx++) {
+		double area = dx * (lttb->current[idx] - lttb->picked_value) - (lttb->picked_idx - x) * dy;
+
+		/* Written as selections so that the compiler can avoid branching on noisy signal */
+		area = area > -area ? area : -area;
+		best = area > best_area ? idx : best;
+		best_area = area > best_area ? area : best_area;
+		x += 1.0;
+	}
+
+	if (!lttb_keep(lttb, lttb->current_start + best, lttb->current[best]))
+		return false;
+	lttb->current_count = 0;
+	return true;
+}
+
+/* The next bucket becomes the current one */
+static void lttb_rotate(struct HPCS_Lttb* lttb)
+{
+	double* bucket = lttb->current;
+
+	lttb->current = lttb->next;
+	lttb->current_start = lttb->next_start;
+	lttb->current_count = lttb->next_count;
+	lttb->next = bucket;
+	lttb->next_count = 0;
+}
+
+static bool map_measurement_file(const char* filename, struct HPCS_DataSource* src)
+{
+#ifdef _WIN32
+	return __win32_map_measurement_file(filename, src);
+#else
+	return __unix_map_measurement_file(filename, src);
+#endif
+}
+
+static bool map_measurement_stream(FILE* fh, struct HPCS_DataSource* src)
+{
+#ifdef _WIN32
+	return __win32_map_measurement_handle((HANDLE)_get_osfhandle(_fileno(fh)), src);
+#else
+	return __unix_map_measurement_fd(fileno(fh), src);
+#endif
+}
+
+static void* mem_alloc(const size_t size)
+{
+	if (allocator.allocate != NULL)
+		return allocator.allocate(allocator.handle, size);
+	return malloc(size);
+}
+
+static void* mem_calloc(const size_t count, const size_t size)
+{
+	void* ptr;
+
+	if (size > 0 && count > ((size_t)-1) / size)
+		return NULL;
+	if (allocator.allocate == NULL)
+		return calloc(count, size);
+
+	ptr = allocator.allocate(allocator.handle, count * size);
+	if (ptr != NULL)
+		memset(ptr, 0, count * size);
+	return ptr;
+}
+
+static void mem_free(void* ptr)
+{
+	if (allocator.release == NULL)
+		free(ptr);
+	else if (ptr != NULL)
+		allocator.release(allocator.handle, ptr);
+}
+
+static void* mem_realloc(void* ptr, const size_t size)
+{
+	if (allocator.reallocate != NULL)
+		return allocator.reallocate(allocator.handle, ptr, size);
+	return realloc(ptr, size);
+}
+
+/* Adds the blocks to an empty hash index. Only the first of the blocks with the same name is added. */
+static void method_index_build(struct HPCS_MethodIndex* index, const struct HPCS_MethodInfoBlock* blocks, const size_t count)
+{
+	size_t idx;
+
+	memset(index->slots, 0, (index->mask + 1) * sizeof(size_t));
+
+	for (idx = 0; idx < count; idx++) {
+		size_t slot = method_index_hash(blocks[idx].name) & index->mask;
+
+		while (index->slots[slot] != 0 && strcmp(blocks[index->slots[slot] - 1].name, blocks[idx].name) != 0)
+			slot = (slot + 1) & index->mask;
+		if (index->slots[slot] == 0)
+			index->slots[slot] = idx + 1;
+	}
+}
+
+static const struct HPCS_MethodInfoBlock* method_index_find(const struct HPCS_MethodIndex* index, const struct HPCS_MethodInfoBlock* blocks, const char* name)
+{
+	size_t slot = method_index_hash(name) & index->mask;
+
+	while (index->slots[slot] != 0) {
+		const struct HPCS_MethodInfoBlock* block = &blocks[index->slots[slot] - 1];
+
+		if (strcmp(block->name, name) == 0)
+			return block;
+		slot = (slot + 1) & index->mask;
+	}
+
+	return NULL;
+}
+
+/* FNV-1a */
+static size_t method_index_hash(const char* name)
+{
+	uint32_t hash = 2166136261U;
+
+	while (*name != '\0') {
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+/* Finds the next non-empty line of UTF-16LE text starting at "pos". The name ends at the first
+   equality sign of the line, the line break is not included in the value. */
+static bool method_info_line(const char* text, const size_t units, size_t* pos, struct HPCS_MethodInfoLine* line)
+{
+	const unsigned char* bytes = (const unsigned char*)text;
+
+	while (*pos < units) {
+		const size_t begin = *pos;
+		size_t end = begin;
+		size_t equals = units;
+
+		while (end < units && !(bytes[2 * end] == '\n' && bytes[2 * end + 1] == 0)) {
+			if (equals == units && bytes[2 * end] == '=' && bytes[2 * end + 1] == 0)
+				equals = end;
+			end++;
+		}
+		*pos = end < units ? end + 1 : end;
+
+		if (end > begin && bytes[2 * (end - 1)] == '\r' && bytes[2 * (end - 1) + 1] == 0)
+			end--;
+		if (end == begin)
+			continue;
+
+		line->name = begin;
+		if (equals < end) {
+			line->name_length = equals - begin;
+			line->value = equals + 1;
+			line->value_length = end - equals - 1;
+		} else {
+			line->name_length = end - begin;
+			line->value = end;
+			line->value_length = 0;
+		}
+		return true;
+	}
+
+	return false;
+}
+
+/* Widens the range between lo and hi to cover the values and adds the values to sum */
+static void min_max_sum(const double* values, const size_t count, double* lo, double* hi, double* sum, const enum HPCS_SimdLevel simd)
+{
+	size_t idx = 0;
+
+#ifdef HPCS_SIMD_X86
+	if (simd == SIMD_AVX2)
+		idx = __avx2_min_max_sum(values, count, lo, hi, sum);
+	else if (simd == SIMD_SSE2)
+		idx = __sse2_min_max_sum(values, count, lo, hi, sum);
+#else
+	(void)simd;
+#endif
+
+	for (; idx < count; idx++) {
+		if (values[idx] < *lo)
+			*lo = values[idx];
+		if (values[idx] > *hi)
+			*hi = values[idx];
+		*sum += values[idx];
+	}
+}
+
+static void mutex_destroy(HPCS_Mutex* mutex)
+{
+#ifdef _WIN32
+	DeleteCriticalSection(mutex);
+#else
+	pthread_mutex_destroy(mutex);
+#endif
+}
+
+static bool mutex_init(HPCS_Mutex* mutex)
+{
+#ifdef _WIN32
+	InitializeCriticalSection(mutex);
+	return true;
+#else
+	return pthread_mutex_init(mutex, NULL) == 0;
+#endif
+}
+
+static void mutex_lock(HPCS_Mutex* mutex)
+{
+#ifdef _WIN32
+	EnterCriticalSection(mutex);
+#else
+	pthread_mutex_lock(mutex);
+#endif
+}
+
+static void mutex_unlock(HPCS_Mutex* mutex)
+{
+#ifdef _WIN32
+	LeaveCriticalSection(mutex);
+#else
+	pthread_mutex_unlock(mutex);
+#endif
+}
+
+static uint8_t month_to_number(const char* month)
+{
+	if (strcmp(MON_JAN_STR, month) == 0)
+		return 1;
+	else if (strcmp(MON_FEB_STR, month) == 0)
+		return 2;
+	else if (strcmp(MON_MAR_STR, month) == 0)
+		return 3;
+	else if (strcmp(MON_APR_STR, month) == 0)
+		return 4;
+	else if (strcmp(MON_MAY_STR, month) == 0)
+		return 5;
+	else if (strcmp(MON_JUN_STR, month) == 0)
+		return 6;
+	else if (strcmp(MON_JUL_STR, month) == 0)
+		return 7;
+	else if (strcmp(MON_AUG_STR, month) == 0)
+		return 8;
+	else if (strcmp(MON_SEP_STR, month) == 0)
+		return 9;
+	else if (strcmp(MON_OCT_STR, month) == 0)
+		return 10;
+	else if (strcmp(MON_NOV_STR, month) == 0)
+		return 11;
+	else if (strcmp(MON_DEC_STR, month) == 0)
+		return 12;
+	else
+		return 0;
+}
+
+static enum HPCS_ParseCode open_data_source(const char* filename, struct HPCS_DataSource* src)
+{
+	FILE* fh;
+
+	src->memory = NULL;
+	src->fh = NULL;
+	src->size = 0;
+	src->buffer = NULL;
+
+	if (io_backend == HPCS_IO_AUTO) {
+		if (map_measurement_file(filename, src)) {
+			src->kind = SOURCE_MAPPED;
+			src->file_size = src->size;
+			return PARSE_OK;
+		}
+		PR_DEBUG("Cannot map file, falling back to stdio\n");
+	}
+
+	fh = open_measurement_file(filename);
+	if (fh == NULL)
+		return PARSE_E_CANT_READ;
+
+	return open_stdio_source(fh, src);
+}
+
+/* Same as open_data_source() for a file that has been opened already. The source takes over the stream. */
+static enum HPCS_ParseCode open_file_source(FILE* fh, struct HPCS_DataSource* src)
+{
+	src->memory = NULL;
+	src->fh = NULL;
+	src->size = 0;
+	src->buffer = NULL;
+
+	if (io_backend == HPCS_IO_AUTO) {
+		if (map_measurement_stream(fh, src)) {
+			fclose(fh);
+			src->kind = SOURCE_MAPPED;
+			src->file_size = src->size;
+			return PARSE_OK;
+		}
+		PR_DEBUG("Cannot map file, falling back to stdio\n");
+	}
+
+	return open_stdio_source(fh, src);
+}
+
+/* Reads the block that contains the file header from an opened file with a single request.
+   Header fields are then decoded from memory. The stream is left open. */
+static enum HPCS_ParseCode open_header_block(FILE* fh, struct HPCS_DataSource* src)
+{
+	long size;
+
+	/* Bypass stdio buffering so that the block is fetched by one read */
+	setvbuf(fh, NULL, _IONBF, 0);
+
+	if (fseek(fh, 0, SEEK_END) != 0 || (size = ftell(fh)) < 0 || fseek(fh, 0, SEEK_SET) != 0)
+		return PARSE_E_CANT_READ;
+
+	src->buffer = mem_alloc(HEADER_BLOCK_SIZE);
+	if (src->buffer == NULL)
+		return PARSE_E_NO_MEM;
+
+	src->kind = SOURCE_MEMORY;
+	src->memory = src->buffer;
+	src->fh = NULL;
+	src->size = fread(src->buffer, SMALL_SEGMENT_SIZE, HEADER_BLOCK_SIZE, fh);
+	src->file_size = (size_t)size;
+
+	if (ferror(fh)) {
+		mem_free(src->buffer);
+		return PARSE_E_CANT_READ;
+	}
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode open_header_source(const char* filename, struct HPCS_DataSource* src)
+{
+	enum HPCS_ParseCode pret;
+	FILE* fh;
+
+	fh = open_measurement_file(filename);
+	if (fh == NULL)
+		return PARSE_E_CANT_READ;
+
+	pret = open_header_block(fh, src);
+	fclose(fh);
+
+	return pret;
+}
+
+/* Opens the index file that belongs to a data file */
+static FILE* open_index_file(const char* filename, const bool write)
+{
+	char* path;
+	FILE* fh;
+#ifdef _WIN32
+	wchar_t* win_path;
+#endif
+
+	path = mem_alloc(strlen(filename) + sizeof(INDEX_FILE_EXT));
+	if (path == NULL)
+		return NULL;
+	strcpy(path, filename);
+	strcat(path, INDEX_FILE_EXT);
+
+#ifdef _WIN32
+	if (!__win32_utf8_to_wchar(&win_path, path)) {
+		mem_free(path);
+		return NULL;
+	}
+	fh = _wfopen(win_path, write ? L"wb" : L"rb");
+	mem_free(win_path);
+#else
+	fh = fopen(path, write ? "wb" : "rb");
+#endif
+
+	mem_free(path);
+	return fh;
+}
+
+/* Reads the block that contains the file header from a user-supplied source with a single request */
+static enum HPCS_ParseCode open_io_header_source(const struct HPCS_IOSource* io, struct HPCS_DataSource* src)
+{
+	enum HPCS_ParseCode pret;
+	uint64_t size;
+
+	src->buffer = mem_alloc(HEADER_BLOCK_SIZE);
+	if (src->buffer == NULL)
+		return PARSE_E_NO_MEM;
+
+	src->kind = SOURCE_MEMORY;
+	src->memory = src->buffer;
+	src->fh = NULL;
+
+	pret = io_read_at(io, 0, src->buffer, HEADER_BLOCK_SIZE, &src->size);
+	if (pret != PARSE_OK) {
+		mem_free(src->buffer);
+		return pret;
+	}
+
+	/* Sources that cannot tell their size only lack the predicted number of samples */
+	if (io->size == NULL || io->size(io->handle, &size) != 0 || size > (size_t)-1)
+		size = src->size;
+	src->file_size = (size_t)size;
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode open_io_source(const struct HPCS_IOSource* io, struct HPCS_DataSource* src)
+{
+	uint64_t size;
+
+	if (io->read == NULL || io->seek == NULL || io->size == NULL)
+		return PARSE_E_INV_PARAM;
+
+	if (io->size(io->handle, &size) != 0)
+		return PARSE_E_CANT_READ;
+	if (size > (size_t)-1)
+		return PARSE_E_OUT_OF_RANGE;
+
+	src->kind = SOURCE_IO;
+	src->io = *io;
+	src->memory = NULL;
+	src->fh = NULL;
+	src->size = (size_t)size;
+	src->file_size = src->size;
+
+	src->buffer = mem_alloc(SOURCE_BUFFER_SIZE);
+	if (src->buffer == NULL)
+		return PARSE_E_NO_MEM;
+
+	return PARSE_OK;
+}
+
+static void open_memory_source(const void* bytes, const size_t length, struct HPCS_DataSource* src)
+{
+	src->kind = SOURCE_MEMORY;
+	src->memory = bytes;
+	src->fh = NULL;
+	src->size = length;
+	src->file_size = length;
+	src->buffer = NULL;
+}
+
+static enum HPCS_RetCode open_signal_stream(struct HPCS_SignalStream* stream, struct HPCS_MeasuredData* mdata, const size_t chunk_size)
+{
+	struct HPCS_SignalParams params;
+	double xmin;
+	double xmax;
+	size_t data_count;
+	enum HPCS_ParseCode pret;
+	enum HPCS_RetCode ret;
+
+	stream->chunk_size = chunk_size > 0 ? chunk_size : STREAM_DEFAULT_CHUNK_SIZE;
+	stream->chunk = mem_alloc(sizeof(struct HPCS_TVPair) * stream->chunk_size);
+	if (stream->chunk == NULL)
+		return HPCS_E_PARSE_ERROR;
+
+	cursor_init(&stream->cursor, &stream->src);
+
+	ret = read_measurement_header(&stream->cursor, mdata, &params.gentype, &mdata->arena);
+	if (ret != HPCS_OK)
+		return ret;
+
+	pret = read_signal_params(&stream->cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	/* The time step depends on the total number of samples so the
+	   signal has to be walked once before it can be streamed */
+	pret = decoder_init(&stream->decoder, &stream->cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+	pret = decoder_decode(&stream->decoder, NULL, 0, (size_t)-1, &data_count);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	pret = read_time_range(&stream->cursor, &xmin, &xmax, params.gentype == GENTYPE_GC_B);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	stream->time = xmin;
+	stream->time_step = (xmax - xmin) / data_count;
+	mdata->sampling_rate = 1.0 / (stream->time_step * 60.0);
+	mdata->data = NULL;
+	mdata->data_count = data_count;
+
+	pret = decoder_init(&stream->decoder, &stream->cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	return HPCS_OK;
+}
+
+static FILE* open_measurement_file(const char* filename)
+{
+#ifdef _WIN32
+	FILE* f;
+	wchar_t *win_filename;
+
+	if (!__win32_utf8_to_wchar(&win_filename, filename))
+		return NULL;
+
+	f = _wfopen(win_filename, L"rb");
+	mem_free(win_filename);
+	return f;
+#else
+	return fopen(filename, "rb");
+#endif
+}
+
+static FILE* open_measurement_file_at(const struct HPCS_RunDir* dir, const char* name)
+{
+#ifdef _WIN32
+	char* path = join_path(dir->path, name);
+	FILE* fh;
+
+	if (path == NULL)
+		return NULL;
+	fh = open_measurement_file(path);
+	mem_free(path);
+	return fh;
+#else
+	return __unix_fopen_at(dir->fd, name, "rb");
+#endif
+}
+
+/* Sets up a source that reads an opened file through a buffer. The source takes over the stream. */
+static enum HPCS_ParseCode open_stdio_source(FILE* fh, struct HPCS_DataSource* src)
+{
+	long size;
+
+	src->kind = SOURCE_STDIO;
+	src->fh = fh;
+
+	if (fseek(src->fh, 0, SEEK_END) != 0)
+		goto err_out;
+	size = ftell(src->fh);
+	if (size < 0)
+		goto err_out;
+	src->size = (size_t)size;
+	src->file_size = src->size;
+
+	/* A reader lends its own buffer */
+	if (src->buffer == NULL) {
+		src->buffer = mem_alloc(SOURCE_BUFFER_SIZE);
+		if (src->buffer == NULL)
+			goto err_out;
+	}
+
+	return PARSE_OK;
+
+err_out:
+	fclose(src->fh);
+	src->fh = NULL;
+	return PARSE_E_CANT_READ;
+}
+
+static bool p_means_pressure(const enum HPCS_ChemStationVer version)
+{
+	if (version == CHEMSTAT_B0625)
+		return false;
+
+	return true;
+}
+
+/* Decodes one piece of a signal with a decoder of its own */
+static void parallel_decode_task(void* ctx, const size_t idx)
+{
+	struct HPCS_ParallelDecode* job = ctx;
+	struct HPCS_SignalPiece* piece = &job->pieces[idx];
+	struct HPCS_Cursor cursor;
+	struct HPCS_SignalDecoder decoder;
+	size_t count = 0;
+	enum HPCS_ParseCode pret;
+
+	cursor_init(&cursor, job->src);
+	pret = decoder_init(&decoder, &cursor, job->params);
+	if (pret == PARSE_OK)
+		pret = decoder_seek(&decoder, piece->first, job->checkpoints);
+
+	while (pret == PARSE_OK && count < piece->count && !decoder.finished) {
+		size_t decoded;
+
+		pret = decoder_decode(&decoder, job->values + piece->first + count, sizeof(double), piece->count - count, &decoded);
+		count += decoded;
+	}
+	if (pret == PARSE_OK && count < piece->count)
+		pret = PARSE_E_CANT_READ;
+
+	piece->pret = pret;
+}
+
+/* Runs task for every index in [0, n) on up to the given number of threads.
+   Every thread starts with its own contiguous range of indices and steals
+   single indices from the end of the other ranges once its own range is done,
+   so that a few expensive tasks do not hold up the rest of a range.
+   The calling thread participates as one of the workers. */
+static enum HPCS_ParseCode parallel_for(HPCS_ParallelTask task, void* ctx, const size_t n, int threads)
+{
+	struct HPCS_ParallelJob job;
+	struct HPCS_ParallelWorker* workers;
+	HPCS_Thread* handles;
+	bool* started;
+	size_t count;
+	size_t idx;
+	size_t begin;
+
+	if (n == 0)
+		return PARSE_OK;
+
+	if (threads < 1)
+		threads = cpu_count();
+	count = (size_t)threads < n ? (size_t)threads : n;
+
+	if (count < 2) {
+		for (idx = 0; idx < n; idx++)
+			task(ctx, idx);
+		return PARSE_OK;
+	}
+
+	job.task = task;
+	job.ctx = ctx;
+	job.queue_count = count;
+	job.queues = mem_alloc(sizeof(struct HPCS_WorkQueue) * count);
+	workers = mem_alloc(sizeof(struct HPCS_ParallelWorker) * count);
+	handles = mem_alloc(sizeof(HPCS_Thread) * count);
+	started = mem_calloc(count, sizeof(bool));
+	if (job.queues == NULL || workers == NULL || handles == NULL || started == NULL) {
+		mem_free(job.queues);
+		mem_free(workers);
+		mem_free(handles);
+		mem_free(started);
+		return PARSE_E_NO_MEM;
+	}
+
+	begin = 0;
+	for (idx = 0; idx < count; idx++) {
+		struct HPCS_WorkQueue* q = &job.queues[idx];
+
+		q->head = begin;
+		q->tail = begin + n / count + (idx < n % count ? 1 : 0);
+		begin = q->tail;
+		if (!mutex_init(&q->lock)) {
+			while (idx-- > 0)
+				mutex_destroy(&job.queues[idx].lock);
+			mem_free(job.queues);
+			mem_free(workers);
+			mem_free(handles);
+			mem_free(started);
+			return PARSE_E_INTERNAL;
+		}
+
+		workers[idx].job = &job;
+		workers[idx].id = idx;
+		workers[idx].start.func = parallel_worker;
+		workers[idx].start.arg = &workers[idx];
+	}
+
+	/* Work left behind by threads that fail to start is stolen by the others */
+	for (idx = 1; idx < count; idx++)
+		started[idx] = thread_create(&handles[idx], &workers[idx].start);
+	parallel_worker(&workers[0]);
+	for (idx = 1; idx < count; idx++) {
+		if (started[idx])
+			thread_join(handles[idx]);
+	}
+
+	for (idx = 0; idx < count; idx++)
+		mutex_destroy(&job.queues[idx].lock);
+	mem_free(job.queues);
+	mem_free(workers);
+	mem_free(handles);
+	mem_free(started);
+
+	return PARSE_OK;
+}
+
+static void parallel_worker(void* arg)
+{
+	struct HPCS_ParallelWorker* worker = arg;
+	struct HPCS_ParallelJob* job = worker->job;
+	size_t task_idx;
+
+	while (true) {
+		if (!work_queue_pop(&job->queues[worker->id], &task_idx)) {
+			bool stolen = false;
+			size_t k;
+
+			for (k = 1; k < job->queue_count && !stolen; k++)
+				stolen = work_queue_steal(&job->queues[(worker->id + k) % job->queue_count], &task_idx);
+			if (!stolen)
+				return;
+		}
+
+		job->task(job->ctx, task_idx);
+	}
+}
+
+/* Number of samples in a file of the given size. It is exact for 179 signal and an upper bound
+   for 30/130 signal where markers and value jumps take up some of the segments. */
+static size_t predict_sample_count(const enum HPCS_GenType gentype, const size_t scans_start, const size_t file_size)
+{
+	if (file_size <= scans_start)
+		return 0;
+
+	switch (gentype) {
+	case GENTYPE_GC_B:
+		return (file_size - scans_start) / DOUBLE_SEGMENT_SIZE;
+	case GENTYPE_ADC_LC:
+	case GENTYPE_ADC_LC2:
+		/* The leading marker is not a sample */
+		return (file_size - scans_start) / SEGMENT_SIZE - 1;
+	default:
+		return 0;
+	}
+}
+
+/* Allocates the next level of a pyramid */
+static bool pyramid_add_level(struct HPCS_Pyramid* pyramid, const size_t count)
+{
+	struct HPCS_PyramidLevel* level = &pyramid->levels[pyramid->levels_count];
+
+	level->min = mem_alloc(sizeof(double) * count);
+	level->max = mem_alloc(sizeof(double) * count);
+	level->sum = mem_alloc(sizeof(double) * count);
+	level->count = count;
+	/* The level is counted even if it is incomplete so that it is freed with the pyramid */
+	pyramid->levels_count++;
+
+	return level->min != NULL && level->max != NULL && level->sum != NULL;
+}
+
+/* Combines the samples from first up to end. The range is covered by the largest buckets that start
+   and end within it, at most two buckets of each level and PYRAMID_BASE - 1 samples at either end
+   are visited. The range must not be empty. */
+static void pyramid_reduce(const struct HPCS_Pyramid* pyramid, size_t first, const size_t end, double* lo, double* hi, double* sum)
+{
+	*lo = pyramid->values[first];
+	*hi = pyramid->values[first];
+	*sum = 0.0;
+
+	while (first < end) {
+		size_t level = pyramid->levels_count;
+		size_t size = 1;
+
+		while (level > 0) {
+			size = PYRAMID_BASE << (level - 1);
+			if (first % size == 0 && end - first >= size)
+				break;
+			level--;
+		}
+
+		if (level == 0) {
+			const double v = pyramid->values[first];
+
+			*lo = v < *lo ? v : *lo;
+			*hi = v > *hi ? v : *hi;
+			*sum += v;
+			first++;
+		} else {
+			const struct HPCS_PyramidLevel* l = &pyramid->levels[level - 1];
+			const size_t idx = first / size;
+
+			*lo = l->min[idx] < *lo ? l->min[idx] : *lo;
+			*hi = l->max[idx] > *hi ? l->max[idx] : *hi;
+			*sum += l->sum[idx];
+			first += size;
+		}
+	}
+}
+
+static enum HPCS_ParseCode read_dad_wavelength(struct HPCS_Cursor* cursor, struct HPCS_Wavelength* const measured, struct HPCS_Wavelength* const reference, const enum HPCS_GenType gentype,
+					       struct HPCS_Arena** arena)
+{
+	char* start_idx, *interv_idx, *end_idx, *temp, *str;
+	size_t len, tmp_len;
+	enum HPCS_ParseCode pret, ret;
+	const HPCS_offset devsig_info_offset = OLD_FORMAT(gentype) ? DATA_OFFSET_DEVSIG_INFO_OLD : DATA_OFFSET_DEVSIG_INFO;
+
+	measured->wavelength = 0;
+	measured->interval = 0;
+	reference->wavelength = 0;
+	reference->interval = 0;
+	pret = read_string_at_offset(cursor, devsig_info_offset, &str, OLD_FORMAT(gentype), arena);
+	if (pret != PARSE_OK)
+		return pret;
+
+	/* Read MEASURED wavelength */
+	start_idx = strstr(str, WAVELENGTH_MEASURED_TEXT);
+	if (start_idx == NULL) {
+		ret = PARSE_W_NO_DATA;
+		goto out;
+	}
+
+	start_idx += strlen(WAVELENGTH_MEASURED_TEXT);
+	interv_idx = strchr(start_idx, WAVELENGTH_DELIMITER_TEXT);
+	if (interv_idx == NULL) {
+		PR_DEBUG("No spectral interval value\n");
+		ret = PARSE_E_NOT_FOUND;
+		goto out;
+	}
+	end_idx = strchr(interv_idx, WAVELENGTH_END_TEXT);
+	if (end_idx == NULL) {
+		PR_DEBUG("No measured/reference wavelength delimiter found\n");
+		ret = PARSE_E_NOT_FOUND;
+		goto out;
+	}
+
+	if (start_idx >= interv_idx) {
+		PR_DEBUG("start_idx >= interv_idx\n");
+		ret = PARSE_E_CANT_READ;
+		goto out;
+	}
+
+	len = interv_idx - start_idx;
+	temp = arena_alloc(arena, len + 1);
+	if (temp == NULL) {
+		PR_DEBUG("No memory for temporary string\n");
+		ret = PARSE_E_NO_MEM;
+		goto out;
+	}
+	memcpy(temp, start_idx, len);
+	temp[len] = 0;
+	measured->wavelength = (uint16_t)strtoul(temp, NULL, 10);
 
 	/* Read MEASURED spectral interval */
 	if (interv_idx >= end_idx) {
@@ -611,855 +4032,2383 @@ static enum HPCS_ParseCode read_dad_wavelength(FILE* datafile, struct HPCS_Wavel
 		goto out2;
 	}
 
-	tmp_len = end_idx - interv_idx;
-	if (tmp_len < 1) {
-		PR_DEBUG("end_idx - interv_idx < 1\n");
-		ret = PARSE_E_CANT_READ;
-		goto out2;
-	}
-	if (tmp_len - 1 > len) {
-		free(temp);
-		temp = malloc(tmp_len - 1);
-		if (temp == NULL) {
-			PR_DEBUG("No memory for temporary string\n");
-			ret = PARSE_E_NO_MEM;
-			goto out;
-		}
-	}
-	len = tmp_len - 2;
-	memcpy(temp, interv_idx + 1, len);
-	temp[len] = 0;
-	measured->interval = (uint16_t)strtoul(temp, NULL, 10);
+	tmp_len = end_idx - interv_idx;
+	if (tmp_len < 1) {
+		PR_DEBUG("end_idx - interv_idx < 1\n");
+		ret = PARSE_E_CANT_READ;
+		goto out2;
+	}
+	if (tmp_len - 1 > len) {
+		arena_free(arena, temp);
+		temp = arena_alloc(arena, tmp_len - 1);
+		if (temp == NULL) {
+			PR_DEBUG("No memory for temporary string\n");
+			ret = PARSE_E_NO_MEM;
+			goto out;
+		}
+	}
+	len = tmp_len - 2;
+	memcpy(temp, interv_idx + 1, len);
+	temp[len] = 0;
+	measured->interval = (uint16_t)strtoul(temp, NULL, 10);
+
+	/* Read REFERENCE wavelength */
+	start_idx = strstr(end_idx, WAVELENGTH_REFERENCE_TEXT);
+	if (start_idx == NULL) {
+		PR_DEBUG("No reference wavelength data\n");
+		ret = PARSE_W_NO_DATA;
+		goto out2;
+	}
+	start_idx += strlen(WAVELENGTH_REFERENCE_TEXT);
+	interv_idx = strchr(start_idx, WAVELENGTH_DELIMITER_TEXT);
+	if (interv_idx == NULL) {
+		/* Is the reference wavelength disabled? */
+		if (strcmp(start_idx, WAVELENGTH_REFERENCE_OFF_TEXT) == 0) {
+			ret = PARSE_OK;
+			goto out2;
+		}
+		PR_DEBUG("No reference spectral interval but reference wavelength is not 'off'\n");
+		ret = PARSE_E_NOT_FOUND;
+		goto out2;
+	}
+
+	if (start_idx >= interv_idx) {
+		PR_DEBUG("start_idx >= interv_idx\n");
+		ret = PARSE_E_CANT_READ;
+		goto out2;
+	}
+
+	tmp_len = interv_idx - start_idx;
+	if (tmp_len > len + 1) {
+		arena_free(arena, temp);
+		temp = arena_alloc(arena, interv_idx - start_idx + 1);
+		if (temp == NULL) {
+			PR_DEBUG("No memory for temporary string\n");
+			ret = PARSE_E_NO_MEM;
+			goto out;
+		}
+	}
+	len = interv_idx - start_idx;
+	memcpy(temp, start_idx, len);
+	temp[len] = 0;
+	reference->wavelength = (uint16_t)strtoul(temp, NULL, 10);
+	reference->interval = (uint16_t)strtoul(interv_idx + 1, NULL, 10);
+	ret = PARSE_OK;
+
+out2:
+	arena_free(arena, temp);
+out:
+	arena_free(arena, str);
+	return ret;
+}
+
+/* This function assumes that the date information are composed only of the
+   first 127 characters from ISO-8859-1 charset. Under such assumption it is
+   possible to treat UTF-8 strings as single-byte strings with ISO-8859-1
+   encoding */
+static enum HPCS_ParseCode read_date(struct HPCS_Cursor* cursor, struct HPCS_Date* date, const enum HPCS_GenType gentype, struct HPCS_Arena** arena)
+{
+	char* date_str;
+	char* date_time_delim;
+	char* dm_delim, *my_delim;
+	char* hm_delim, *ms_delim;
+	char temp[32];
+	size_t len;
+	enum HPCS_ParseCode pret;
+	const HPCS_offset date_offset = OLD_FORMAT(gentype) ? DATA_OFFSET_DATE_OLD : DATA_OFFSET_DATE;
+
+	pret = read_string_at_offset(cursor, date_offset, &date_str, OLD_FORMAT(gentype), arena);
+	if (pret != PARSE_OK)
+		return pret;
+
+	/* Find date / time delimiter */
+	date_time_delim = strchr(date_str, DATA_FILE_COMMA);
+	if (date_time_delim == NULL) {
+		arena_free(arena, date_str);
+		return PARSE_E_NOT_FOUND;
+	}
+
+	/* Get day */
+	dm_delim = strchr(date_str, DATA_FILE_DASH);
+	if (dm_delim == NULL || dm_delim > date_time_delim) {
+		arena_free(arena, date_str);
+		return PARSE_E_NOT_FOUND;
+	}
+	len = dm_delim - date_str;
+	if (len >= sizeof(temp))
+		goto err_out;
+	memcpy(temp, date_str, len);
+	temp[len] = 0;
+	date->day = (uint8_t)strtoul(temp, NULL, 10);
+
+	/* Get month */
+	my_delim = strchr(dm_delim + 1, DATA_FILE_DASH);
+	if (my_delim == NULL || my_delim > date_time_delim) {
+		arena_free(arena, date_str);
+		return PARSE_E_NOT_FOUND;
+	}
+	len = my_delim - (dm_delim + 1);
+	if (len >= sizeof(temp))
+		goto err_out;
+	memcpy(temp, dm_delim + 1, len);
+	temp[len] = 0;
+	date->month = month_to_number(temp);
+
+	/* Get year */
+	len = date_time_delim - (my_delim + 1);
+	if (len >= sizeof(temp))
+		goto err_out;
+	memcpy(temp, my_delim + 1, len);
+	temp[len] = 0;
+	date->year = strtoul(temp, NULL, 10);
+	if (date->year < 90) /* Y2K workaround */
+		date->year += 2000;
+
+	/* Get hour */
+	hm_delim = strchr(date_time_delim + 1, DATA_FILE_COLON);
+	if (hm_delim == NULL) {
+		arena_free(arena, date_str);
+		return PARSE_E_NOT_FOUND;
+	}
+	len = hm_delim - (date_time_delim + 1);
+	if (len >= sizeof(temp))
+		goto err_out;
+	memcpy(temp, date_time_delim + 1, len);
+	temp[len] = 0;
+	date->hour = (uint8_t)strtoul(temp, NULL, 10);
+
+	/* Get minute */
+	ms_delim = strchr(hm_delim + 1, DATA_FILE_COLON);
+	if (ms_delim == NULL) {
+		arena_free(arena, date_str);
+		return PARSE_E_NOT_FOUND;
+	}
+	len = ms_delim - (hm_delim + 1);
+	if (len >= sizeof(temp))
+		goto err_out;
+	memcpy(temp, hm_delim + 1, len);
+	temp[len] = 0;
+	date->minute = (uint8_t)strtoul(temp, NULL, 10);
+
+	/* Get second */
+	date->second = (uint8_t)strtoul(ms_delim + 1, NULL, 10);
+
+	arena_free(arena, date_str);
+	return PARSE_OK;
+
+err_out:
+	arena_free(arena, date_str);
+	return PARSE_E_CANT_READ;
+}
+
+static enum HPCS_ParseCode read_file_header(struct HPCS_Cursor* cursor, enum HPCS_ChemStationVer* cs_ver, struct HPCS_MeasuredData* mdata, const enum HPCS_GenType gentype,
+					    struct HPCS_Arena** scratch)
+{
+	enum HPCS_ParseCode pret;
+	const bool old_format = OLD_FORMAT(gentype);
+	const HPCS_offset sample_info_offset = old_format ? DATA_OFFSET_SAMPLE_INFO_OLD : DATA_OFFSET_SAMPLE_INFO;
+	const HPCS_offset operator_name_offset = old_format ? DATA_OFFSET_OPERATOR_NAME_OLD : DATA_OFFSET_OPERATOR_NAME;
+	const HPCS_offset method_name_offset = old_format ? DATA_OFFSET_METHOD_NAME_OLD : DATA_OFFSET_METHOD_NAME;
+	const HPCS_offset y_units_offset = old_format ? DATA_OFFSET_Y_UNITS_OLD : DATA_OFFSET_Y_UNITS;
+
+	pret = read_string_at_offset(cursor, sample_info_offset, &mdata->sample_info, old_format, &mdata->arena);
+	if (pret != PARSE_OK) {
+	    PR_DEBUGF("%s%d\n", "Cannot read sample info, errno: ", pret);
+	    return pret;
+	}
+	pret = read_string_at_offset(cursor, operator_name_offset, &mdata->operator_name, old_format, &mdata->arena);
+	if (pret != PARSE_OK) {
+	    PR_DEBUGF("%s%d\n", "Cannot read operator name, errno: ", pret);
+	    return pret;
+	}
+	pret = read_string_at_offset(cursor, method_name_offset, &mdata->method_name, old_format, &mdata->arena);
+	if (pret != PARSE_OK) {
+	    PR_DEBUGF("%s%d\n", "Cannot read method name, errno: ", pret);
+	    return pret;
+	}
+	pret = read_date(cursor, &mdata->date, gentype, scratch);
+	if (pret != PARSE_OK) {
+	    PR_DEBUGF("%s%d\n", "Cannot read date of measurement, errno: ", pret);
+	    return pret;
+	}
+
+	if (!old_format) {
+		pret = read_string_at_offset(cursor, DATA_OFFSET_CS_VER, &mdata->cs_ver, old_format, &mdata->arena);
+		if (pret != PARSE_OK) {
+			PR_DEBUGF("%s%d\n", "Cannot read ChemStation software version, errno: ", pret);
+			return pret;
+		}
+		pret = read_string_at_offset(cursor, DATA_OFFSET_CS_REV, &mdata->cs_rev, old_format, &mdata->arena);
+			if (pret != PARSE_OK) {
+			PR_DEBUGF("%s%d\n", "Cannot read ChemStation software revision, errno: ", pret);
+			return pret;
+		}
+	} else {
+		mdata->cs_ver = DEFAULT_CS_VER(&mdata->arena);
+		mdata->cs_rev = DEFAULT_CS_REV(&mdata->arena);
+	}
+
+	pret = read_string_at_offset(cursor, y_units_offset, &mdata->y_units, old_format, &mdata->arena);
+	if (pret != PARSE_OK) {
+		PR_DEBUGF("%s%d\n", "Cannot read values of Y axis, errno: ", pret);
+		return pret;
+	}
+
+	*cs_ver = detect_chemstation_version(mdata->cs_ver);
+	if (pret != PARSE_OK) {
+		PR_DEBUGF("%s%d\n", "Cannot detect ChemStation version, errno: ", pret);
+		return pret;
+	}
+
+	pret = autodetect_file_type(cursor, &mdata->file_type, p_means_pressure(*cs_ver), gentype, scratch);
+	if (pret != PARSE_OK) {
+	    PR_DEBUGF("%s%d\n", "Cannot determine the type of file, errno: ", pret);
+	    return pret;
+	}
+
+	if (mdata->file_type == HPCS_TYPE_CE_DAD) {
+	    pret = read_dad_wavelength(cursor, &mdata->dad_wavelength_msr, &mdata->dad_wavelength_ref, gentype, scratch);
+	    if (pret != PARSE_OK && pret != PARSE_W_NO_DATA) {
+			PR_DEBUGF("%s%d\n", "Cannot read wavelength, errno: ", pret);
+			return pret;
+	    }
+	}
+
+	/* Sampling rate information is unreliable unless the whole file is read */
+	mdata->sampling_rate = -1.0;
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode read_file_type_description(struct HPCS_Cursor* cursor, char** const description, const enum HPCS_GenType gentype, struct HPCS_Arena** arena)
+{
+	enum HPCS_ParseCode pret;
+	const HPCS_offset offset = OLD_FORMAT(gentype) ? DATA_OFFSET_FILE_DESC_OLD : DATA_OFFSET_FILE_DESC;
+
+	pret = read_string_at_offset(cursor, offset, description, OLD_FORMAT(gentype), arena);
+	if (pret != PARSE_OK)
+		PR_DEBUGF("%s%d\n", "Cannot read file description, errno: ", pret);
+
+	return pret;
+}
+
+static enum HPCS_RetCode read_measurement(struct HPCS_DataSource* src, struct HPCS_MeasuredData* mdata, const bool header_only)
+{
+	struct HPCS_Cursor cursor;
+	enum HPCS_GenType gentype;
+	enum HPCS_RetCode ret;
+
+	cursor_init(&cursor, src);
+
+	ret = read_measurement_header(&cursor, mdata, &gentype, &mdata->arena);
+	if (ret != HPCS_OK || header_only)
+		return ret;
+
+	return read_measurement_signal(&cursor, mdata, gentype);
+}
+
+/* Number of samples to split into the given number of buckets, estimated from the size of the file so
+   that the signal has to be decoded only once. There are never more buckets than samples. */
+static size_t bucket_samples_for(const struct HPCS_SignalParams* params, const size_t file_size, size_t* buckets)
+{
+	const size_t estimate = predict_sample_count(params->gentype, params->scans_start, file_size);
+
+	if (estimate >= *buckets)
+		return estimate;
+	if (estimate > 0)
+		*buckets = estimate;
+	return *buckets;
+}
+
+/* Index of the sample past the end of a bucket. Bucket i holds the samples from i * samples / buckets
+   up to (i + 1) * samples / buckets, rounded up, as hpcs_pyramid_query() splits its windows. */
+static size_t bucket_end(const size_t samples, const size_t buckets, const size_t idx)
+{
+	return (size_t)(((uint64_t)samples * (idx + 1) + buckets - 1) / buckets);
+}
+
+/* Decodes the signal in blocks and keeps only the smallest, the largest and the mean value of each bucket */
+static enum HPCS_RetCode read_measurement_envelope(struct HPCS_DataSource* src, size_t buckets, struct HPCS_MeasuredData* mdata,
+						  struct HPCS_Envelope* envelope)
+{
+	double block[NARROW_BLOCK_SIZE];
+	struct HPCS_Cursor cursor;
+	struct HPCS_SignalParams params;
+	struct HPCS_SignalDecoder decoder;
+	struct HPCS_TimeAxis axis;
+	size_t samples;
+	size_t bucket_stop;
+	size_t allocated;
+	size_t taken = 0;
+	size_t filled = 0;
+	double lo = 0.0;
+	double hi = 0.0;
+	double sum = 0.0;
+	enum HPCS_ParseCode pret;
+	enum HPCS_RetCode ret;
+
+	cursor_init(&cursor, src);
+
+	ret = read_measurement_header(&cursor, mdata, &params.gentype, &mdata->arena);
+	if (ret != HPCS_OK)
+		return ret;
+
+	pret = read_signal_params(&cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	if (buckets == 0)
+		buckets = 1;
+	samples = bucket_samples_for(&params, src->file_size, &buckets);
+	bucket_stop = bucket_end(samples, buckets, 0);
+
+	allocated = buckets;
+	envelope->min = mem_alloc(sizeof(double) * allocated);
+	envelope->max = mem_alloc(sizeof(double) * allocated);
+	envelope->mean = mem_alloc(sizeof(double) * allocated);
+	envelope->time.count = 0;
+	if (envelope->min == NULL || envelope->max == NULL || envelope->mean == NULL) {
+		pret = PARSE_E_NO_MEM;
+		goto out;
+	}
+
+	pret = decoder_init(&decoder, &cursor, &params);
+	while (pret == PARSE_OK && !decoder.finished) {
+		size_t decoded;
+		size_t idx = 0;
+
+		pret = decoder_decode(&decoder, block, sizeof(double), NARROW_BLOCK_SIZE, &decoded);
+		while (pret == PARSE_OK && idx < decoded) {
+			size_t end = idx + bucket_stop - taken;
+
+			if (end > decoded)
+				end = decoded;
+			if (filled == 0) {
+				lo = hi = block[idx];
+				sum = 0.0;
+			}
+			filled += end - idx;
+			taken += end - idx;
+
+			min_max_sum(block + idx, end - idx, &lo, &hi, &sum, decoder.simd);
+			idx = end;
+
+			if (taken == bucket_stop) {
+				if (!append_bucket(envelope, &allocated, lo, hi, sum / filled))
+					pret = PARSE_E_NO_MEM;
+				filled = 0;
+				bucket_stop = bucket_end(samples, buckets, envelope->time.count);
+			}
+		}
+	}
+	if (pret == PARSE_OK && filled > 0) {
+		if (!append_bucket(envelope, &allocated, lo, hi, sum / filled))
+			pret = PARSE_E_NO_MEM;
+	}
+	if (pret != PARSE_OK)
+		goto out;
+
+	axis.count = decoder.samples;
+	pret = read_time_axis(&cursor, params.gentype, &axis, &mdata->sampling_rate);
+	if (pret != PARSE_OK)
+		goto out;
+
+	envelope->time.t0 = axis.t0;
+	envelope->time.dt = axis.dt * samples / buckets;
+
+out:
+	if (pret != PARSE_OK) {
+		mem_free(envelope->min);
+		mem_free(envelope->max);
+		mem_free(envelope->mean);
+		envelope->min = NULL;
+		envelope->max = NULL;
+		envelope->mean = NULL;
+		envelope->time.count = 0;
+		return HPCS_E_PARSE_ERROR;
+	}
+
+	return HPCS_OK;
+}
+
+static enum HPCS_RetCode read_measurement_float(struct HPCS_DataSource* src, struct HPCS_MeasuredData* mdata, struct HPCS_FloatSignal* signal)
+{
+	struct HPCS_Cursor cursor;
+	struct HPCS_SignalParams params;
+	enum HPCS_ParseCode pret;
+	enum HPCS_RetCode ret;
+
+	cursor_init(&cursor, src);
+
+	ret = read_measurement_header(&cursor, mdata, &params.gentype, &mdata->arena);
+	if (ret != HPCS_OK)
+		return ret;
+
+	pret = read_signal_params(&cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	pret = read_signal_float(&cursor, &signal->values, &signal->time.count, &params);
+	if (pret != PARSE_OK) {
+		PR_DEBUG("Cannot parse data in the file\n");
+		return HPCS_E_PARSE_ERROR;
+	}
+
+	pret = read_time_axis(&cursor, params.gentype, &signal->time, &mdata->sampling_rate);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	return HPCS_OK;
+}
+
+/* Temporary strings are allocated from the scratch arena, which can be the arena of the object itself */
+static enum HPCS_RetCode read_measurement_header(struct HPCS_Cursor* cursor, struct HPCS_MeasuredData* mdata, enum HPCS_GenType* gentype,
+						 struct HPCS_Arena** scratch)
+{
+	enum HPCS_ParseCode pret;
+	enum HPCS_ChemStationVer cs_ver;
+	size_t scans_start;
+
+	pret = read_generic_type(cursor, gentype);
+	if (pret != PARSE_OK) {
+		PR_DEBUG("Cannot read generic file type\n");
+		return HPCS_E_PARSE_ERROR;
+	}
+
+	if (!gentype_is_readable(*gentype)) {
+		PR_DEBUGF("%s: %d\n", "Incompatible file type", *gentype);
+		return HPCS_E_INCOMPATIBLE_FILE;
+	}
+
+	pret = read_file_type_description(cursor, &mdata->file_description, *gentype, &mdata->arena);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	if (!file_type_description_is_readable(mdata->file_description)) {
+		PR_DEBUGF("Incompatible file description: %s\n", mdata->file_description);
+		return HPCS_E_INCOMPATIBLE_FILE;
+	}
+
+	pret = read_file_header(cursor, &cs_ver, mdata, *gentype, scratch);
+	if (pret != PARSE_OK) {
+		PR_DEBUG("Cannot read the header\n");
+		return HPCS_E_PARSE_ERROR;
+	}
+
+	if (read_scans_start(cursor, &scans_start) == PARSE_OK)
+		mdata->predicted_count = predict_sample_count(*gentype, scans_start, cursor->src->file_size);
+
+	return HPCS_OK;
+}
+
+/* Decodes the signal in blocks and downsamples it on the fly */
+static enum HPCS_RetCode read_measurement_lttb(struct HPCS_DataSource* src, size_t points, struct HPCS_MeasuredData* mdata,
+					      struct HPCS_SampledSignal* sampled)
+{
+	double block[NARROW_BLOCK_SIZE];
+	struct HPCS_Cursor cursor;
+	struct HPCS_SignalParams params;
+	struct HPCS_SignalDecoder decoder;
+	struct HPCS_TimeAxis axis;
+	struct HPCS_Lttb lttb;
+	size_t widest;
+	size_t idx;
+	enum HPCS_ParseCode pret;
+	enum HPCS_RetCode ret;
+
+	cursor_init(&cursor, src);
+
+	ret = read_measurement_header(&cursor, mdata, &params.gentype, &mdata->arena);
+	if (ret != HPCS_OK)
+		return ret;
+
+	pret = read_signal_params(&cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	/* The first and the last sample are kept on top of one sample per bucket */
+	if (points < 3)
+		points = 3;
+	lttb.buckets = points;
+	lttb.bucket_samples = bucket_samples_for(&params, src->file_size, &lttb.buckets);
+	if (lttb.buckets >= 3) {
+		lttb.buckets -= 2;
+		lttb.bucket_samples -= 2;
+	} else
+		lttb.buckets = lttb.bucket_samples = 1;
+	lttb.bucket = 0;
+	lttb.next_stop = 1 + bucket_end(lttb.bucket_samples, lttb.buckets, 0);
+	/* No bucket is wider than the first one */
+	widest = bucket_end(lttb.bucket_samples, lttb.buckets, 0);
+
+	sampled->count = 0;
+	lttb.sampled = sampled;
+	lttb.allocated = points;
+	lttb.current_count = 0;
+	lttb.next_count = 0;
+	lttb.samples = 0;
+	sampled->times = mem_alloc(sizeof(double) * lttb.allocated);
+	sampled->values = mem_alloc(sizeof(double) * lttb.allocated);
+	lttb.current = mem_alloc(sizeof(double) * widest);
+	lttb.next = mem_alloc(sizeof(double) * widest);
+	if (sampled->times == NULL || sampled->values == NULL || lttb.current == NULL || lttb.next == NULL) {
+		pret = PARSE_E_NO_MEM;
+		goto out;
+	}
+
+	pret = decoder_init(&decoder, &cursor, &params);
+	while (pret == PARSE_OK && !decoder.finished) {
+		size_t decoded;
+
+		pret = decoder_decode(&decoder, block, sizeof(double), NARROW_BLOCK_SIZE, &decoded);
+		if (pret == PARSE_OK && !lttb_collect(&lttb, block, decoded))
+			pret = PARSE_E_NO_MEM;
+	}
+	if (pret == PARSE_OK && !lttb_finish(&lttb))
+		pret = PARSE_E_NO_MEM;
+	if (pret != PARSE_OK)
+		goto out;
+
+	axis.count = decoder.samples;
+	pret = read_time_axis(&cursor, params.gentype, &axis, &mdata->sampling_rate);
+	if (pret != PARSE_OK)
+		goto out;
+
+	/* The indices of the kept samples are turned into times */
+	for (idx = 0; idx < sampled->count; idx++)
+		sampled->times[idx] = axis.t0 + sampled->times[idx] * axis.dt;
+
+out:
+	mem_free(lttb.current);
+	mem_free(lttb.next);
+	if (pret != PARSE_OK) {
+		mem_free(sampled->times);
+		mem_free(sampled->values);
+		sampled->times = NULL;
+		sampled->values = NULL;
+		sampled->count = 0;
+		return HPCS_E_PARSE_ERROR;
+	}
+
+	return HPCS_OK;
+}
+
+/* The index, if given, replaces the scan of 30/130 signal */
+static enum HPCS_RetCode read_measurement_range(struct HPCS_DataSource* src, const double t_start, const double t_end, struct HPCS_MeasuredData* mdata,
+					       struct HPCS_Signal* signal, const struct HPCS_SignalIndex* index)
+{
+	struct HPCS_Cursor cursor;
+	struct HPCS_SignalParams params;
+	struct HPCS_SignalDecoder decoder;
+	struct HPCS_CheckpointList checkpoints;
+	const struct HPCS_CheckpointList* seek_points;
+	struct HPCS_TimeAxis axis;
+	size_t first;
+	size_t end;
+	size_t count = 0;
+	enum HPCS_ParseCode pret;
+	enum HPCS_RetCode ret;
+
+	cursor_init(&cursor, src);
+
+	ret = read_measurement_header(&cursor, mdata, &params.gentype, &mdata->arena);
+	if (ret != HPCS_OK)
+		return ret;
+
+	pret = read_signal_params(&cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	pret = decoder_init(&decoder, &cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	/* The number of samples is needed to map the times to samples. Size of the file gives it
+	   for 179 signal, 30/130 signal has to be scanned unless it is indexed. The scan notes where
+	   the value jumps so that the range can be decoded from the nearest jump. */
+	checkpoints.items = NULL;
+	checkpoints.count = 0;
+	checkpoints.allocated = 0;
+	checkpoints.failed = false;
+	seek_points = NULL;
+	if (params.gentype == GENTYPE_GC_B)
+		axis.count = predict_sample_count(params.gentype, params.scans_start, src->file_size);
+	else if (index != NULL && index->interval > 0) {
+		axis.count = index->sample_count;
+		seek_points = &index->checkpoints;
+	} else {
+		decoder.checkpoints = &checkpoints;
+		pret = decoder_decode(&decoder, NULL, 0, (size_t)-1, &axis.count);
+		if (pret != PARSE_OK) {
+			ret = HPCS_E_PARSE_ERROR;
+			goto out;
+		}
+		if (!checkpoints.failed)
+			seek_points = &checkpoints;
+	}
+
+	pret = read_time_axis(&cursor, params.gentype, &axis, &mdata->sampling_rate);
+	if (pret != PARSE_OK) {
+		ret = HPCS_E_PARSE_ERROR;
+		goto out;
+	}
+
+	window_samples(&axis, t_start, t_end, &first, &end);
+
+	signal->values = mem_alloc(sizeof(double) * (end > first ? end - first : 1));
+	if (signal->values == NULL) {
+		ret = HPCS_E_PARSE_ERROR;
+		goto out;
+	}
+
+	if (end > first) {
+		pret = decoder_init(&decoder, &cursor, &params);
+		if (pret == PARSE_OK)
+			pret = decoder_seek(&decoder, first, seek_points);
+		while (pret == PARSE_OK && count < end - first && !decoder.finished) {
+			size_t decoded;
+
+			pret = decoder_decode(&decoder, signal->values + count, sizeof(double), end - first - count, &decoded);
+			count += decoded;
+		}
+		if (pret != PARSE_OK) {
+			mem_free(signal->values);
+			signal->values = NULL;
+			ret = HPCS_E_PARSE_ERROR;
+			goto out;
+		}
+	}
+
+	signal->time.t0 = axis.t0 + first * axis.dt;
+	signal->time.dt = axis.dt;
+	signal->time.count = count;
+	ret = HPCS_OK;
+
+out:
+	mem_free(checkpoints.items);
+	return ret;
+}
+
+static enum HPCS_RetCode read_measurement_raw(struct HPCS_DataSource* src, struct HPCS_MeasuredData* mdata, struct HPCS_RawSignal* raw)
+{
+	struct HPCS_Cursor cursor;
+	struct HPCS_SignalParams params;
+	enum HPCS_ParseCode pret;
+	enum HPCS_RetCode ret;
+
+	cursor_init(&cursor, src);
+
+	ret = read_measurement_header(&cursor, mdata, &params.gentype, &mdata->arena);
+	if (ret != HPCS_OK)
+		return ret;
+
+	/* GC signal is stored as floating point values */
+	if (params.gentype == GENTYPE_GC_B)
+		return HPCS_E_INCOMPATIBLE_FILE;
+
+	pret = read_signal_params(&cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	pret = read_signal_counts(&cursor, &raw->counts, &raw->time.count, &params);
+	if (pret != PARSE_OK) {
+		PR_DEBUG("Cannot parse data in the file\n");
+		return HPCS_E_PARSE_ERROR;
+	}
+	raw->step = params.step;
+	raw->shift = params.shift;
+
+	pret = read_time_axis(&cursor, params.gentype, &raw->time, &mdata->sampling_rate);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	return HPCS_OK;
+}
+
+static enum HPCS_RetCode read_measurement_signal(struct HPCS_Cursor* cursor, struct HPCS_MeasuredData* mdata, const enum HPCS_GenType gentype)
+{
+	struct HPCS_SignalParams params;
+	enum HPCS_ParseCode pret;
+	enum HPCS_RetCode ret;
+
+	params.gentype = gentype;
+
+	/* Old data formats do not containg sampling rate information, set it manually */
+	if (OLD_FORMAT(params.gentype)) {
+		switch (mdata->file_type) {
+		case HPCS_TYPE_CE_DAD:
+			mdata->sampling_rate = 20.0;
+			break;
+		case HPCS_TYPE_CE_ANALOG:
+			mdata->sampling_rate = 10.0;
+			break;
+		default:
+			mdata->sampling_rate = CE_WORK_PARAM_SAMPRATE;
+		}
+	}
+
+	pret = read_signal_params(cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	pret = read_signal(cursor, &mdata->data, &mdata->data_count, &params, &mdata->arena);
+	if (pret != PARSE_OK) {
+		PR_DEBUG("Cannot parse data in the file\n");
+		ret = HPCS_E_PARSE_ERROR;
+	}
+	else
+		ret = HPCS_OK;
+
+	pret = read_timing(cursor, mdata->data, &mdata->sampling_rate, mdata->data_count,
+			   params.gentype == GENTYPE_GC_B);
+	if (pret != PARSE_OK)
+		ret = HPCS_E_PARSE_ERROR;
+
+	return ret;
+}
+
+static enum HPCS_RetCode read_measurement_values(struct HPCS_DataSource* src, struct HPCS_MeasuredData* mdata, struct HPCS_Signal* signal)
+{
+	struct HPCS_Cursor cursor;
+	struct HPCS_SignalParams params;
+	enum HPCS_ParseCode pret;
+	enum HPCS_RetCode ret;
+
+	cursor_init(&cursor, src);
+
+	ret = read_measurement_header(&cursor, mdata, &params.gentype, &mdata->arena);
+	if (ret != HPCS_OK)
+		return ret;
+
+	pret = read_signal_params(&cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	pret = read_signal_values(&cursor, &signal->values, &signal->time.count, &params);
+	if (pret != PARSE_OK) {
+		PR_DEBUG("Cannot parse data in the file\n");
+		return HPCS_E_PARSE_ERROR;
+	}
+
+	pret = read_time_axis(&cursor, params.gentype, &signal->time, &mdata->sampling_rate);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	return HPCS_OK;
+}
+
+/* Decodes the signal in pieces on multiple threads. 179 signal is split evenly. 30/130 signal is
+   scanned for jumps first. The value is absolute after a jump so a piece that begins right after
+   one does not depend on the samples before it. The values are the same as those decoded by
+   read_measurement_values(). */
+static enum HPCS_RetCode read_measurement_values_parallel(struct HPCS_DataSource* src, struct HPCS_MeasuredData* mdata, struct HPCS_Signal* signal, int threads)
+{
+	struct HPCS_Cursor cursor;
+	struct HPCS_SignalParams params;
+	struct HPCS_SignalDecoder decoder;
+	struct HPCS_CheckpointList checkpoints;
+	struct HPCS_ParallelDecode job;
+	size_t total;
+	size_t jumps;
+	size_t wanted;
+	size_t count;
+	size_t idx;
+	enum HPCS_ParseCode pret;
+	enum HPCS_RetCode ret = HPCS_OK;
+
+	if (threads < 1)
+		threads = cpu_count();
+	/* Buffered sources read through a single buffer, only sources in memory can be shared by the threads */
+	if (threads < 2 || (src->kind != SOURCE_MEMORY && src->kind != SOURCE_MAPPED))
+		return read_measurement_values(src, mdata, signal);
+
+	cursor_init(&cursor, src);
+
+	ret = read_measurement_header(&cursor, mdata, &params.gentype, &mdata->arena);
+	if (ret != HPCS_OK)
+		return ret;
+
+	pret = read_signal_params(&cursor, &params);
+	if (pret != PARSE_OK)
+		return HPCS_E_PARSE_ERROR;
+
+	checkpoints.items = NULL;
+	checkpoints.count = 0;
+	checkpoints.allocated = 0;
+	checkpoints.failed = false;
+	job.pieces = NULL;
+	signal->values = NULL;
+
+	pret = decoder_init(&decoder, &cursor, &params);
+	if (pret != PARSE_OK) {
+		ret = HPCS_E_PARSE_ERROR;
+		goto out;
+	}
+	if (params.gentype == GENTYPE_GC_B)
+		total = predict_sample_count(params.gentype, params.scans_start, src->file_size);
+	else {
+		decoder.checkpoints = &checkpoints;
+		pret = decoder_decode(&decoder, NULL, 0, (size_t)-1, &total);
+		if (pret != PARSE_OK) {
+			ret = HPCS_E_PARSE_ERROR;
+			goto out;
+		}
+	}
+
+	wanted = (size_t)threads * PIECES_PER_THREAD;
+	job.pieces = mem_alloc(sizeof(struct HPCS_SignalPiece) * wanted);
+	signal->values = mem_alloc(sizeof(double) * (total > 0 ? total : 1));
+	if (job.pieces == NULL || signal->values == NULL) {
+		ret = HPCS_E_PARSE_ERROR;
+		goto out;
+	}
+
+	/* 30/130 pieces begin after the first jump past an even split. The signal is decoded
+	   as a single piece if it has no jumps or if they could not be recorded. */
+	jumps = checkpoints.failed ? 0 : checkpoints.count;
+	job.pieces[0].first = 0;
+	count = 1;
+	for (idx = 1; idx < wanted; idx++) {
+		size_t first = (size_t)((uint64_t)total * idx / wanted);
+
+		if (params.gentype != GENTYPE_GC_B) {
+			size_t lo = 0;
+			size_t hi = jumps;
+
+			while (lo < hi) {
+				const size_t mid = lo + (hi - lo) / 2;
+				if (checkpoints.items[mid].sample_idx < first)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+			if (lo == jumps)
+				break;
+			first = checkpoints.items[lo].sample_idx;
+		}
+
+		if (first > job.pieces[count - 1].first && first < total)
+			job.pieces[count++].first = first;
+	}
+	for (idx = 0; idx < count; idx++)
+		job.pieces[idx].count = (idx + 1 < count ? job.pieces[idx + 1].first : total) - job.pieces[idx].first;
+
+	job.src = src;
+	job.params = &params;
+	job.checkpoints = checkpoints.failed ? NULL : &checkpoints;
+	job.values = signal->values;
+	if (parallel_for(parallel_decode_task, &job, count, threads) != PARSE_OK) {
+		ret = HPCS_E_PARSE_ERROR;
+		goto out;
+	}
+	for (idx = 0; idx < count; idx++) {
+		if (job.pieces[idx].pret != PARSE_OK) {
+			PR_DEBUG("Cannot parse data in the file\n");
+			ret = HPCS_E_PARSE_ERROR;
+			goto out;
+		}
+	}
+
+	signal->time.count = total;
+	pret = read_time_axis(&cursor, params.gentype, &signal->time, &mdata->sampling_rate);
+	if (pret != PARSE_OK)
+		ret = HPCS_E_PARSE_ERROR;
+
+out:
+	if (ret != HPCS_OK) {
+		mem_free(signal->values);
+		signal->values = NULL;
+	}
+	mem_free(job.pieces);
+	mem_free(checkpoints.items);
+	return ret;
+}
+
+/* Reads a method information file with a single read. The file is UTF-16 text of "name=value" lines.
+   All blocks are stored in one allocation which is followed by their hash index and their names and values in UTF-8. */
+static enum HPCS_ParseCode read_method_info_file(FILE* fh, struct HPCS_MethodInfo* minfo)
+{
+	struct HPCS_MethodInfoLine line;
+	struct HPCS_MethodInfoBlock* blocks;
+	struct HPCS_MethodIndex* index;
+	size_t slot_count = 1;
+	size_t text_size = 0;
+	size_t count = 0;
+	size_t units;
+	size_t first = 0;
+	size_t pos;
+	size_t idx;
+	char* text;
+	char* dst;
+	long size;
+
+	if (fseek(fh, 0, SEEK_END) != 0)
+		return PARSE_E_CANT_READ;
+	size = ftell(fh);
+	if (size < 0 || fseek(fh, 0, SEEK_SET) != 0)
+		return PARSE_E_CANT_READ;
+
+	text = mem_alloc(size > 0 ? (size_t)size : 1);
+	if (text == NULL)
+		return PARSE_E_NO_MEM;
+	if (fread(text, SMALL_SEGMENT_SIZE, (size_t)size, fh) != (size_t)size) {
+		mem_free(text);
+		return PARSE_E_CANT_READ;
+	}
+	units = (size_t)size / SEGMENT_SIZE;
+
+	/* Files without a byte order mark are taken as little-endian */
+	if (units > 0 && (unsigned char)text[0] == 0xFE && (unsigned char)text[1] == 0xFF) {
+		for (idx = 0; idx < units; idx++)
+			reverse_endianness(text + idx * SEGMENT_SIZE, SEGMENT_SIZE);
+	}
+	if (units > 0 && (unsigned char)text[0] == 0xFF && (unsigned char)text[1] == 0xFE)
+		first = 1;
+
+	pos = first;
+	while (method_info_line(text, units, &pos, &line)) {
+		text_size += utf16le_put(NULL, text + line.name * SEGMENT_SIZE, line.name_length) + 1;
+		text_size += utf16le_put(NULL, text + line.value * SEGMENT_SIZE, line.value_length) + 1;
+		count++;
+	}
+
+	minfo->blocks = NULL;
+	minfo->count = 0;
+	minfo->index = NULL;
+	if (count == 0) {
+		mem_free(text);
+		return PARSE_OK;
+	}
+
+	/* The hash table is kept at most half full */
+	while (slot_count < 2 * count)
+		slot_count *= 2;
+
+	blocks = mem_alloc(count * sizeof(struct HPCS_MethodInfoBlock) + sizeof(struct HPCS_MethodIndex) + slot_count * sizeof(size_t) + text_size);
+	if (blocks == NULL) {
+		mem_free(text);
+		return PARSE_E_NO_MEM;
+	}
+	index = (struct HPCS_MethodIndex*)(blocks + count);
+	index->mask = slot_count - 1;
+	index->slots = (size_t*)(index + 1);
+
+	dst = (char*)(index->slots + slot_count);
+	pos = first;
+	for (idx = 0; idx < count; idx++) {
+		method_info_line(text, units, &pos, &line);
+
+		blocks[idx].name = dst;
+		dst += utf16le_put(dst, text + line.name * SEGMENT_SIZE, line.name_length);
+		*dst++ = '\0';
+		blocks[idx].value = dst;
+		dst += utf16le_put(dst, text + line.value * SEGMENT_SIZE, line.value_length);
+		*dst++ = '\0';
+	}
+	mem_free(text);
+	method_index_build(index, blocks, count);
+
+	minfo->blocks = blocks;
+	minfo->count = count;
+	minfo->index = index;
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode read_generic_type(struct HPCS_Cursor* cursor, enum HPCS_GenType* gentype)
+{
+	enum HPCS_ParseCode ret;
+	uint8_t len;
+	char gentype_str[UCHAR_MAX + 1];
+
+	ret = cursor_read_at(cursor, DATA_OFFSET_GENTYPE, &len, SMALL_SEGMENT_SIZE);
+	if (ret != PARSE_OK)
+		return ret;
+
+	ret = cursor_read_at(cursor, DATA_OFFSET_GENTYPE + SMALL_SEGMENT_SIZE, gentype_str, len);
+	if (ret != PARSE_OK)
+		return ret;
+
+	gentype_str[len] = '\0';
+
+	PR_DEBUGF("Generic type: %s\n", gentype_str);
+
+	*gentype = strtol(gentype_str, NULL, 10);
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode read_scans_start(struct HPCS_Cursor* cursor, size_t *scans_start)
+{
+	enum HPCS_ParseCode pret;
+	int32_t _start;
+
+	pret = cursor_read_at(cursor, DATA_SCANS_START, &_start, LARGE_SEGMENT_SIZE);
+	if (pret != PARSE_OK)
+		return pret;
+
+	be_to_cpu_val(_start);
+	if (_start < 1)
+		return PARSE_E_OUT_OF_RANGE;
+
+	*scans_start = ((size_t)_start - 1) * 512;
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode read_signal(struct HPCS_Cursor* cursor, struct HPCS_TVPair** pairs, size_t* pairs_count,
+				       const struct HPCS_SignalParams* params, struct HPCS_Arena** arena)
+{
+	struct HPCS_SignalDecoder decoder;
+	size_t alloc_size;
+	size_t count = 0;
+	enum HPCS_ParseCode pret;
+	const bool in_arena = arena != NULL && *arena != NULL;
+
+	pret = decoder_init(&decoder, cursor, params);
+	if (pret != PARSE_OK)
+		return pret;
+
+	/* The prediction is an upper bound, the storage is expanded only if the file lies about its size */
+	alloc_size = predict_sample_count(params->gentype, params->scans_start, cursor->src->file_size);
+	if (alloc_size == 0)
+		alloc_size = 1;
+
+	*pairs = arena_alloc(arena, sizeof(struct HPCS_TVPair) * alloc_size);
+	if (*pairs == NULL)
+		return PARSE_E_NO_MEM;
+
+	while (!decoder.finished) {
+		size_t decoded;
+
+		/* Expand storage if there is more data than we can store */
+		if (alloc_size == count) {
+			if (in_arena) {
+				/* The storage cannot grow in place, the old one stays in the arena unused */
+				struct HPCS_TVPair* nptr = arena_alloc(arena, sizeof(struct HPCS_TVPair) * alloc_size * 2);
+
+				if (nptr == NULL) {
+					*pairs = NULL;
+					return PARSE_E_NO_MEM;
+				}
+				memcpy(nptr, *pairs, sizeof(struct HPCS_TVPair) * count);
+				*pairs = nptr;
+				alloc_size *= 2;
+			} else if (expand_storage(pairs, &alloc_size) == PARSE_E_NO_MEM)
+				return PARSE_E_NO_MEM;
+		}
+
+		pret = decoder_decode(&decoder, &(*pairs)[count].value, sizeof(struct HPCS_TVPair), alloc_size - count, &decoded);
+		if (pret != PARSE_OK) {
+			arena_free(arena, *pairs);
+			*pairs = NULL;
+			return pret;
+		}
+		count += decoded;
+	}
+
+	/* Give back the memory reserved for markers and jumps */
+	if (!in_arena)
+		*pairs = shrink_array(*pairs, alloc_size, count, sizeof(struct HPCS_TVPair));
+
+	*pairs_count = count;
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode read_signal_counts(struct HPCS_Cursor* cursor, int32_t** counts, size_t* counts_count,
+					      const struct HPCS_SignalParams* params)
+{
+	struct HPCS_SignalDecoder decoder;
+	size_t alloc_size;
+	size_t count = 0;
+	enum HPCS_ParseCode pret;
+
+	pret = decoder_init(&decoder, cursor, params);
+	if (pret != PARSE_OK)
+		return pret;
+
+	alloc_size = predict_sample_count(params->gentype, params->scans_start, cursor->src->file_size);
+	if (alloc_size == 0)
+		alloc_size = 1;
+
+	*counts = mem_alloc(sizeof(int32_t) * alloc_size);
+	if (*counts == NULL)
+		return PARSE_E_NO_MEM;
+
+	while (!decoder.finished) {
+		size_t decoded;
+
+		if (alloc_size == count) {
+			int32_t* nptr = grow_array(*counts, &alloc_size, count + 1, sizeof(int32_t));
+			if (nptr == NULL) {
+				mem_free(*counts);
+				*counts = NULL;
+				return PARSE_E_NO_MEM;
+			}
+			*counts = nptr;
+		}
+
+		pret = decode_counts_30_130(&decoder, *counts + count, alloc_size - count, &decoded);
+		if (pret != PARSE_OK) {
+			mem_free(*counts);
+			*counts = NULL;
+			return pret;
+		}
+		count += decoded;
+	}
+
+	*counts = shrink_array(*counts, alloc_size, count, sizeof(int32_t));
+
+	*counts_count = count;
+	return PARSE_OK;
+}
+
+/* Samples are decoded in small blocks of doubles that stay in cache and are narrowed
+   right away, the full array of doubles never exists */
+static enum HPCS_ParseCode read_signal_float(struct HPCS_Cursor* cursor, float** values, size_t* values_count, const struct HPCS_SignalParams* params)
+{
+	struct HPCS_SignalDecoder decoder;
+	double block[NARROW_BLOCK_SIZE];
+	size_t alloc_size;
+	size_t count = 0;
+	enum HPCS_ParseCode pret;
+
+	pret = decoder_init(&decoder, cursor, params);
+	if (pret != PARSE_OK)
+		return pret;
+
+	alloc_size = predict_sample_count(params->gentype, params->scans_start, cursor->src->file_size);
+	if (alloc_size == 0)
+		alloc_size = 1;
+
+	*values = mem_alloc(sizeof(float) * alloc_size);
+	if (*values == NULL)
+		return PARSE_E_NO_MEM;
+
+	while (!decoder.finished) {
+		size_t capacity;
+		size_t decoded;
+		size_t idx;
+
+		if (alloc_size == count) {
+			float* nptr = grow_array(*values, &alloc_size, count + 1, sizeof(float));
+			if (nptr == NULL) {
+				mem_free(*values);
+				*values = NULL;
+				return PARSE_E_NO_MEM;
+			}
+			*values = nptr;
+		}
+
+		capacity = alloc_size - count;
+		if (capacity > NARROW_BLOCK_SIZE)
+			capacity = NARROW_BLOCK_SIZE;
+
+		pret = decoder_decode(&decoder, block, sizeof(double), capacity, &decoded);
+		if (pret != PARSE_OK) {
+			mem_free(*values);
+			*values = NULL;
+			return pret;
+		}
+
+		for (idx = 0; idx < decoded; idx++)
+			(*values)[count + idx] = (float)block[idx];
+		count += decoded;
+	}
+
+	*values = shrink_array(*values, alloc_size, count, sizeof(float));
+
+	*values_count = count;
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode read_signal_params(struct HPCS_Cursor* cursor, struct HPCS_SignalParams* params)
+{
+	enum HPCS_ParseCode pret;
+
+	pret = fetch_signal_step(cursor, &params->step, &params->shift, OLD_FORMAT(params->gentype));
+	if (pret != PARSE_OK) {
+		PR_DEBUG("Cannot read signal step and shift\n");
+		return pret;
+	}
+	PR_DEBUGF("Signal step: %g, shift: %g\n", params->step, params->shift);
+
+	pret = read_scans_start(cursor, &params->scans_start);
+	if (pret != PARSE_OK) {
+		PR_DEBUG("Cannot read scans start offset\n");
+		return pret;
+	}
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode read_signal_values(struct HPCS_Cursor* cursor, double** values, size_t* values_count, const struct HPCS_SignalParams* params)
+{
+	struct HPCS_SignalDecoder decoder;
+	size_t alloc_size;
+	size_t count = 0;
+	enum HPCS_ParseCode pret;
+
+	pret = decoder_init(&decoder, cursor, params);
+	if (pret != PARSE_OK)
+		return pret;
+
+	alloc_size = predict_sample_count(params->gentype, params->scans_start, cursor->src->file_size);
+	if (alloc_size == 0)
+		alloc_size = 1;
+
+	*values = mem_alloc(sizeof(double) * alloc_size);
+	if (*values == NULL)
+		return PARSE_E_NO_MEM;
+
+	while (!decoder.finished) {
+		size_t decoded;
+
+		if (alloc_size == count) {
+			double* nptr = grow_array(*values, &alloc_size, count + 1, sizeof(double));
+			if (nptr == NULL) {
+				mem_free(*values);
+				*values = NULL;
+				return PARSE_E_NO_MEM;
+			}
+			*values = nptr;
+		}
+
+		pret = decoder_decode(&decoder, *values + count, sizeof(double), alloc_size - count, &decoded);
+		if (pret != PARSE_OK) {
+			mem_free(*values);
+			*values = NULL;
+			return pret;
+		}
+		count += decoded;
+	}
+
+	*values = shrink_array(*values, alloc_size, count, sizeof(double));
+
+	*values_count = count;
+	return PARSE_OK;
+}
+
+/* Describes the times of axis->count samples */
+static enum HPCS_ParseCode read_time_axis(struct HPCS_Cursor* cursor, const enum HPCS_GenType gentype, struct HPCS_TimeAxis* axis, double* sampling_rate)
+{
+	double xmin;
+	double xmax;
+	enum HPCS_ParseCode pret;
+
+	pret = read_time_range(cursor, &xmin, &xmax, gentype == GENTYPE_GC_B);
+	if (pret != PARSE_OK)
+		return pret;
+
+	axis->t0 = xmin;
+	axis->dt = (xmax - xmin) / axis->count;
+	*sampling_rate = 1.0 / (axis->dt * 60.0);
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode read_time_range(struct HPCS_Cursor* cursor, double* xmin_minutes, double* xmax_minutes, const bool is_type_179)
+{
+	assert(sizeof(int32_t) == sizeof(float));
+
+	union { int32_t i; float f; } xmin;
+	union { int32_t i; float f; } xmax;
+	enum HPCS_ParseCode pret;
+
+	pret = cursor_read_at(cursor, DATA_OFFSET_XMIN, &xmin, LARGE_SEGMENT_SIZE);
+	if (pret != PARSE_OK)
+		return pret;
+	pret = cursor_read_at(cursor, DATA_OFFSEt_XMAX, &xmax, LARGE_SEGMENT_SIZE);
+	if (pret != PARSE_OK)
+		return pret;
+
+	be_to_cpu_val(xmin.i);
+	be_to_cpu_val(xmax.i);
+
+	if (is_type_179) {
+		*xmin_minutes = xmin.f / 60000.0f;
+		*xmax_minutes = xmax.f / 60000.0f;
+	} else {
+		*xmin_minutes = (double)xmin.i / 60000.0;
+		*xmax_minutes = (double)xmax.i / 60000.0;
+	}
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode read_timing(struct HPCS_Cursor* cursor, struct HPCS_TVPair*const pairs, double *sampling_rate, const size_t data_count, const bool is_type_179)
+{
+	double xminf;
+	double xmaxf;
+	double time_step;
+	double t;
+	size_t idx;
+	enum HPCS_ParseCode pret;
+
+	pret = read_time_range(cursor, &xminf, &xmaxf, is_type_179);
+	if (pret != PARSE_OK)
+		return pret;
+
+	time_step = (xmaxf - xminf) / data_count;
+	*sampling_rate = 1.0 / (time_step * 60.0);
+
+	t = xminf;
+	for (idx = 0; idx < data_count; idx++) {
+		pairs[idx].time = t;
+		t += time_step;
+	}
+
+	return PARSE_OK;
+}
+
+static enum HPCS_ParseCode read_string_at_offset(struct HPCS_Cursor* cursor, const HPCS_offset offset, char** const result, const bool old_format,
+						   struct HPCS_Arena** arena)
+{
+	if (old_format)
+		return __read_string_at_offset_v1(cursor, offset, result, arena);
+	return __read_string_at_offset_v2(cursor, offset, result, arena);
+}
+
+static enum HPCS_ParseCode __read_string_at_offset_v1(struct HPCS_Cursor* cursor, const HPCS_offset offset, char** const result, struct HPCS_Arena** arena)
+{
+	const char* string;
+	size_t str_length;
+	enum HPCS_ParseCode ret;
+
+	PR_DEBUG("Using v1 string read\n");
+
+	ret = cursor_seek(cursor, offset);
+	if (ret != PARSE_OK)
+		return ret;
+
+	ret = cursor_read_cstring(cursor, &string, &str_length);
+	if (ret != PARSE_OK)
+		return ret;
+
+	PR_DEBUGF("String length to read: %lu\n", str_length);
+
+	return latin1_to_utf8(result, string, str_length, arena);
+}
+
+static enum HPCS_ParseCode __read_string_at_offset_v2(struct HPCS_Cursor* cursor, const HPCS_offset offset, char** const result, struct HPCS_Arena** arena)
+{
+	const char* string;
+	uint8_t str_length;
+	enum HPCS_ParseCode ret;
+
+	PR_DEBUG("Using v2 string read\n");
+
+	ret = cursor_read_at(cursor, offset, &str_length, SMALL_SEGMENT_SIZE);
+	if (ret != PARSE_OK)
+		return ret;
+
+	PR_DEBUGF("String length to read: %u\n", str_length);
+
+	ret = cursor_require(cursor, str_length * SEGMENT_SIZE);
+	if (ret != PARSE_OK)
+		return ret == PARSE_W_NO_DATA ? PARSE_E_CANT_READ : ret;
+	string = cursor->view + cursor->pos;
+	cursor->pos += str_length * SEGMENT_SIZE;
+
+	/* String is stored as UTF-16LE (native Windows WCHAR) */
+	return utf16le_to_utf8(result, string, str_length, arena);
+}
+
+/* Allocator of the storage of the reader, NULL for the global one */
+static const struct HPCS_Allocator* reader_allocator(const struct HPCS_Reader* reader)
+{
+	return reader->has_allocator ? &reader->allocator : NULL;
+}
+
+static struct HPCS_Arena* reader_first_chunk(struct HPCS_Reader* reader)
+{
+	return (struct HPCS_Arena*)((char*)reader + arena_round(sizeof(struct HPCS_Reader)));
+}
+
+/* Same as open_data_source(), a stdio source uses the buffer of the reader */
+static enum HPCS_ParseCode reader_open_source(struct HPCS_Reader* reader, const char* filename, struct HPCS_DataSource* src)
+{
+	FILE* fh;
+
+	src->memory = NULL;
+	src->fh = NULL;
+	src->size = 0;
+	src->buffer = NULL;
 
-	/* Read REFERENCE wavelength */
-	start_idx = strstr(end_idx, WAVELENGTH_REFERENCE_TEXT);
-	if (start_idx == NULL) {
-		PR_DEBUG("No reference wavelength data\n");
-		ret = PARSE_W_NO_DATA;
-		goto out2;
-	}
-	start_idx += strlen(WAVELENGTH_REFERENCE_TEXT);
-	interv_idx = strchr(start_idx, WAVELENGTH_DELIMITER_TEXT);
-	if (interv_idx == NULL) {
-		/* Is the reference wavelength disabled? */
-		if (strcmp(start_idx, WAVELENGTH_REFERENCE_OFF_TEXT) == 0) {
-			ret = PARSE_OK;
-			goto out2;
+	if (io_backend == HPCS_IO_AUTO) {
+		if (map_measurement_file(filename, src)) {
+			src->kind = SOURCE_MAPPED;
+			src->file_size = src->size;
+			return PARSE_OK;
 		}
-		PR_DEBUG("No reference spectral interval but reference wavelength is not 'off'\n");
-		ret = PARSE_E_NOT_FOUND;
-		goto out2;
+		PR_DEBUG("Cannot map file, falling back to stdio\n");
 	}
 
-	if (start_idx >= interv_idx) {
-		PR_DEBUG("start_idx >= interv_idx\n");
-		ret = PARSE_E_CANT_READ;
-		goto out2;
+	if (reader->buffer == NULL) {
+		reader->buffer = allocator_alloc(reader_allocator(reader), SOURCE_BUFFER_SIZE);
+		if (reader->buffer == NULL)
+			return PARSE_E_NO_MEM;
 	}
 
-	tmp_len = interv_idx - start_idx;
-	if (tmp_len > len + 1) {
-		free(temp);
-		temp = malloc(interv_idx - start_idx + 1);
-		if (temp == NULL) {
-			PR_DEBUG("No memory for temporary string\n");
-			ret = PARSE_E_NO_MEM;
-			goto out;
-		}
-	}
-	len = interv_idx - start_idx;
-	memcpy(temp, start_idx, len);
-	temp[len] = 0;
-	reference->wavelength = (uint16_t)strtoul(temp, NULL, 10);
-	reference->interval = (uint16_t)strtoul(interv_idx + 1, NULL, 10);
-	ret = PARSE_OK;
+	fh = open_measurement_file(filename);
+	if (fh == NULL)
+		return PARSE_E_CANT_READ;
 
-out2:
-	free(temp);
-out:
-	free(str);
-	return ret;
+	src->buffer = reader->buffer;
+	return open_stdio_source(fh, src);
 }
 
-/* This function assumes that the date information are composed only of the
-   first 127 characters from ISO-8859-1 charset. Under such assumption it is
-   possible to treat UTF-8 strings as single-byte strings with ISO-8859-1
-   encoding */
-static enum HPCS_ParseCode read_date(FILE* datafile, struct HPCS_Date* date, const enum HPCS_GenType gentype)
+static enum HPCS_ParseCode run_add_file(struct HPCS_RunScan* scan, struct HPCS_Run* run, const size_t dir_idx, const size_t idx, const size_t name_offset,
+				       const bool is_method)
 {
-	char* date_str;
-	char* date_time_delim;
-	char* dm_delim, *my_delim;
-	char* hm_delim, *ms_delim;
-	char temp[32];
-	size_t len;
-	enum HPCS_ParseCode pret;
-	const HPCS_offset date_offset = OLD_FORMAT(gentype) ? DATA_OFFSET_DATE_OLD : DATA_OFFSET_DATE;
+	struct HPCS_RunFile* nptr;
 
-	pret = read_string_at_offset(datafile, date_offset, &date_str, OLD_FORMAT(gentype));
-	if (pret != PARSE_OK)
-		return pret;
+	nptr = grow_array(scan->files, &scan->files_allocated, scan->file_count + 1, sizeof(struct HPCS_RunFile));
+	if (nptr == NULL)
+		return PARSE_E_NO_MEM;
+	scan->files = nptr;
 
-	/* Find date / time delimiter */
-	date_time_delim = strchr(date_str, DATA_FILE_COMMA);
-	if (date_time_delim == NULL) {
-		free(date_str);
-		return PARSE_E_NOT_FOUND;
-	}
+	nptr[scan->file_count].dir = dir_idx;
+	nptr[scan->file_count].run = run;
+	nptr[scan->file_count].idx = idx;
+	nptr[scan->file_count].name_offset = name_offset;
+	nptr[scan->file_count].is_method = is_method;
+	scan->file_count++;
 
-	/* Get day */
-	dm_delim = strchr(date_str, DATA_FILE_DASH);
-	if (dm_delim == NULL) {
-		free(date_str);
-		return PARSE_E_NOT_FOUND;
-	}
-	len = dm_delim - date_str;
-	memcpy(temp, date_str, len);
-	temp[len] = 0;
-	date->day = (uint8_t)strtoul(temp, NULL, 10);
+	return PARSE_OK;
+}
 
-	/* Get month */
-	my_delim = strchr(dm_delim + 1, DATA_FILE_DASH);
-	if (dm_delim == NULL) {
-		free(date_str);
-		return PARSE_E_NOT_FOUND;
+/* Adds a method file of a run. If prefix is given, the file is located in the method directory of that name. */
+static enum HPCS_ParseCode run_add_method(struct HPCS_RunScan* scan, struct HPCS_Run* run, const size_t dir_idx, const char* prefix, const char* name,
+					 size_t* allocated)
+{
+	struct HPCS_RunMethod* nptr;
+	struct HPCS_RunMethod* method;
+
+	nptr = grow_array(run->methods, allocated, run->method_count + 1, sizeof(struct HPCS_RunMethod));
+	if (nptr == NULL)
+		return PARSE_E_NO_MEM;
+	run->methods = nptr;
+
+	method = &run->methods[run->method_count];
+	method->name = prefix == NULL ? duplicate_string(name) : join_path(prefix, name);
+	method->minfo = hpcs_alloc_minfo();
+	method->code = HPCS_E_CANT_OPEN;
+	if (method->name == NULL || method->minfo == NULL) {
+		mem_free(method->name);
+		hpcs_free_minfo(method->minfo);
+		return PARSE_E_NO_MEM;
 	}
-	len = my_delim - (dm_delim + 1);
-	memcpy(temp, dm_delim + 1, len);
-	temp[len] = 0;
-	date->month = month_to_number(temp);
+	run->method_count++;
 
-	/* Get year */
-	len = date_time_delim - (my_delim + 1);
-	memcpy(temp, my_delim + 1, len);
-	temp[len] = 0;
-	date->year = strtoul(temp, NULL, 10);
-	if (date->year < 90) /* Y2K workaround */
-		date->year += 2000;
+	return run_add_file(scan, run, dir_idx, run->method_count - 1, strlen(method->name) - strlen(name), true);
+}
 
-	/* Get hour */
-	hm_delim = strchr(date_time_delim + 1, DATA_FILE_COLON);
-	if (hm_delim == NULL) {
-		free(date_str);
-		return PARSE_E_NOT_FOUND;
+static enum HPCS_ParseCode run_add_trace(struct HPCS_RunScan* scan, struct HPCS_Run* run, const size_t dir_idx, const char* name, size_t* allocated)
+{
+	struct HPCS_RunTrace* nptr;
+	struct HPCS_RunTrace* trace;
+
+	nptr = grow_array(run->traces, allocated, run->trace_count + 1, sizeof(struct HPCS_RunTrace));
+	if (nptr == NULL)
+		return PARSE_E_NO_MEM;
+	run->traces = nptr;
+
+	trace = &run->traces[run->trace_count];
+	trace->name = duplicate_string(name);
+	trace->file_type = HPCS_TYPE_UNKNOWN;
+	trace->mdata = hpcs_alloc_mdata_arena();
+	trace->code = HPCS_E_CANT_OPEN;
+	if (trace->name == NULL || trace->mdata == NULL) {
+		mem_free(trace->name);
+		hpcs_free_mdata(trace->mdata);
+		return PARSE_E_NO_MEM;
 	}
-	len = hm_delim - (date_time_delim + 1);
-	memcpy(temp, date_time_delim + 1, len);
-	temp[len] = 0;
-	date->hour = (uint8_t)strtoul(temp, NULL, 10);
+	run->trace_count++;
 
-	/* Get minute */
-	ms_delim = strchr(hm_delim + 1, DATA_FILE_COLON);
-	if (ms_delim == NULL) {
-		free(date_str);
-		return PARSE_E_NOT_FOUND;
+	return run_add_file(scan, run, dir_idx, run->trace_count - 1, 0, false);
+}
+
+static struct HPCS_Run* run_alloc(const char* path)
+{
+	struct HPCS_Run* run = mem_calloc(1, sizeof(struct HPCS_Run));
+	if (run == NULL)
+		return NULL;
+
+	run->path = duplicate_string(path);
+	if (run->path == NULL) {
+		mem_free(run);
+		return NULL;
 	}
-	len = ms_delim - (hm_delim + 1);
-	memcpy(temp, hm_delim + 1, len);
-	temp[len] = 0;
-	date->minute = (uint8_t)strtoul(temp, NULL, 10);
 
-	/* Get second */
-	date->second = (uint8_t)strtoul(ms_delim + 1, NULL, 10);
+	return run;
+}
 
-	free(date_str);
-	return PARSE_OK;
+/* Reads all scanned files and closes the directories they were opened from */
+static enum HPCS_ParseCode run_load(struct HPCS_RunScan* scan, int threads)
+{
+	enum HPCS_ParseCode pret;
+	size_t idx;
+
+	pret = parallel_for(run_load_task, scan, scan->file_count, threads);
+
+	for (idx = 0; idx < scan->dir_count; idx++)
+		dir_close(&scan->dirs[idx]);
+	scan->dir_count = 0;
+	scan->file_count = 0;
+
+	return pret;
 }
 
-static enum HPCS_ParseCode read_file_header(FILE* datafile, enum HPCS_ChemStationVer* cs_ver, struct HPCS_MeasuredData* mdata, const enum HPCS_GenType gentype)
+static void run_load_task(void* ctx, const size_t idx)
+{
+	struct HPCS_RunScan* scan = ctx;
+	const struct HPCS_RunFile* file = &scan->files[idx];
+	const struct HPCS_RunDir* dir = &scan->dirs[file->dir];
+
+	if (file->is_method) {
+		struct HPCS_RunMethod* method = &file->run->methods[file->idx];
+		run_read_method(dir, method->name + file->name_offset, method);
+	} else {
+		struct HPCS_RunTrace* trace = &file->run->traces[file->idx];
+		run_read_trace(dir, trace->name + file->name_offset, trace);
+	}
+}
+
+static void run_read_method(const struct HPCS_RunDir* dir, const char* name, struct HPCS_RunMethod* method)
 {
 	enum HPCS_ParseCode pret;
-	const bool old_format = OLD_FORMAT(gentype);
-	const HPCS_offset sample_info_offset = old_format ? DATA_OFFSET_SAMPLE_INFO_OLD : DATA_OFFSET_SAMPLE_INFO;
-	const HPCS_offset operator_name_offset = old_format ? DATA_OFFSET_OPERATOR_NAME_OLD : DATA_OFFSET_OPERATOR_NAME;
-	const HPCS_offset method_name_offset = old_format ? DATA_OFFSET_METHOD_NAME_OLD : DATA_OFFSET_METHOD_NAME;
-	const HPCS_offset y_units_offset = old_format ? DATA_OFFSET_Y_UNITS_OLD : DATA_OFFSET_Y_UNITS;
+	FILE* fh;
 
-	pret = read_string_at_offset(datafile, sample_info_offset, &mdata->sample_info, old_format);
-	if (pret != PARSE_OK) {
-	    PR_DEBUGF("%s%d\n", "Cannot read sample info, errno: ", pret);
-	    return pret;
+	fh = open_measurement_file_at(dir, name);
+	if (fh == NULL) {
+		method->code = HPCS_E_CANT_OPEN;
+		return;
 	}
-	pret = read_string_at_offset(datafile, operator_name_offset, &mdata->operator_name, old_format);
-	if (pret != PARSE_OK) {
-	    PR_DEBUGF("%s%d\n", "Cannot read operator name, errno: ", pret);
-	    return pret;
+
+	pret = read_method_info_file(fh, method->minfo);
+	fclose(fh);
+	method->code = pret == PARSE_OK ? HPCS_OK : HPCS_E_PARSE_ERROR;
+}
+
+/* Probes the header of a data file with a single read and loads the signal only if the header is readable */
+static void run_read_trace(const struct HPCS_RunDir* dir, const char* name, struct HPCS_RunTrace* trace)
+{
+	struct HPCS_DataSource src;
+	struct HPCS_Cursor cursor;
+	enum HPCS_GenType gentype;
+	enum HPCS_ParseCode pret;
+	FILE* fh;
+
+	fh = open_measurement_file_at(dir, name);
+	if (fh == NULL) {
+		trace->code = HPCS_E_CANT_OPEN;
+		return;
 	}
-	pret = read_string_at_offset(datafile, method_name_offset, &mdata->method_name, old_format);
+
+	pret = open_header_block(fh, &src);
 	if (pret != PARSE_OK) {
-	    PR_DEBUGF("%s%d\n", "Cannot read method name, errno: ", pret);
-	    return pret;
+		fclose(fh);
+		trace->code = pret == PARSE_E_NO_MEM ? HPCS_E_PARSE_ERROR : HPCS_E_CANT_OPEN;
+		return;
 	}
-	pret = read_date(datafile, &mdata->date, gentype);
-	if (pret != PARSE_OK) {
-	    PR_DEBUGF("%s%d\n", "Cannot read date of measurement, errno: ", pret);
-	    return pret;
+
+	cursor_init(&cursor, &src);
+	trace->code = read_measurement_header(&cursor, trace->mdata, &gentype, &trace->mdata->arena);
+	close_data_source(&src);
+	if (trace->code != HPCS_OK) {
+		fclose(fh);
+		return;
 	}
+	trace->file_type = trace->mdata->file_type;
 
-	if (!old_format) {
-		pret = read_string_at_offset(datafile, DATA_OFFSET_CS_VER, &mdata->cs_ver, old_format);
-		if (pret != PARSE_OK) {
-			PR_DEBUGF("%s%d\n", "Cannot read ChemStation software version, errno: ", pret);
-			return pret;
-		}
-		pret = read_string_at_offset(datafile, DATA_OFFSET_CS_REV, &mdata->cs_rev, old_format);
-			if (pret != PARSE_OK) {
-			PR_DEBUGF("%s%d\n", "Cannot read ChemStation software revision, errno: ", pret);
-			return pret;
-		}
-	} else {
-		mdata->cs_ver = DEFAULT_CS_VER;
-		mdata->cs_rev = DEFAULT_CS_REV;
+	if (open_file_source(fh, &src) != PARSE_OK) {
+		trace->code = HPCS_E_CANT_OPEN;
+		return;
 	}
 
-	pret = read_string_at_offset(datafile, y_units_offset, &mdata->y_units, old_format);
-	if (pret != PARSE_OK) {
-		PR_DEBUGF("%s%d\n", "Cannot read values of Y axis, errno: ", pret);
+	cursor_init(&cursor, &src);
+	trace->code = read_measurement_signal(&cursor, trace->mdata, gentype);
+
+	close_data_source(&src);
+}
+
+/* Schedules the data and method files of a run directory for loading */
+static enum HPCS_ParseCode run_scan(struct HPCS_RunScan* scan, const size_t dir_idx, struct HPCS_Run* run)
+{
+	struct HPCS_DirEntry* entries;
+	enum HPCS_ParseCode pret;
+	size_t traces_allocated = 0;
+	size_t methods_allocated = 0;
+	size_t count;
+	size_t idx;
+
+	pret = dir_list(&scan->dirs[dir_idx], &entries, &count);
+	if (pret != PARSE_OK)
 		return pret;
+
+	for (idx = 0; idx < count && pret == PARSE_OK; idx++) {
+		const struct HPCS_DirEntry* entry = &entries[idx];
+
+		if (entry->kind == DIRENT_FILE && has_extension(entry->name, RUN_TRACE_EXT))
+			pret = run_add_trace(scan, run, dir_idx, entry->name, &traces_allocated);
+		else if (entry->kind == DIRENT_FILE && has_extension(entry->name, RUN_METHOD_EXT))
+			pret = run_add_method(scan, run, dir_idx, NULL, entry->name, &methods_allocated);
+		else if (entry->kind == DIRENT_DIR && has_extension(entry->name, RUN_METHOD_DIR_EXT))
+			pret = run_scan_method_dir(scan, run, dir_idx, entry->name, &methods_allocated);
 	}
 
-	*cs_ver = detect_chemstation_version(mdata->cs_ver);
-	if (pret != PARSE_OK) {
-		PR_DEBUGF("%s%d\n", "Cannot detect ChemStation version, errno: ", pret);
+	dir_entries_free(entries, count);
+	return pret;
+}
+
+static void run_scan_free(struct HPCS_RunScan* scan)
+{
+	size_t idx;
+
+	for (idx = 0; idx < scan->dir_count; idx++)
+		dir_close(&scan->dirs[idx]);
+	mem_free(scan->dirs);
+	mem_free(scan->files);
+}
+
+/* Schedules the method files of a method directory. A method directory that cannot be opened is skipped. */
+static enum HPCS_ParseCode run_scan_method_dir(struct HPCS_RunScan* scan, struct HPCS_Run* run, const size_t dir_idx, const char* name,
+					      size_t* allocated)
+{
+	struct HPCS_DirEntry* entries;
+	enum HPCS_ParseCode pret;
+	size_t method_dir_idx;
+	size_t count;
+	size_t idx;
+
+	pret = run_scan_open_dir(scan, &scan->dirs[dir_idx], name, &method_dir_idx);
+	if (pret == PARSE_E_CANT_READ)
+		return PARSE_OK;
+	else if (pret != PARSE_OK)
 		return pret;
-	}
 
-	pret = autodetect_file_type(datafile, &mdata->file_type, p_means_pressure(*cs_ver), gentype);
-	if (pret != PARSE_OK) {
-	    PR_DEBUGF("%s%d\n", "Cannot determine the type of file, errno: ", pret);
-	    return pret;
+	pret = dir_list(&scan->dirs[method_dir_idx], &entries, &count);
+	if (pret != PARSE_OK)
+		return pret == PARSE_E_CANT_READ ? PARSE_OK : pret;
+
+	for (idx = 0; idx < count && pret == PARSE_OK; idx++) {
+		if (entries[idx].kind == DIRENT_FILE && has_extension(entries[idx].name, RUN_METHOD_EXT))
+			pret = run_add_method(scan, run, method_dir_idx, name, entries[idx].name, allocated);
 	}
 
-	if (mdata->file_type == HPCS_TYPE_CE_DAD) {
-	    pret = read_dad_wavelength(datafile, &mdata->dad_wavelength_msr, &mdata->dad_wavelength_ref, gentype);
-	    if (pret != PARSE_OK && pret != PARSE_W_NO_DATA) {
-			PR_DEBUGF("%s%d\n", "Cannot read wavelength, errno: ", pret);
+	dir_entries_free(entries, count);
+	return pret;
+}
+
+/* Opens a directory and keeps it open until the scanned files are loaded */
+static enum HPCS_ParseCode run_scan_open_dir(struct HPCS_RunScan* scan, const struct HPCS_RunDir* parent, const char* name, size_t* dir_idx)
+{
+	struct HPCS_RunDir parent_dir;
+	struct HPCS_RunDir* nptr;
+
+	/* Parent may point to the array that is about to be reallocated */
+	if (parent != NULL)
+		parent_dir = *parent;
+
+	nptr = grow_array(scan->dirs, &scan->dirs_allocated, scan->dir_count + 1, sizeof(struct HPCS_RunDir));
+	if (nptr == NULL)
+		return PARSE_E_NO_MEM;
+	scan->dirs = nptr;
+
+	if (!dir_open(parent == NULL ? NULL : &parent_dir, name, &scan->dirs[scan->dir_count]))
+		return PARSE_E_CANT_READ;
+
+	*dir_idx = scan->dir_count++;
+	return PARSE_OK;
+}
+
+/* Scans a run found by hpcs_read_run_tree(). Scanned runs are loaded in batches. */
+static enum HPCS_ParseCode run_tree_add(struct HPCS_RunTree* tree, const struct HPCS_RunDir* dir, const char* name)
+{
+	struct HPCS_Run** nptr;
+	struct HPCS_Run* run;
+	enum HPCS_ParseCode pret;
+	size_t dir_idx;
+
+	nptr = grow_array(tree->runs, &tree->allocated, tree->count + 1, sizeof(struct HPCS_Run*));
+	if (nptr == NULL)
+		return PARSE_E_NO_MEM;
+	tree->runs = nptr;
+
+	pret = run_scan_open_dir(&tree->scan, dir, name, &dir_idx);
+	if (pret == PARSE_E_CANT_READ && tree->scan.dir_count > 0) {
+		/* The directories held open by the batch may have exhausted the descriptors */
+		pret = run_load(&tree->scan, tree->threads);
+		if (pret != PARSE_OK)
 			return pret;
-	    }
+		pret = run_scan_open_dir(&tree->scan, dir, name, &dir_idx);
 	}
+	if (pret == PARSE_E_CANT_READ)
+		return PARSE_OK;
+	else if (pret != PARSE_OK)
+		return pret;
+
+	run = run_alloc(tree->scan.dirs[dir_idx].path);
+	if (run == NULL)
+		return PARSE_E_NO_MEM;
+	tree->runs[tree->count++] = run;
+
+	pret = run_scan(&tree->scan, dir_idx, run);
+	if (pret == PARSE_E_CANT_READ)
+		pret = PARSE_OK;
+	if (pret != PARSE_OK)
+		return pret;
+
+	if (tree->scan.dir_count < tree->max_dirs)
+		return PARSE_OK;
 
-	/* Sampling rate information is unreliable unless the whole file is read */
-	mdata->sampling_rate = -1.0;
+	return run_load(&tree->scan, tree->threads);
+}
 
-	return PARSE_OK;
+static size_t run_tree_max_dirs(void)
+{
+#ifdef _WIN32
+	return RUN_TREE_MAX_DIRS;
+#else
+	return __unix_run_tree_max_dirs();
+#endif
 }
 
-static enum HPCS_ParseCode read_file_type_description(FILE* datafile, char** const description, const enum HPCS_GenType gentype)
+static enum HPCS_ParseCode run_tree_walk(struct HPCS_RunTree* tree, const struct HPCS_RunDir* dir)
 {
+	struct HPCS_DirEntry* entries;
 	enum HPCS_ParseCode pret;
-	const HPCS_offset offset = OLD_FORMAT(gentype) ? DATA_OFFSET_FILE_DESC_OLD : DATA_OFFSET_FILE_DESC;
+	size_t count;
+	size_t idx;
 
-	pret = read_string_at_offset(datafile, offset, description, OLD_FORMAT(gentype));
+	pret = dir_list(dir, &entries, &count);
 	if (pret != PARSE_OK)
-		PR_DEBUGF("%s%d\n", "Cannot read file description, errno: ", pret);
+		return pret;
+
+	for (idx = 0; idx < count && pret == PARSE_OK; idx++) {
+		struct HPCS_RunDir subdir;
+
+		if (entries[idx].kind != DIRENT_DIR)
+			continue;
+
+		if (has_extension(entries[idx].name, RUN_DIR_EXT))
+			pret = run_tree_add(tree, dir, entries[idx].name);
+		else if (dir_open(dir, entries[idx].name, &subdir)) {
+			pret = run_tree_walk(tree, &subdir);
+			if (pret == PARSE_E_CANT_READ)
+				pret = PARSE_OK;
+			dir_close(&subdir);
+		}
+	}
 
+	dir_entries_free(entries, count);
 	return pret;
 }
 
-static enum HPCS_ParseCode read_method_info_file(HPCS_UFH fh, struct HPCS_MethodInfo* minfo)
+/* The start descriptor must remain valid until the thread is joined */
+static bool thread_create(HPCS_Thread* thread, struct HPCS_ThreadStart* start)
 {
-	HPCS_NChar line[64];
-	size_t allocated = 0;
+#ifdef _WIN32
+	return __win32_thread_create(thread, start);
+#else
+	return __unix_thread_create(thread, start);
+#endif
+}
 
-	while (next_native_line(fh, line, 64) == PARSE_OK) {
-		enum HPCS_ParseCode pret;
-		char* name = NULL;
-		char* value = NULL;
+static void thread_join(HPCS_Thread thread)
+{
+#ifdef _WIN32
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+#else
+	pthread_join(thread, NULL);
+#endif
+}
 
-		pret = parse_native_method_info_line(&name, &value, line);
-		if (pret != PARSE_OK) {
-			free(name);
-			free(value);
-			return pret;
-		}
+/* Index of the sample nearest to the given time, clamped to the axis */
+static size_t time_to_sample(const struct HPCS_TimeAxis* axis, const double time)
+{
+	const double pos = (time - axis->t0) / axis->dt + 0.5;
 
-		if (minfo->count+1 > allocated) {
-			size_t to_allocate;
-			if (allocated == 0)
-				to_allocate = 256;
-			else
-			    to_allocate = allocated * 2;
+	if (!(pos > 0.0))
+		return 0;
+	if (pos >= (double)axis->count)
+		return axis->count;
+	return (size_t)pos;
+}
 
-			struct HPCS_MethodInfoBlock* new_blocks = realloc(minfo->blocks, to_allocate * sizeof(struct HPCS_MethodInfoBlock));
-			if (new_blocks == NULL)
-				return PARSE_E_NO_MEM;
-			else {
-				minfo->blocks = new_blocks;
-				allocated = to_allocate;
+/* Writes "units" UTF-16LE code units as UTF-8 and returns the length of the result. Only the length
+   is returned if "dst" is NULL. The conversion stops at the first NUL, unpaired surrogates are replaced by U+FFFD. */
+static size_t utf16le_put(char* dst, const char* s, const size_t units)
+{
+	const unsigned char* bytes = (const unsigned char*)s;
+	size_t utf8_size = 0;
+	size_t idx = 0;
+
+	while (idx < units) {
+		uint32_t cp = bytes[2 * idx] | ((uint32_t)bytes[2 * idx + 1] << 8);
+
+		idx++;
+		if (cp == 0)
+			break;
+		if (cp >= 0xD800 && cp <= 0xDBFF && idx < units) {
+			const uint32_t low = bytes[2 * idx] | ((uint32_t)bytes[2 * idx + 1] << 8);
+
+			if (low >= 0xDC00 && low <= 0xDFFF) {
+				cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+				idx++;
 			}
 		}
+		if (cp >= 0xD800 && cp <= 0xDFFF)
+			cp = 0xFFFD;
 
-		minfo->blocks[minfo->count].name = name;
-		minfo->blocks[minfo->count].value = value;
-		minfo->count++;
+		utf8_size += utf8_put(dst == NULL ? NULL : dst + utf8_size, cp);
 	}
 
-	return PARSE_OK;
+	return utf8_size;
 }
 
-static enum HPCS_ParseCode read_generic_type(FILE* datafile, enum HPCS_GenType* gentype)
+/* Converts "units" UTF-16LE code units to UTF-8 with a single allocation. */
+static enum HPCS_ParseCode utf16le_to_utf8(char** target, const char* s, const size_t units, struct HPCS_Arena** arena)
 {
-	enum HPCS_ParseCode ret;
-	uint8_t len;
-	char* gentype_str;
+	const size_t utf8_size = utf16le_put(NULL, s, units);
 
-	fseek(datafile, DATA_OFFSET_GENTYPE, SEEK_SET);
-	if (feof(datafile))
-		return PARSE_E_OUT_OF_RANGE;
-	if (ferror(datafile))
-		return PARSE_E_CANT_READ;
+	*target = arena_alloc(arena, utf8_size + 1);
+	if (*target == NULL)
+		return PARSE_E_NO_MEM;
 
-	if (fread(&len, SMALL_SEGMENT_SIZE, 1, datafile) < 1)
-		return PARSE_E_CANT_READ;
+	utf16le_put(*target, s, units);
+	(*target)[utf8_size] = '\0';
 
-	gentype_str = malloc((sizeof(char) * len) + 1);
-	if (gentype_str == NULL)
-		return PARSE_E_NO_MEM;
+	return PARSE_OK;
+}
 
-	if (fread(gentype_str, SMALL_SEGMENT_SIZE, len, datafile) < len) {
-		ret = PARSE_E_CANT_READ;
-		goto out;
+/* Writes the UTF-8 encoding of a code point and returns its length. Only the length is returned if "dst" is NULL. */
+static size_t utf8_put(char* dst, const uint32_t cp)
+{
+	if (cp < 0x80) {
+		if (dst != NULL)
+			dst[0] = (char)cp;
+		return 1;
+	} else if (cp < 0x800) {
+		if (dst != NULL) {
+			dst[0] = (char)(0xC0 | (cp >> 6));
+			dst[1] = (char)(0x80 | (cp & 0x3F));
+		}
+		return 2;
+	} else if (cp < 0x10000) {
+		if (dst != NULL) {
+			dst[0] = (char)(0xE0 | (cp >> 12));
+			dst[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+			dst[2] = (char)(0x80 | (cp & 0x3F));
+		}
+		return 3;
 	}
 
-	if (feof(datafile)) {
-		ret = PARSE_E_OUT_OF_RANGE;
-		goto out;
-	}
-	if (ferror(datafile)) {
-		ret = PARSE_E_CANT_READ;
-		goto out;
+	if (dst != NULL) {
+		dst[0] = (char)(0xF0 | (cp >> 18));
+		dst[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+		dst[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+		dst[3] = (char)(0x80 | (cp & 0x3F));
 	}
+	return 4;
+}
 
-	gentype_str[len] = '\0';
-
-	PR_DEBUGF("Generic type: %s\n", gentype_str);
+/* Samples whose time falls within the range. The estimate from the division is corrected
+   so that the times of the samples compare with the bounds exactly. */
+static void window_samples(const struct HPCS_TimeAxis* axis, const double t_start, const double t_end, size_t* first, size_t* end)
+{
+	*first = 0;
+	*end = 0;
+	if (axis->count == 0 || !(axis->dt > 0.0) || t_end < t_start || t_end < axis->t0)
+		return;
 
-	*gentype = strtol(gentype_str, NULL, 10);
-	ret = PARSE_OK;
+	*first = time_to_sample(axis, t_start);
+	while (*first > 0 && axis->t0 + (*first - 1) * axis->dt >= t_start)
+		(*first)--;
+	while (*first < axis->count && axis->t0 + *first * axis->dt < t_start)
+		(*first)++;
 
-out:
-	free(gentype_str);
+	*end = time_to_sample(axis, t_end);
+	while (*end > 0 && axis->t0 + (*end - 1) * axis->dt > t_end)
+		(*end)--;
+	while (*end < axis->count && axis->t0 + *end * axis->dt <= t_end)
+		(*end)++;
 
-	return ret;
+	if (*end < *first)
+		*end = *first;
 }
 
-static enum HPCS_ParseCode read_scans_start(FILE* datafile, size_t *scans_start)
+/* Takes a task from the front of the queue. Used by the owner of the queue. */
+static bool work_queue_pop(struct HPCS_WorkQueue* queue, size_t* task_idx)
 {
-	size_t r;
-	int32_t _start;
+	bool ret = false;
 
-	fseek(datafile, DATA_SCANS_START, SEEK_SET);
-	if (feof(datafile))
-		return PARSE_E_OUT_OF_RANGE;
-	if (ferror(datafile))
-		return PARSE_E_CANT_READ;
+	mutex_lock(&queue->lock);
+	if (queue->head < queue->tail) {
+		*task_idx = queue->head++;
+		ret = true;
+	}
+	mutex_unlock(&queue->lock);
 
-	r = fread(&_start, LARGE_SEGMENT_SIZE, 1, datafile);
-	if (r != 1)
-		return PARSE_E_CANT_READ;
+	return ret;
+}
 
-	be_to_cpu_val(_start);
+/* Takes a task from the back of the queue. Used by the other workers. */
+static bool work_queue_steal(struct HPCS_WorkQueue* queue, size_t* task_idx)
+{
+	bool ret = false;
 
-	*scans_start = (_start - 1) * 512;
+	mutex_lock(&queue->lock);
+	if (queue->head < queue->tail) {
+		*task_idx = --queue->tail;
+		ret = true;
+	}
+	mutex_unlock(&queue->lock);
 
-	return PARSE_OK;
+	return ret;
 }
 
-static enum HPCS_ParseCode read_signal(FILE* datafile, struct HPCS_TVPair** pairs, size_t* pairs_count,
-				       const HPCS_offset scans_start, const double signal_step, const double signal_shift, const enum HPCS_GenType gentype)
+/* Writes the index next to the data file. The whole index is written at once, a reader that finds
+   it incomplete ignores it. */
+static bool write_signal_index(const char* filename, const struct HPCS_SignalIndex* index)
 {
-	switch (gentype) {
-	case GENTYPE_ADC_LC:
-	case GENTYPE_ADC_LC2:
-		return read_signal_30_130(datafile, pairs, pairs_count, scans_start,
-					  signal_step, signal_shift);
-	case GENTYPE_GC_B:
-		return read_signal_179(datafile, pairs, pairs_count, scans_start,
-				       signal_step, signal_shift);
-	default:
-		assert("Invalid gentype");
-		return PARSE_E_INTERNAL;
+	const struct HPCS_CheckpointList* checkpoints = &index->checkpoints;
+	const size_t size = INDEX_HEADER_SIZE + checkpoints->count * INDEX_RECORD_SIZE;
+	char* bytes;
+	size_t idx;
+	FILE* fh;
+	bool ok;
+
+	bytes = mem_alloc(size);
+	if (bytes == NULL)
+		return false;
+
+	memcpy(bytes, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	index_put_u64(bytes + 8, index->file_size);
+	index_put_u64(bytes + 16, (uint64_t)index->mtime);
+	index_put_u64(bytes + 24, index->mtime_nsec);
+	index_put_u64(bytes + 32, index->sample_count);
+	index_put_u64(bytes + 40, index->interval);
+	index_put_u64(bytes + 48, checkpoints->count);
+
+	for (idx = 0; idx < checkpoints->count; idx++) {
+		const struct HPCS_Checkpoint* cp = &checkpoints->items[idx];
+		char* record = bytes + INDEX_HEADER_SIZE + idx * INDEX_RECORD_SIZE;
+		uint64_t value;
+
+		memcpy(&value, &cp->value, sizeof(double));
+		index_put_u64(record, cp->offset);
+		index_put_u64(record + 8, cp->sample_idx);
+		index_put_u64(record + 16, cp->segments_read);
+		index_put_u64(record + 24, cp->next_marker_idx);
+		index_put_u64(record + 32, value);
+	}
+
+	fh = open_index_file(filename, true);
+	if (fh == NULL) {
+		mem_free(bytes);
+		return false;
 	}
+
+	ok = fwrite(bytes, size, 1, fh) == 1;
+	if (fclose(fh) != 0)
+		ok = false;
+
+	mem_free(bytes);
+	return ok;
 }
 
-static enum HPCS_ParseCode read_signal_30_130(FILE* datafile, struct HPCS_TVPair** pairs, size_t* pairs_count,
-					      const HPCS_offset scans_start, const double signal_step, const double signal_shift)
+/* Provides at most "length" bytes of the source starting at "offset".
+   Memory and mapped sources return a pointer to the content, stdio sources
+   return the content of the read buffer that remains valid until
+   the next call. */
+static enum HPCS_ParseCode source_view(struct HPCS_DataSource* src, const HPCS_offset offset, const size_t length, const char** view, size_t* available)
 {
-        size_t alloc_size = (size_t)((60 * 25));
-	bool read_file = true;
-	double value = 0;
-	size_t segments_read = 0;
-	size_t data_segments_read = 0;
-	size_t next_marker_idx = 0;
-	char raw[2];
-	size_t r;
-	enum HPCS_DataCheckCode dret;
+	size_t to_read;
 
-	fseek(datafile, scans_start, SEEK_SET);
-	if (feof(datafile))
+	if ((size_t)offset > src->size)
 		return PARSE_E_OUT_OF_RANGE;
-	if (ferror(datafile))
-		return PARSE_E_CANT_READ;
 
-	r = fread(raw, SEGMENT_SIZE, 1, datafile);
-	if (r != 1)
-		return PARSE_E_CANT_READ;
+	to_read = src->size - offset;
+	if (to_read > length)
+		to_read = length;
 
-	dret = check_for_marker(raw, &next_marker_idx, segments_read);
-	switch (dret) {
-	case DCHECK_EOF:
-		PR_DEBUG("File contains no data\n");
-		return PARSE_E_CANT_READ;
-	case DCHECK_NO_MARKER:
-		PR_DEBUG("Leading marker not present\n");
-		return PARSE_E_NOT_FOUND;
-	default:
-		break;
+	if (src->kind == SOURCE_MEMORY || src->kind == SOURCE_MAPPED) {
+		*view = src->memory + offset;
+		*available = to_read;
+		return PARSE_OK;
 	}
-	segments_read++;
 
-	*pairs = malloc(sizeof(struct HPCS_TVPair) * alloc_size);
-	if (*pairs == NULL)
-		return PARSE_E_NO_MEM;
+	if (to_read > SOURCE_BUFFER_SIZE)
+		to_read = SOURCE_BUFFER_SIZE;
 
-	PR_DEBUGF("Reading 30/130 signal, first mid-marker expected at segment %lu\n", next_marker_idx);
+	if (src->kind == SOURCE_IO) {
+		*view = src->buffer;
+		return io_read_at(&src->io, offset, src->buffer, to_read, available);
+	}
 
-	while (read_file) {
-		r = fread(raw, SEGMENT_SIZE, 1, datafile);
+	if (fseek(src->fh, offset, SEEK_SET) != 0)
+		return PARSE_E_CANT_READ;
+	*available = fread(src->buffer, SMALL_SEGMENT_SIZE, to_read, src->fh);
+	if (ferror(src->fh))
+		return PARSE_E_CANT_READ;
 
-		if (ferror(datafile)) {
-			free(*pairs);
-			*pairs = NULL;
-			PR_DEBUG("Error reading stream - ferror\n");
-			return PARSE_E_CANT_READ;
-		}
-		if (feof(datafile))
-			break;
+	*view = src->buffer;
+	return PARSE_OK;
+}
 
-		if (r != 1) {
-			free(*pairs);
-			*pairs = NULL;
-			PR_DEBUGF("Error reading stream, r=%lu\n", r);
-			return PARSE_E_CANT_READ;
-		}
+/** Platform-specific functions */
 
-		/* Expand storage if there is more data than we can store */
-		if (alloc_size == data_segments_read) {
-			if (expand_storage(pairs, &alloc_size) == PARSE_E_NO_MEM)
-				return PARSE_E_NO_MEM;
-		}
+#ifdef HPCS_SIMD_X86
+/* Returns the number of deltas converted, the rest is left to the scalar code */
+static HPCS_TARGET_AVX2 size_t __avx2_delta_increments(const char* raw, const size_t count, const double step, const double shift, double* increments)
+{
+	const __m128i swap = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+	const __m256d vstep = _mm256_set1_pd(step);
+	const __m256d vshift = _mm256_set1_pd(shift);
+	size_t idx;
 
-		/* Check for markers */
-		dret = check_for_marker(raw, &next_marker_idx, segments_read);
-		switch (dret) {
-		case DCHECK_GOT_MARKER:
-#ifndef NDEBUG
-		{
-			const size_t pos = ftell(datafile) - SEGMENT_SIZE;
-			fprintf(stderr, "Got marker at segment %lu, byte 0x%lx, next marker expected at %lu\n", segments_read, pos, next_marker_idx);
-		}
-#endif
-			break;
-		case DCHECK_NO_MARKER:
-#ifndef NDEBUG
-			if (segments_read == next_marker_idx)
-				fprintf(stderr, "Warning - marker expected but not found at segment %lu\n", segments_read);
-#endif
-			/* Check for a sudden jump of value */
-			if (raw[0] == BIN_MARKER_JUMP && raw[1] == BIN_MARKER_END) {
-				char lraw[4];
-				int32_t _v;
-#ifndef NDEBUG
-				const size_t pos = ftell(datafile) - SEGMENT_SIZE;
-				fprintf(stderr, "Value has jumped at %lu, byte 0x%lx\n", segments_read, pos);
-#endif
-				r = fread(lraw, LARGE_SEGMENT_SIZE, 1, datafile);
-				if (feof(datafile) || ferror(datafile) || (r != 1)) {
-					free(*pairs);
-					*pairs = NULL;
-					return PARSE_E_CANT_READ;
-				}
+	for (idx = 0; idx + 8 <= count; idx += 8) {
+		const __m128i be = _mm_loadu_si128((const __m128i*)(raw + idx * SEGMENT_SIZE));
+		const __m256i wide = _mm256_cvtepi16_epi32(_mm_shuffle_epi8(be, swap));
+		const __m256d lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(wide));
+		const __m256d hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(wide, 1));
 
-				be_to_cpu(lraw);
-				_v = *(int32_t*)lraw;
-				value = _v * signal_step + signal_shift;
-			} else {
-				int16_t _v;
+		/* Separate multiplication and addition round the same way as the scalar code */
+		_mm256_storeu_pd(increments + idx, _mm256_add_pd(_mm256_mul_pd(lo, vstep), vshift));
+		_mm256_storeu_pd(increments + idx + 4, _mm256_add_pd(_mm256_mul_pd(hi, vstep), vshift));
+	}
 
-				be_to_cpu(raw);
-				_v = *(int16_t*)raw;
-				value += _v * signal_step + signal_shift;
-			}
+	return idx;
+}
 
-			(*pairs)[data_segments_read].value = value;
-			data_segments_read++;
+/* Returns the index of the block of segments that contains the first jump marker */
+static HPCS_TARGET_AVX2 size_t __avx2_delta_run_length(const char* raw, const size_t count)
+{
+	const __m256i jump = _mm256_set1_epi16(JUMP_SEGMENT_LE);
+	size_t idx;
+
+	for (idx = 0; idx + 16 <= count; idx += 16) {
+		const __m256i segments = _mm256_loadu_si256((const __m256i*)(raw + idx * SEGMENT_SIZE));
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(segments, jump)) != 0)
 			break;
-		default:
-			PR_DEBUG("Invalid value from check_for_marker()\n");
-			free(*pairs);
-			*pairs = NULL;
-			return PARSE_E_CANT_READ;
-		}
-		segments_read++;
 	}
 
-	*pairs_count = data_segments_read;
-	return PARSE_OK;
+	return idx;
 }
 
-static enum HPCS_ParseCode read_signal_179(FILE* datafile, struct HPCS_TVPair** pairs, size_t* pairs_count,
-					   const HPCS_offset scans_start, const double signal_step, const double signal_shift)
+/* Returns the number of values converted, the rest is left to the scalar code */
+static HPCS_TARGET_AVX2 size_t __avx2_min_max_sum(const double* values, const size_t count, double* lo, double* hi, double* sum)
 {
-        size_t alloc_size = (size_t)((60 * 25));
-	size_t segments_read = 0;
-
-	fseek(datafile, scans_start, SEEK_SET);
-	if (feof(datafile))
-		return PARSE_E_OUT_OF_RANGE;
-	if (ferror(datafile))
-		return PARSE_E_CANT_READ;
+	__m256d vlo = _mm256_set1_pd(*lo);
+	__m256d vhi = _mm256_set1_pd(*hi);
+	__m256d vsum = _mm256_setzero_pd();
+	__m128d lo2;
+	__m128d hi2;
+	__m128d sum2;
+	size_t idx;
 
-	*pairs = malloc(sizeof(struct HPCS_TVPair) * alloc_size);
-	if (*pairs == NULL)
-		return PARSE_E_NO_MEM;
+	for (idx = 0; idx + 4 <= count; idx += 4) {
+		const __m256d v = _mm256_loadu_pd(values + idx);
 
-	PR_DEBUG("Reading 179 signal\n");
+		vlo = _mm256_min_pd(vlo, v);
+		vhi = _mm256_max_pd(vhi, v);
+		vsum = _mm256_add_pd(vsum, v);
+	}
 
-	while (true) {
-		char raw[8];
-		double value;
+	lo2 = _mm_min_pd(_mm256_castpd256_pd128(vlo), _mm256_extractf128_pd(vlo, 1));
+	hi2 = _mm_max_pd(_mm256_castpd256_pd128(vhi), _mm256_extractf128_pd(vhi, 1));
+	sum2 = _mm_add_pd(_mm256_castpd256_pd128(vsum), _mm256_extractf128_pd(vsum, 1));
+	_mm_store_sd(lo, _mm_min_sd(lo2, _mm_unpackhi_pd(lo2, lo2)));
+	_mm_store_sd(hi, _mm_max_sd(hi2, _mm_unpackhi_pd(hi2, hi2)));
+	*sum += _mm_cvtsd_f64(_mm_add_sd(sum2, _mm_unpackhi_pd(sum2, sum2)));
 
-		size_t r = fread(raw, DOUBLE_SEGMENT_SIZE, 1, datafile);
+	return idx;
+}
 
-		if (ferror(datafile)) {
-			free(*pairs);
-			*pairs = NULL;
-			PR_DEBUG("Error reading stream - ferror\n");
-			return PARSE_E_CANT_READ;
-		}
-		if (feof(datafile))
-			break;
+static HPCS_TARGET_AVX2 size_t __avx2_scale_doubles(const char* raw, const size_t count, const double step, const double shift, char* dst, const size_t stride)
+{
+	const __m256d vstep = _mm256_set1_pd(step);
+	const __m256d vshift = _mm256_set1_pd(shift);
+	size_t idx;
 
-		if (r != 1) {
-			free(*pairs);
-			*pairs = NULL;
-			PR_DEBUGF("Error reading stream, r=%lu\n", r);
-			return PARSE_E_CANT_READ;
-		}
+	for (idx = 0; idx + 4 <= count; idx += 4) {
+		const __m256d v = _mm256_loadu_pd((const double*)(raw + idx * DOUBLE_SEGMENT_SIZE));
+		const __m256d y = _mm256_add_pd(_mm256_mul_pd(v, vstep), vshift);
+		const __m128d lo = _mm256_castpd256_pd128(y);
+		const __m128d hi = _mm256_extractf128_pd(y, 1);
+
+		/* Values go to the interleaved output one by one */
+		_mm_storel_pd((double*)dst, lo);
+		_mm_storeh_pd((double*)(dst + stride), lo);
+		_mm_storel_pd((double*)(dst + 2 * stride), hi);
+		_mm_storeh_pd((double*)(dst + 3 * stride), hi);
+		dst += 4 * stride;
+	}
 
-		/* Expand storage if there is more data than we can store */
-		if (alloc_size == segments_read) {
-			if (expand_storage(pairs, &alloc_size) == PARSE_E_NO_MEM)
-				return PARSE_E_NO_MEM;
-		}
+	return idx;
+}
 
-		le_to_cpu(raw);
+static size_t __sse2_delta_increments(const char* raw, const size_t count, const double step, const double shift, double* increments)
+{
+	const __m128d vstep = _mm_set1_pd(step);
+	const __m128d vshift = _mm_set1_pd(shift);
+	size_t idx;
 
-		value = *(double*)(&raw);
-		value = value * signal_step + signal_shift;
-		(*pairs)[segments_read].value = value;
-		segments_read++;
+	for (idx = 0; idx + 8 <= count; idx += 8) {
+		const __m128i be = _mm_loadu_si128((const __m128i*)(raw + idx * SEGMENT_SIZE));
+		const __m128i le = _mm_or_si128(_mm_slli_epi16(be, 8), _mm_srli_epi16(be, 8));
+		/* Sign-extend to 32 bits by moving each value to the upper half of a doubleword */
+		const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(le, le), 16);
+		const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(le, le), 16);
+		const __m128d d0 = _mm_cvtepi32_pd(lo);
+		const __m128d d1 = _mm_cvtepi32_pd(_mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 2, 3, 2)));
+		const __m128d d2 = _mm_cvtepi32_pd(hi);
+		const __m128d d3 = _mm_cvtepi32_pd(_mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 2, 3, 2)));
+
+		_mm_storeu_pd(increments + idx, _mm_add_pd(_mm_mul_pd(d0, vstep), vshift));
+		_mm_storeu_pd(increments + idx + 2, _mm_add_pd(_mm_mul_pd(d1, vstep), vshift));
+		_mm_storeu_pd(increments + idx + 4, _mm_add_pd(_mm_mul_pd(d2, vstep), vshift));
+		_mm_storeu_pd(increments + idx + 6, _mm_add_pd(_mm_mul_pd(d3, vstep), vshift));
 	}
 
-	*pairs_count = segments_read;
-	return PARSE_OK;
+	return idx;
 }
 
-static enum HPCS_ParseCode read_timing(FILE* datafile, struct HPCS_TVPair*const pairs, double *sampling_rate, const size_t data_count, const bool is_type_179)
+static size_t __sse2_min_max_sum(const double* values, const size_t count, double* lo, double* hi, double* sum)
 {
-	assert(sizeof(int32_t) == sizeof(float));
-
-	union { int32_t i; float f; } xmin;
-	union { int32_t i; float f; } xmax;
-	double xminf;
-	double xmaxf;
-	double time_step;
-	double t;
+	__m128d vlo = _mm_set1_pd(*lo);
+	__m128d vhi = _mm_set1_pd(*hi);
+	__m128d vsum = _mm_setzero_pd();
 	size_t idx;
 
-	fseek(datafile, DATA_OFFSET_XMIN, SEEK_SET);
-	if (feof(datafile))
-		return PARSE_E_OUT_OF_RANGE;
-	if (ferror(datafile))
-		return PARSE_E_CANT_READ;
-
-	if (fread(&xmin, LARGE_SEGMENT_SIZE, 1, datafile) < 1)
-		return PARSE_E_CANT_READ;
-	if (fread(&xmax, LARGE_SEGMENT_SIZE, 1, datafile) < 1)
-		return PARSE_E_CANT_READ;
-
-	be_to_cpu_val(xmin.i);
-	be_to_cpu_val(xmax.i);
+	for (idx = 0; idx + 2 <= count; idx += 2) {
+		const __m128d v = _mm_loadu_pd(values + idx);
 
-	if (is_type_179) {
-		xminf = xmin.f / 60000.0f;
-		xmaxf = xmax.f / 60000.0f;
-	} else {
-		xminf = (double)xmin.i / 60000.0;
-		xmaxf = (double)xmax.i / 60000.0;
+		vlo = _mm_min_pd(vlo, v);
+		vhi = _mm_max_pd(vhi, v);
+		vsum = _mm_add_pd(vsum, v);
 	}
 
-	time_step = (xmaxf - xminf) / data_count;
-	*sampling_rate = 1.0 / (time_step * 60.0);
-
-	t = xminf;
-	for (idx = 0; idx < data_count; idx++) {
-		pairs[idx].time = t;
-		t += time_step;
-	}
+	_mm_store_sd(lo, _mm_min_sd(vlo, _mm_unpackhi_pd(vlo, vlo)));
+	_mm_store_sd(hi, _mm_max_sd(vhi, _mm_unpackhi_pd(vhi, vhi)));
+	*sum += _mm_cvtsd_f64(_mm_add_sd(vsum, _mm_unpackhi_pd(vsum, vsum)));
 
-	return PARSE_OK;
+	return idx;
 }
 
-static enum HPCS_ParseCode read_string_at_offset(FILE* datafile, const HPCS_offset offset, char** const result, const bool old_format)
+static size_t __sse2_scale_doubles(const char* raw, const size_t count, const double step, const double shift, char* dst, const size_t stride)
 {
-	if (old_format)
-		return __read_string_at_offset_v1(datafile, offset, result);
-	return __read_string_at_offset_v2(datafile, offset, result);
-}
+	const __m128d vstep = _mm_set1_pd(step);
+	const __m128d vshift = _mm_set1_pd(shift);
+	size_t idx;
 
-static enum HPCS_ParseCode __read_string_at_offset_v1(FILE* datafile, const HPCS_offset offset, char** const result)
-{
-	size_t r;
-	char ch;
-	char* string;
-	enum HPCS_ParseCode ret;
-	size_t str_length = 0;
+	for (idx = 0; idx + 2 <= count; idx += 2) {
+		const __m128d v = _mm_loadu_pd((const double*)(raw + idx * DOUBLE_SEGMENT_SIZE));
+		const __m128d y = _mm_add_pd(_mm_mul_pd(v, vstep), vshift);
 
-	PR_DEBUG("Using v1 string read\n");
+		_mm_storel_pd((double*)dst, y);
+		_mm_storeh_pd((double*)(dst + stride), y);
+		dst += 2 * stride;
+	}
 
-	fseek(datafile, offset, SEEK_SET);
-	if (feof(datafile))
-		return PARSE_E_OUT_OF_RANGE;
-	if (ferror(datafile))
-		return PARSE_E_CANT_READ;
+	return idx;
+}
 
-	/* Read the length of the string */
-	while (true) {
-		r = fread(&ch, SMALL_SEGMENT_SIZE, 1, datafile);
-		if (r != 1)
-			return PARSE_E_CANT_READ;
+static size_t __sse2_delta_run_length(const char* raw, const size_t count)
+{
+	const __m128i jump = _mm_set1_epi16(JUMP_SEGMENT_LE);
+	size_t idx;
 
-		if (ch != '\0')
-			str_length++;
-		else
+	for (idx = 0; idx + 8 <= count; idx += 8) {
+		const __m128i segments = _mm_loadu_si128((const __m128i*)(raw + idx * SEGMENT_SIZE));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(segments, jump)) != 0)
 			break;
 	}
 
-	PR_DEBUGF("String length to read: %lu\n", str_length);
-
-	if (str_length == 0) {
-		*result = malloc(sizeof(char));
-
-		if (*result == NULL)
-			return PARSE_E_NO_MEM;
+	return idx;
+}
+#endif
 
-		(*result)[0] = '\0';
-		return PARSE_OK;
-	}
+#ifdef _WIN32
+static int __win32_cpu_count(void)
+{
+	SYSTEM_INFO info;
 
-	/* Allocate read buffer */
-	string = calloc(str_length + 1, SMALL_SEGMENT_SIZE);
-	if (string == NULL)
-		return PARSE_E_NO_MEM;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
 
-	memset(string, 0, (str_length + 1));
+static int __win32_io_fd_read(const int fd, void* dst, const size_t length, size_t* bytes_read)
+{
+	const unsigned int to_read = length > INT_MAX ? INT_MAX : (unsigned int)length;
+	const int ret = _read(fd, dst, to_read);
 
-	/* Rewind the file and read the string */
-	fseek(datafile, offset, SEEK_SET);
-	r = fread(string, SMALL_SEGMENT_SIZE, str_length, datafile);
-	if (r < str_length) {
-		free(string);
-		return PARSE_E_CANT_READ;
-	}
+	if (ret < 0)
+		return -1;
 
-#ifdef _WIN32
-	ret = __win32_latin1_to_utf8(result, string);
-#else
-	ret = __unix_data_to_utf8(result, string, "ISO-8859-1", str_length);
-#endif
-	free(string);
+	*bytes_read = (size_t)ret;
+	return 0;
+}
 
-	return ret;
+static bool __win32_thread_create(HANDLE* thread, struct HPCS_ThreadStart* start)
+{
+	*thread = CreateThread(NULL, 0, __win32_thread_entry, start, 0, NULL);
+	return *thread != NULL;
 }
 
-static enum HPCS_ParseCode __read_string_at_offset_v2(FILE* datafile, const HPCS_offset offset, char** const result)
+static DWORD WINAPI __win32_thread_entry(LPVOID arg)
 {
-	char* string;
-	uint8_t str_length;
-	size_t r;
-	enum HPCS_ParseCode ret;
+	struct HPCS_ThreadStart* start = arg;
 
-	PR_DEBUG("Using v2 string read\n");
+	start->func(start->arg);
+	return 0;
+}
 
-	fseek(datafile, offset, SEEK_SET);
-	if (feof(datafile))
-		return PARSE_E_OUT_OF_RANGE;
-	if (ferror(datafile))
-		return PARSE_E_CANT_READ;
+static enum HPCS_ParseCode __win32_dir_list(const char* path, struct HPCS_DirEntry** entries, size_t* count)
+{
+	enum HPCS_ParseCode pret = PARSE_OK;
+	size_t allocated = 0;
+	WIN32_FIND_DATAW data;
+	wchar_t* win_pattern;
+	char* pattern;
+	HANDLE find;
 
-	r = fread(&str_length, SMALL_SEGMENT_SIZE, 1, datafile);
-	if (r != 1)
+	pattern = join_path(path, "*");
+	if (pattern == NULL)
+		return PARSE_E_NO_MEM;
+	if (!__win32_utf8_to_wchar(&win_pattern, pattern)) {
+		mem_free(pattern);
 		return PARSE_E_CANT_READ;
+	}
+	mem_free(pattern);
 
-	PR_DEBUGF("String length to read: %u\n", str_length);
-
-	if (str_length == 0) {
-		*result = malloc(sizeof(char));
+	find = FindFirstFileW(win_pattern, &data);
+	mem_free(win_pattern);
+	if (find == INVALID_HANDLE_VALUE)
+		return GetLastError() == ERROR_FILE_NOT_FOUND ? PARSE_OK : PARSE_E_CANT_READ;
 
-		if (*result == NULL)
-			return PARSE_E_NO_MEM;
+	do {
+		enum HPCS_DirEntryKind kind;
+		char* name;
 
-		(*result)[0] = '\0';
-		return PARSE_OK;
-	}
+		if (wcscmp(data.cFileName, L".") == 0 || wcscmp(data.cFileName, L"..") == 0)
+			continue;
 
-	string = calloc(str_length + 1, SEGMENT_SIZE);
-	if (string == NULL)
-		return PARSE_E_NO_MEM;
-	memset(string, 0, (str_length + 1) * SEGMENT_SIZE);
+		/* Junctions and links to directories are not followed */
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			kind = data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT ? DIRENT_OTHER : DIRENT_DIR;
+		else
+			kind = DIRENT_FILE;
 
-	r = fread(string, SEGMENT_SIZE, str_length, datafile);
-	if (r < str_length) {
-		free(string);
-		return PARSE_E_CANT_READ;
-	}
+		pret = __win32_wchar_to_utf8(&name, data.cFileName);
+		if (pret == PARSE_OK)
+			pret = dir_entries_add(entries, count, &allocated, name, kind);
+	} while (pret == PARSE_OK && FindNextFileW(find, &data));
 
-#ifdef _WIN32
-	/* String is stored as native Windows WCHAR */
-	ret = __win32_wchar_to_utf8(result, (WCHAR*)string);
-#else
-	/* Explicitly convert from UTF-16LE (internal WCHAR representation) */
-	ret = __unix_data_to_utf8(result, string, "UTF-16LE", str_length * SEGMENT_SIZE);
-#endif
+	if (pret == PARSE_OK && GetLastError() != ERROR_NO_MORE_FILES)
+		pret = PARSE_E_CANT_READ;
 
-	free(string);
-	return ret;
+	FindClose(find);
+	return pret;
 }
 
-static void remove_trailing_newline(HPCS_NChar* s)
+static bool __win32_dir_open(const char* path)
 {
-	HPCS_NChar* newline;
-#ifdef _WIN32
-	newline = StrStrW(s, CR_LF);
-	if (newline != NULL)
-		*newline = (WCHAR)0;
-#else
-	newline = u_strrstr(s, CR_LF);
-	if (newline != NULL)
-		*newline = (UChar)0;
-#endif
-}
+	wchar_t* win_path;
+	DWORD attrs;
 
-/** Platform-specific functions */
+	if (!__win32_utf8_to_wchar(&win_path, path))
+		return false;
 
-#ifdef _WIN32
-static enum HPCS_ParseCode __win32_next_native_line(FILE* fh, WCHAR* line, int32_t length)
-{
-	if (fgetws(line, length, fh) == NULL)
-		return PARSE_E_CANT_READ;
+	attrs = GetFileAttributesW(win_path);
+	mem_free(win_path);
 
-	return PARSE_OK;
+	return attrs != INVALID_FILE_ATTRIBUTES && (attrs & FILE_ATTRIBUTE_DIRECTORY);
 }
 
-static FILE* __win32_open_data_file(const char* filename)
+static bool __win32_file_stamp(const char* filename, uint64_t* size, int64_t* mtime, uint32_t* mtime_nsec)
 {
-	FILE* fh;
-	WCHAR* win_filename;
+	/* Offset of the Unix epoch in FILETIME units of 100 ns */
+	const ULONGLONG EPOCH_OFFSET = 116444736000000000ULL;
+	WIN32_FILE_ATTRIBUTE_DATA attrs;
+	ULARGE_INTEGER time;
+	wchar_t* win_filename;
+	BOOL ret;
 
 	if (!__win32_utf8_to_wchar(&win_filename, filename))
-		return NULL;
+		return false;
 
-	fh = _wfopen(win_filename, L"r, ccs=UNICODE");
+	ret = GetFileAttributesExW(win_filename, GetFileExInfoStandard, &attrs);
+	mem_free(win_filename);
+	if (!ret)
+		return false;
 
-	free(win_filename);
-	return fh;
+	time.LowPart = attrs.ftLastWriteTime.dwLowDateTime;
+	time.HighPart = attrs.ftLastWriteTime.dwHighDateTime;
+	*size = ((uint64_t)attrs.nFileSizeHigh << 32) | attrs.nFileSizeLow;
+	*mtime = (int64_t)((time.QuadPart - EPOCH_OFFSET) / 10000000ULL);
+	*mtime_nsec = (uint32_t)((time.QuadPart - EPOCH_OFFSET) % 10000000ULL) * 100;
+
+	return true;
 }
 
-static enum HPCS_ParseCode __win32_parse_native_method_info_line(char** name, char** value, WCHAR* line)
+static bool __win32_map_measurement_file(const char* filename, struct HPCS_DataSource* src)
 {
-	WCHAR* w_name;
-	WCHAR* w_value;
-	enum HPCS_ParseCode ret;
-
-#if _MSC_VER >= 1900
-	w_name = wcstok(line, EQUALITY_SIGN, NULL);
-#else
-	w_name = wcstok(line, EQUALITY_SIGN);
-#endif
-
-	if (w_name == NULL)
-		return PARSE_E_NOT_FOUND;
+	HANDLE fh;
+	wchar_t* win_filename;
+	bool mapped;
 
-	remove_trailing_newline(w_name);
-	ret = __win32_wchar_to_utf8(name, w_name);
-	if (ret != PARSE_OK)
-		return ret;
+	if (!__win32_utf8_to_wchar(&win_filename, filename))
+		return false;
 
-#if _MSC_VER >= 1900
-	w_value = wcstok(line, EQUALITY_SIGN, NULL);
-#else
-	w_value = wcstok(NULL, EQUALITY_SIGN);
-#endif
-	if (w_value == NULL) {
-		/* Add an empty string if there is no value */
-		*value = malloc(1);
-		if (*value == NULL)
-			return PARSE_E_NO_MEM;
-		*value[0] = 0;
-		return PARSE_OK;
-	}
+	fh = CreateFileW(win_filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	mem_free(win_filename);
+	if (fh == INVALID_HANDLE_VALUE)
+		return false;
 
-	remove_trailing_newline(w_value);
-	ret = __win32_wchar_to_utf8(value, w_value);
-	if (ret != PARSE_OK)
-		return ret;
+	mapped = __win32_map_measurement_handle(fh, src);
+	CloseHandle(fh);
 
-	return PARSE_OK;
+	return mapped;
 }
 
-static enum HPCS_ParseCode __win32_latin1_to_utf8(char** target, const char *s)
+static bool __win32_map_measurement_handle(HANDLE fh, struct HPCS_DataSource* src)
 {
-	wchar_t* intermediate;
-	int mb_size;
-
-	int w_size = MultiByteToWideChar(28591, 0, s, -1, NULL, 0);
-	if (w_size == 0) {
-		PR_DEBUGF("Count MultiByteToWideChar() error 0x%x\n", GetLastError());
-		return PARSE_E_INTERNAL;
-	}
-	PR_DEBUGF("w_size: %d\n", w_size);
+	HANDLE map;
+	LARGE_INTEGER size;
+	LPVOID view;
 
-	intermediate = malloc(sizeof(wchar_t) * w_size);
-	if (intermediate == NULL)
-		return PARSE_E_NO_MEM;
-
-	if (MultiByteToWideChar(28591, 0, s, -1, intermediate, w_size) == 0) {
-		PR_DEBUGF("Convert MultiByteToWideChar() error 0x%x\n", GetLastError());
-		return PARSE_E_INTERNAL;
-	}
+	/* Empty files cannot be mapped */
+	if (!GetFileSizeEx(fh, &size) || size.QuadPart <= 0 || (ULONGLONG)size.QuadPart > (size_t)-1)
+		return false;
 
-	mb_size = WideCharToMultiByte(CP_UTF8, 0, intermediate, -1, NULL, 0, NULL, NULL);
-	if (mb_size == 0) {
-		PR_DEBUGF("Count WideCharToMultiByte() error: 0x%x\n", GetLastError());
-		return PARSE_E_INTERNAL;
+	map = CreateFileMappingW(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (map == NULL) {
+		PR_DEBUGF("CreateFileMappingW() error 0x%x\n", GetLastError());
+		return false;
 	}
 
-	*target = malloc(mb_size);
-	if (*target == NULL) {
-		free(intermediate);
-		return PARSE_E_NO_MEM;
+	view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL) {
+		PR_DEBUGF("MapViewOfFile() error 0x%x\n", GetLastError());
+		CloseHandle(map);
+		return false;
 	}
 
-	if (WideCharToMultiByte(CP_UTF8, 0, intermediate, -1, *target, mb_size, NULL, NULL) == 0) {
-		free(*target);
-		PR_DEBUGF("Convert WideCharToMultiByte() error: 0x%x\n", GetLastError());
-		return PARSE_E_INTERNAL;
-	}
+	src->memory = view;
+	src->map_handle = map;
+	src->size = (size_t)size.QuadPart;
 
-	free(intermediate);
+	return true;
+}
 
-	return PARSE_OK;
+static void __win32_unmap_measurement_file(struct HPCS_DataSource* src)
+{
+	UnmapViewOfFile(src->memory);
+	CloseHandle(src->map_handle);
 }
 
 static bool __win32_utf8_to_wchar(wchar_t** target, const char *s)
@@ -1470,12 +6419,12 @@ static bool __win32_utf8_to_wchar(wchar_t** target, const char *s)
 		return false;
 	}
 	PR_DEBUGF("w_size: %d\n", w_size);
-	*target = malloc(sizeof(wchar_t) * w_size);
+	*target = mem_alloc(sizeof(wchar_t) * w_size);
 	if (*target == NULL)
 		return false;
 
 	if (MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, s, -1, *target, w_size) == 0) {
-		free(*target);
+		mem_free(*target);
 		PR_DEBUGF("Convert MultiByteToWideChar() error 0x%x\n", GetLastError());
 		return false;
 	}
@@ -1493,12 +6442,12 @@ static enum HPCS_ParseCode __win32_wchar_to_utf8(char** target, const WCHAR* s)
 		return PARSE_E_INTERNAL;
 	}
 	PR_DEBUGF("mb_size: %d\n", mb_size);
-	*target = malloc(mb_size);
+	*target = mem_alloc(mb_size);
 	if (*target == NULL)
 		return PARSE_E_NO_MEM;
 
 	if (WideCharToMultiByte(CP_UTF8, 0, s, -1, *target, mb_size, NULL, NULL) == 0) {
-		free(*target);
+		mem_free(*target);
 		PR_DEBUGF("Convert WideCharToMultiByte() error: 0x%x\n", GetLastError());
 		return PARSE_E_INTERNAL;
 	}
@@ -1507,171 +6456,600 @@ static enum HPCS_ParseCode __win32_wchar_to_utf8(char** target, const WCHAR* s)
 }
 
 #else
-static void __unix_hpcs_initialize()
+static int __unix_cpu_count(void)
 {
-	/* Initialize all Unicode strings */
-	__ICU_INIT_STRING(EQUALITY_SIGN, "\\x3d");
-	__ICU_INIT_STRING(CR_LF, "\\x0d\\x0a");
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return count > 0 ? (int)count : 1;
 }
 
-static void __unix_hpcs_destroy()
+static enum HPCS_DirEntryKind __unix_dir_entry_kind(const int fd, const struct dirent* entry)
 {
-	free(EQUALITY_SIGN);
-	free(CR_LF);
+	struct stat st;
+
+#ifdef _DIRENT_HAVE_D_TYPE
+	switch (entry->d_type) {
+	case DT_REG:
+		return DIRENT_FILE;
+	case DT_DIR:
+		return DIRENT_DIR;
+	case DT_LNK:
+	case DT_UNKNOWN:
+		break;
+	default:
+		return DIRENT_OTHER;
+	}
+#endif
+
+	if (fstatat(fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+		return DIRENT_OTHER;
+	if (S_ISDIR(st.st_mode))
+		return DIRENT_DIR;
+
+	/* Links to files are read, links to directories are not followed */
+	if (S_ISLNK(st.st_mode) && fstatat(fd, entry->d_name, &st, 0) != 0)
+		return DIRENT_OTHER;
+	return S_ISREG(st.st_mode) ? DIRENT_FILE : DIRENT_OTHER;
 }
 
-static enum HPCS_ParseCode __unix_icu_to_utf8(char** target, const UChar* s)
+static enum HPCS_ParseCode __unix_dir_list(const int fd, struct HPCS_DirEntry** entries, size_t* count)
 {
-	int32_t utf8_size;
-	UConverter* cnv;
-	UErrorCode uec = U_ZERO_ERROR;
+	enum HPCS_ParseCode pret = PARSE_OK;
+	size_t allocated = 0;
+	struct dirent* entry;
+	int list_fd;
+	DIR* dir;
 
-	cnv = ucnv_open("UTF-8", &uec);
-	if (U_FAILURE(uec)) {
-		PR_DEBUGF("Unable to create converter, error: %s\n", u_errorName(uec));
-		return PARSE_E_INTERNAL;
-	}
+	/* The stream takes over the descriptor, the descriptor of the directory stays open */
+	list_fd = openat(fd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (list_fd < 0)
+		return PARSE_E_CANT_READ;
 
-	utf8_size = ucnv_fromUChars(cnv, NULL, 0, s, -1, &uec);
-	if (U_FAILURE(uec) && uec != U_BUFFER_OVERFLOW_ERROR) {
-		ucnv_close(cnv);
-		PR_DEBUGF("Count ucnv_fromUChars(), error: %s\n", u_errorName(uec));
-		return PARSE_E_INTERNAL;
+	dir = fdopendir(list_fd);
+	if (dir == NULL) {
+		close(list_fd);
+		return PARSE_E_CANT_READ;
 	}
-	uec = U_ZERO_ERROR;
 
-	if (utf8_size == 0) {
-		ucnv_close(cnv);
-		return PARSE_E_CANT_READ;
+	errno = 0;
+	while (pret == PARSE_OK && (entry = readdir(dir)) != NULL) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+			continue;
+
+		pret = dir_entries_add(entries, count, &allocated, duplicate_string(entry->d_name), __unix_dir_entry_kind(fd, entry));
+		errno = 0;
 	}
+	if (pret == PARSE_OK && errno != 0)
+		pret = PARSE_E_CANT_READ;
 
-	*target = malloc(utf8_size + 1);
-	if (*target == NULL) {
-		ucnv_close(cnv);
-		return PARSE_E_NO_MEM;
+	closedir(dir);
+	return pret;
+}
+
+static int __unix_dir_open(const int at_fd, const char* name, const bool nofollow)
+{
+	return openat(at_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC | (nofollow ? O_NOFOLLOW : 0));
+}
+
+static bool __unix_file_stamp(const char* filename, uint64_t* size, int64_t* mtime, uint32_t* mtime_nsec)
+{
+	struct stat st;
+
+	if (stat(filename, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < 0)
+		return false;
+
+	*size = (uint64_t)st.st_size;
+	*mtime = (int64_t)st.st_mtim.tv_sec;
+	*mtime_nsec = (uint32_t)st.st_mtim.tv_nsec;
+
+	return true;
+}
+
+static FILE* __unix_fopen_at(const int dir_fd, const char* name, const char* mode)
+{
+	FILE* fh;
+	int fd;
+
+	fd = openat(dir_fd, name, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return NULL;
+
+	fh = fdopen(fd, mode);
+	if (fh == NULL)
+		close(fd);
+	return fh;
+}
+
+/* Readiness of results is signalled through an eventfd on Linux and through a pipe elsewhere */
+static void __unix_notify_close(struct HPCS_AsyncContext* ctx)
+{
+	close(ctx->notify_fd[0]);
+	if (ctx->notify_fd[1] != ctx->notify_fd[0])
+		close(ctx->notify_fd[1]);
+}
+
+static void __unix_notify_drain(struct HPCS_AsyncContext* ctx)
+{
+	char buf[64];
+
+	while (read(ctx->notify_fd[0], buf, sizeof(buf)) > 0 && ctx->notify_fd[1] != ctx->notify_fd[0])
+		;
+}
+
+static bool __unix_notify_open(struct HPCS_AsyncContext* ctx)
+{
+#ifdef __linux__
+	const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (fd < 0)
+		return false;
+
+	ctx->notify_fd[0] = fd;
+	ctx->notify_fd[1] = fd;
+	return true;
+#else
+	int idx;
+
+	if (pipe(ctx->notify_fd) != 0)
+		return false;
+	for (idx = 0; idx < 2; idx++) {
+		fcntl(ctx->notify_fd[idx], F_SETFL, fcntl(ctx->notify_fd[idx], F_GETFL) | O_NONBLOCK);
+		fcntl(ctx->notify_fd[idx], F_SETFD, FD_CLOEXEC);
 	}
-	memset(*target, 0, utf8_size + 1);
+	return true;
+#endif
+}
 
-	ucnv_fromUChars(cnv, *target, utf8_size, s, -1, &uec);
-	ucnv_close(cnv);
-	if (U_FAILURE(uec)) {
-		free(*target);
-		PR_DEBUGF("Convert ucnv_fromUChars(), error: %s\n", u_errorName(uec));
-		return PARSE_E_INTERNAL;
+static void __unix_notify_signal(struct HPCS_AsyncContext* ctx)
+{
+	const uint64_t one = 1;
+	ssize_t ret;
+
+	/* A full pipe is readable already so a failed write can be ignored */
+	if (ctx->notify_fd[1] == ctx->notify_fd[0])
+		ret = write(ctx->notify_fd[1], &one, sizeof(one));
+	else
+		ret = write(ctx->notify_fd[1], &one, 1);
+	(void)ret;
+}
+
+static int __unix_io_fd_read(const int fd, void* dst, const size_t length, size_t* bytes_read)
+{
+	ssize_t ret;
+
+	do {
+		ret = read(fd, dst, length);
+	} while (ret < 0 && errno == EINTR);
+	if (ret < 0)
+		return -1;
+
+	*bytes_read = (size_t)ret;
+	return 0;
+}
+
+static bool __unix_map_measurement_fd(const int fd, struct HPCS_DataSource* src)
+{
+	struct stat st;
+	void* addr;
+
+	/* Empty files and special files cannot be mapped */
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+		return false;
+
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (addr == MAP_FAILED) {
+		PR_DEBUG("mmap() failed\n");
+		return false;
 	}
+	posix_madvise(addr, st.st_size, POSIX_MADV_SEQUENTIAL);
 
-	return PARSE_OK;
+	src->memory = addr;
+	src->size = st.st_size;
+
+	return true;
 }
 
-static enum HPCS_ParseCode __unix_next_native_line(UFILE* fh, UChar* line, int32_t length)
+static bool __unix_map_measurement_file(const char* filename, struct HPCS_DataSource* src)
 {
-	if (u_fgets(line, length, fh) == NULL)
-		return PARSE_E_CANT_READ;
+	int fd;
+	bool mapped;
 
-	return PARSE_OK;
+	fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	mapped = __unix_map_measurement_fd(fd, src);
+	close(fd);
+
+	return mapped;
 }
 
-static UFILE* __unix_open_data_file(const char* filename)
+/* Leaves most of the descriptors the process may open to the files being loaded */
+static size_t __unix_run_tree_max_dirs(void)
 {
-	return u_fopen(filename, "r", "en_US", "UTF-16");
+	struct rlimit limit;
+
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY || limit.rlim_cur / 4 >= RUN_TREE_MAX_DIRS)
+		return RUN_TREE_MAX_DIRS;
+
+	return limit.rlim_cur < 8 ? 1 : (size_t)(limit.rlim_cur / 4);
 }
 
-static enum HPCS_ParseCode __unix_parse_native_method_info_line(char** name, char** value, UChar* line)
+static bool __unix_thread_create(pthread_t* thread, struct HPCS_ThreadStart* start)
 {
-	UChar* u_name;
-	UChar* u_value;
-	UChar* saveptr;
-	enum HPCS_ParseCode ret;
+	return pthread_create(thread, NULL, __unix_thread_entry, start) == 0;
+}
 
-	u_name = u_strtok_r(line, EQUALITY_SIGN, &saveptr);
-	if (u_name == NULL)
-		return PARSE_E_NOT_FOUND;
+static void* __unix_thread_entry(void* arg)
+{
+	struct HPCS_ThreadStart* start = arg;
 
-	remove_trailing_newline(u_name);
-	ret = __unix_icu_to_utf8(name, u_name);
-	if (ret != PARSE_OK)
-		return ret;
+	start->func(start->arg);
+	return NULL;
+}
 
-	u_value = u_strtok_r(NULL, EQUALITY_SIGN, &saveptr);
-	if (u_value == NULL) {
-		/* Add an empty string if there is no value */
-		*value = malloc(1);
-		if (*value == NULL)
-			return PARSE_E_NO_MEM;
-		*value[0] = 0;
-		return PARSE_OK;
+#ifdef _HPCS_HAVE_IO_URING
+static int __unix_uring_enter(const int fd, const unsigned int to_submit, const unsigned int min_complete, const unsigned int flags)
+{
+	long ret;
+
+	do {
+		ret = syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+	} while (ret < 0 && errno == EINTR);
+
+	return (int)ret;
+}
+
+/* Passes the queued submission entries to the kernel. Must be called with ring_lock held. */
+static void __unix_uring_flush(struct HPCS_Uring* ring)
+{
+	const unsigned int to_submit = ring->unsubmitted;
+
+	ring->unsubmitted = 0;
+	if (to_submit > 0)
+		__unix_uring_enter(ring->fd, to_submit, 0, 0);
+}
+
+/* Returns a free submission entry. Must be called with ring_lock held. */
+static struct io_uring_sqe* __unix_uring_get_sqe(struct HPCS_Uring* ring)
+{
+	struct io_uring_sqe* sqe;
+	unsigned int head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+	if (ring->sq_tail - head >= ring->sq_entries) {
+		__unix_uring_flush(ring);
+		head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+		if (ring->sq_tail - head >= ring->sq_entries)
+			return NULL;
 	}
 
-	remove_trailing_newline(u_value);
-	ret = __unix_icu_to_utf8(value, u_value);
-	if (ret != PARSE_OK)
-		return ret;
+	sqe = &ring->sqes[ring->sq_tail & ring->sq_mask];
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	return sqe;
+}
 
-	return PARSE_OK;
+/* Makes a filled submission entry visible to the kernel. Must be called with ring_lock held. */
+static void __unix_uring_publish(struct HPCS_Uring* ring)
+{
+	ring->sq_tail++;
+	ring->unsubmitted++;
+	__atomic_store_n(ring->sq_tail_ptr, ring->sq_tail, __ATOMIC_RELEASE);
 }
 
-static enum HPCS_ParseCode __unix_data_to_utf8(char** target, const char* bytes, const char* encoding, const size_t bytes_count)
+static void __unix_uring_handle(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncRequest* req, const int res)
 {
-	int32_t u_size;
-	UChar* u_str;
-	UConverter* cnv;
-	enum HPCS_ParseCode ret;
-	UErrorCode uec = U_ZERO_ERROR;
+	struct stat st;
+
+	switch (req->state) {
+	case ASYNC_OPENING:
+		if (res < 0) {
+			req->code = HPCS_E_CANT_OPEN;
+			async_complete(ctx, req);
+			return;
+		}
+		req->fd = res;
+
+		if (fstat(req->fd, &st) != 0 || !S_ISREG(st.st_mode) || (uint64_t)st.st_size > (size_t)-1)
+			goto err_read;
+		req->file_size = (size_t)st.st_size;
+		req->size = req->op == HPCS_ASYNC_MHEADER ? HEADER_BLOCK_SIZE : req->file_size;
+
+		req->bytes = mem_alloc(req->size > 0 ? req->size : 1);
+		if (req->bytes == NULL)
+			goto err_read;
+		req->done = 0;
+		req->state = ASYNC_READING;
+		break;
+	case ASYNC_READING:
+		if (res < 0)
+			goto err_read;
+		req->done += (size_t)res;
+		if (res == 0)
+			req->size = req->done;
+		break;
+	default:
+		assert(0 && "Invalid state of asynchronous request");
+		goto err_read;
+	}
 
-	cnv = ucnv_open(encoding, &uec);
-	if (U_FAILURE(uec)) {
-		PR_DEBUGF("Unable to create converter, error: %s\n", u_errorName(uec));
-		return PARSE_E_INTERNAL;
+	/* Reads may be short so the rest of the block is requested until it is complete */
+	if (req->done < req->size) {
+		if (__unix_uring_queue_read(ctx, req))
+			return;
+		goto err_read;
 	}
 
-	u_size = ucnv_toUChars(cnv, NULL, 0, bytes, bytes_count, &uec);
-	if (U_FAILURE(uec) && uec != U_BUFFER_OVERFLOW_ERROR) {
-		ucnv_close(cnv);
-		PR_DEBUGF("Count ucnv_toUchars(), error: %s\n", u_errorName(uec));
-		return PARSE_E_INTERNAL;
+	close(req->fd);
+	req->fd = -1;
+	req->state = ASYNC_PARSE;
+	async_enqueue_work(ctx, req);
+	return;
+
+err_read:
+	/* Let the blocking reader handle whatever io_uring cannot load
+	   so that the result is the same as with the synchronous functions */
+	close(req->fd);
+	req->fd = -1;
+	mem_free(req->bytes);
+	req->bytes = NULL;
+	req->state = ASYNC_LOAD;
+	async_enqueue_work(ctx, req);
+}
+
+static bool __unix_uring_probe(const int fd)
+{
+	const size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+	struct io_uring_probe* probe = mem_calloc(1, size);
+	bool ret;
+
+	if (probe == NULL)
+		return false;
+
+	ret = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) == 0 &&
+	      probe->last_op >= IORING_OP_READ &&
+	      (probe->ops[IORING_OP_OPENAT].flags & IO_URING_OP_SUPPORTED) &&
+	      (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+
+	mem_free(probe);
+	return ret;
+}
+
+static bool __unix_uring_queue_read(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncRequest* req)
+{
+	struct HPCS_Uring* ring = &ctx->uring;
+	struct io_uring_sqe* sqe;
+	size_t length = req->size - req->done;
+
+	if (length > URING_MAX_READ)
+		length = URING_MAX_READ;
+
+	mutex_lock(&ring->lock);
+	sqe = __unix_uring_get_sqe(ring);
+	if (sqe == NULL) {
+		mutex_unlock(&ring->lock);
+		return false;
 	}
-	uec = U_ZERO_ERROR;
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = req->fd;
+	sqe->addr = (uintptr_t)(req->bytes + req->done);
+	sqe->len = (uint32_t)length;
+	sqe->off = req->done;
+	sqe->user_data = (uintptr_t)req;
+	__unix_uring_publish(ring);
+	mutex_unlock(&ring->lock);
 
-	if (u_size == 0) {
-		ucnv_close(cnv);
-		return PARSE_E_CANT_READ;
+	return true;
+}
+
+/* Completions are handled by a dedicated thread. Reads that follow
+   the completed opens are submitted together with the next wait. */
+static void __unix_uring_reaper(void* arg)
+{
+	struct HPCS_AsyncContext* ctx = arg;
+	struct HPCS_Uring* ring = &ctx->uring;
+	bool stopping = false;
+
+	while (!stopping) {
+		unsigned int head = *ring->cq_head;
+		const unsigned int tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+		unsigned int to_submit;
+
+		/* Requests are filled in under the lock before they are submitted. Taking
+		   the lock makes them visible to this thread without relying on the kernel. */
+		if (head != tail) {
+			mutex_lock(&ring->lock);
+			mutex_unlock(&ring->lock);
+		}
+
+		while (head != tail) {
+			const struct io_uring_cqe* cqe = &ring->cqes[head & ring->cq_mask];
+			struct HPCS_AsyncRequest* req = (struct HPCS_AsyncRequest*)(uintptr_t)cqe->user_data;
+			const int res = cqe->res;
+
+			head++;
+			__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+			if (req == NULL)
+				stopping = true;
+			else
+				__unix_uring_handle(ctx, req, res);
+		}
+		if (stopping)
+			break;
+
+		mutex_lock(&ring->lock);
+		to_submit = ring->unsubmitted;
+		ring->unsubmitted = 0;
+		mutex_unlock(&ring->lock);
+
+		__unix_uring_enter(ring->fd, to_submit, 1, IORING_ENTER_GETEVENTS);
 	}
-	u_str = calloc(u_size + 1, sizeof(UChar));
-	if (u_str == NULL) {
-		ucnv_close(cnv);
-		return PARSE_E_NO_MEM;
+}
+
+static bool __unix_uring_start(struct HPCS_AsyncContext* ctx)
+{
+	struct HPCS_Uring* ring = &ctx->uring;
+	struct io_uring_params p;
+	size_t sq_size;
+	size_t cq_size;
+	char* sq_ptr;
+	char* cq_ptr;
+
+	memset(&p, 0, sizeof(p));
+	ring->fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+	if (ring->fd < 0)
+		return false;
+	if (!__unix_uring_probe(ring->fd))
+		goto err_fd;
+
+	sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+	cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (cq_size > sq_size)
+			sq_size = cq_size;
+		cq_size = sq_size;
 	}
-	memset(u_str, 0, (u_size + 1) * sizeof(UChar));
 
-	ucnv_toUChars(cnv, u_str, u_size, bytes, bytes_count, &uec);
-	ucnv_close(cnv);
-	if (U_FAILURE(uec)) {
-		free(u_str);
-		PR_DEBUGF("Convert ucnv_toUchars(), error: %s\n", u_errorName(uec));
-		return PARSE_E_INTERNAL;
+	sq_ptr = mmap(NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, IORING_OFF_SQ_RING);
+	if (sq_ptr == MAP_FAILED)
+		goto err_fd;
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+		cq_ptr = sq_ptr;
+	else {
+		cq_ptr = mmap(NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, IORING_OFF_CQ_RING);
+		if (cq_ptr == MAP_FAILED)
+			goto err_sq;
+	}
+	ring->sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED)
+		goto err_cq;
+
+	ring->sq_ring = sq_ptr;
+	ring->sq_ring_size = sq_size;
+	ring->cq_ring = cq_ptr;
+	ring->cq_ring_size = cq_size;
+	ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+	ring->sq_head = (unsigned int*)(sq_ptr + p.sq_off.head);
+	ring->sq_tail_ptr = (unsigned int*)(sq_ptr + p.sq_off.tail);
+	ring->sq_mask = *(unsigned int*)(sq_ptr + p.sq_off.ring_mask);
+	ring->sq_entries = p.sq_entries;
+	ring->sq_tail = *ring->sq_tail_ptr;
+	ring->unsubmitted = 0;
+	ring->cq_head = (unsigned int*)(cq_ptr + p.cq_off.head);
+	ring->cq_tail = (unsigned int*)(cq_ptr + p.cq_off.tail);
+	ring->cq_mask = *(unsigned int*)(cq_ptr + p.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe*)(cq_ptr + p.cq_off.cqes);
+
+	/* Submission entries are used in ring order */
+	{
+		unsigned int* array = (unsigned int*)(sq_ptr + p.sq_off.array);
+		unsigned int idx;
+
+		for (idx = 0; idx < p.sq_entries; idx++)
+			array[idx] = idx;
 	}
 
-	ret = __unix_icu_to_utf8(target, u_str);
-	free(u_str);
-	return ret;
+	if (!mutex_init(&ring->lock))
+		goto err_sqes;
+
+	ring->reaper_start.func = __unix_uring_reaper;
+	ring->reaper_start.arg = ctx;
+	if (!thread_create(&ring->reaper, &ring->reaper_start)) {
+		mutex_destroy(&ring->lock);
+		goto err_sqes;
+	}
+
+	return true;
+
+err_sqes:
+	munmap(ring->sqes, p.sq_entries * sizeof(struct io_uring_sqe));
+err_cq:
+	if (cq_ptr != sq_ptr)
+		munmap(cq_ptr, cq_size);
+err_sq:
+	munmap(sq_ptr, sq_size);
+err_fd:
+	close(ring->fd);
+	return false;
+}
+
+static void __unix_uring_stop(struct HPCS_AsyncContext* ctx)
+{
+	struct HPCS_Uring* ring = &ctx->uring;
+	struct io_uring_sqe* sqe;
+
+	/* A no-op without a request tells the reaper to finish. The reaper keeps
+	   draining completions, so a full submission ring frees up eventually. */
+	mutex_lock(&ring->lock);
+	while ((sqe = __unix_uring_get_sqe(ring)) == NULL) {
+		mutex_unlock(&ring->lock);
+		sched_yield();
+		mutex_lock(&ring->lock);
+	}
+	sqe->opcode = IORING_OP_NOP;
+	sqe->user_data = 0;
+	__unix_uring_publish(ring);
+	__unix_uring_flush(ring);
+	mutex_unlock(&ring->lock);
+
+	thread_join(ring->reaper);
+
+	mutex_destroy(&ring->lock);
+	munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_ring != ring->sq_ring)
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	munmap(ring->sq_ring, ring->sq_ring_size);
+	close(ring->fd);
+}
+
+static bool __unix_uring_submit(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncRequest* req)
+{
+	struct HPCS_Uring* ring = &ctx->uring;
+	struct io_uring_sqe* sqe;
+
+	mutex_lock(&ring->lock);
+	sqe = __unix_uring_get_sqe(ring);
+	if (sqe == NULL) {
+		mutex_unlock(&ring->lock);
+		return false;
+	}
+	sqe->opcode = IORING_OP_OPENAT;
+	sqe->fd = AT_FDCWD;
+	sqe->addr = (uintptr_t)req->filename;
+	sqe->open_flags = O_RDONLY | O_CLOEXEC;
+	sqe->user_data = (uintptr_t)req;
+	__unix_uring_publish(ring);
+	__unix_uring_flush(ring);
+	mutex_unlock(&ring->lock);
+
+	return true;
+}
+#endif /* _HPCS_HAVE_IO_URING */
+
+static void __unix_unmap_measurement_file(struct HPCS_DataSource* src)
+{
+	munmap((void*)src->memory, src->size);
 }
+
 #endif
 
 
-static char* __DEFAULT_CS_REV()
+static char* __DEFAULT_CS_REV(struct HPCS_Arena** arena)
 {
 	static const char* s = "UNKNOWN_REVISION";
-	char* ns = malloc(strlen(s) + 1);
-	memset(ns, 0, strlen(s) + 1);
+	char* ns = arena_alloc(arena, strlen(s) + 1);
+	if (ns == NULL)
+		return NULL;
 	strcpy(ns, s);
 	return ns;
 }
 
-static char* __DEFAULT_CS_VER()
+static char* __DEFAULT_CS_VER(struct HPCS_Arena** arena)
 {
 	static const char* s = "UNKNOWN_VERSION";
-	char* ns = malloc(strlen(s) + 1);
-	memset(ns, 0, strlen(s) + 1);
+	char* ns = arena_alloc(arena, strlen(s) + 1);
+	if (ns == NULL)
+		return NULL;
 	strcpy(ns, s);
 	return ns;
 }
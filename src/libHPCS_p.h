@@ -16,13 +16,28 @@ typedef int bool;
 
 #ifdef _WIN32
 #include <windows.h>
-#define HPCS_NChar WCHAR
-#define HPCS_UFH FILE*
+#define HPCS_Mutex CRITICAL_SECTION
+#define HPCS_Cond CONDITION_VARIABLE
+#define HPCS_Thread HANDLE
 #else
-#include <unicode/ustdio.h>
-#include <unicode/ustring.h>
-#define HPCS_NChar UChar
-#define HPCS_UFH UFILE*
+#include <dirent.h>
+#include <pthread.h>
+#define HPCS_Mutex pthread_mutex_t
+#define HPCS_Cond pthread_cond_t
+#define HPCS_Thread pthread_t
+#endif
+#ifdef _HPCS_HAVE_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+/* SSE2 is always present on x86-64, AVX2 is detected at runtime */
+#if defined(_HPCS_ENABLE_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#define HPCS_SIMD_X86
+#ifdef _MSC_VER
+#define HPCS_TARGET_AVX2
+#else
+#define HPCS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
 #endif
 
 enum HPCS_DataCheckCode {
@@ -31,6 +46,13 @@ enum HPCS_DataCheckCode {
 	DCHECK_NO_MARKER
 };
 
+/* Segments of 30/130 signal other than a run of plain deltas */
+enum HPCS_SegmentKind {
+	SEGMENT_MARKER,
+	SEGMENT_DELTA,
+	SEGMENT_JUMP
+};
+
 enum HPCS_ParseCode {
 	PARSE_OK,
 	PARSE_E_OUT_OF_RANGE,
@@ -50,6 +72,69 @@ typedef size_t HPCS_offset;
 typedef size_t HPCS_segsize;
 #endif /* _MSC_VER */
 
+enum HPCS_SourceKind {
+	SOURCE_MEMORY,
+	SOURCE_MAPPED,
+	SOURCE_STDIO,
+	SOURCE_IO
+};
+
+/* Content of a measurement. Memory and mapped sources are accessed
+   directly, stdio and user-supplied sources are read through a buffer.
+   Memory sources may own the buffer that holds the content. */
+struct HPCS_DataSource {
+	enum HPCS_SourceKind kind;
+	const char* memory;
+	FILE* fh;
+	struct HPCS_IOSource io;
+	size_t size;
+	size_t file_size;	/* Size of the whole file, header sources contain only its beginning */
+	char* buffer;
+#ifdef _WIN32
+	HANDLE map_handle;
+#endif
+};
+
+/* Bounds-checked read cursor over a data source. The cursor exposes
+   a view of the source that is refilled on demand. */
+struct HPCS_Cursor {
+	struct HPCS_DataSource* src;
+	HPCS_offset offset;	/* Offset of the view within the source */
+	const char* view;
+	size_t available;	/* Number of bytes in the view */
+	size_t pos;		/* Position of the cursor within the view */
+};
+
+/* Open-addressing hash table of method information blocks by name. It is stored in the allocation of the blocks. */
+struct HPCS_MethodIndex {
+	size_t mask;		/* Number of slots minus one, the number of slots is a power of two */
+	size_t* slots;		/* Index of a block plus one, zero marks an empty slot */
+};
+
+/* Chunk of an arena. The chunk header is followed by the storage, allocations are never freed one by one. */
+struct HPCS_Arena {
+	struct HPCS_Arena* next;
+	size_t size;		/* Size of the storage in bytes */
+	size_t used;
+	const struct HPCS_Allocator* allocator;	/* Allocator of the chunk, NULL for the global one */
+};
+
+/* Storage reused by the reads made through a reader */
+struct HPCS_Reader {
+	struct HPCS_Arena* scratch;	/* Temporary strings of the file being read, the first chunk follows the reader */
+	char* buffer;			/* Buffer of stdio sources, allocated on first use */
+	struct HPCS_Allocator allocator;	/* Allocator of the storage of the reader if has_allocator is set */
+	bool has_allocator;
+};
+
+/* Line of a method information file. Positions and lengths are in UTF-16 code units. */
+struct HPCS_MethodInfoLine {
+	size_t name;
+	size_t name_length;
+	size_t value;
+	size_t value_length;
+};
+
 const char FILE_TYPE_ID_ADC_A[] = "ADC CHANNEL A";
 const char FILE_TYPE_ID_ADC_B[] = "ADC CHANNEL B";
 const char FILE_TYPE_ID_DAD[] = "DAD";
@@ -115,6 +200,163 @@ const HPCS_offset DATA_OFFSET_SIGSTEP_STEP_OLD = 0x284;
 const HPCS_offset DATA_OFFSET_Y_UNITS_OLD = 0x245;
 const HPCS_offset DATA_OFFSET_DEVSIG_INFO_OLD = 0x255;
 const HPCS_offset DATA_OFFSET_DATA_START_OLD = 0x400;
+/* All header fields of both LC130 and LC30 files lie within this block */
+const size_t HEADER_BLOCK_SIZE = 0x1400;
+
+typedef void (*HPCS_ThreadFunc)(void* arg);
+typedef void (*HPCS_ParallelTask)(void* ctx, const size_t idx);
+
+struct HPCS_ThreadStart {
+	HPCS_ThreadFunc func;
+	void* arg;
+};
+
+/* Range of task indices owned by one worker of parallel_for() */
+struct HPCS_WorkQueue {
+	HPCS_Mutex lock;
+	size_t head;
+	size_t tail;
+};
+
+struct HPCS_ParallelJob {
+	HPCS_ParallelTask task;
+	void* ctx;
+	struct HPCS_WorkQueue* queues;
+	size_t queue_count;
+};
+
+struct HPCS_ParallelWorker {
+	struct HPCS_ParallelJob* job;
+	size_t id;
+	struct HPCS_ThreadStart start;
+};
+
+enum HPCS_AsyncState {
+	ASYNC_LOAD,	/* File is loaded and parsed by a worker */
+	ASYNC_OPENING,	/* io_uring is opening the file */
+	ASYNC_READING,	/* io_uring is reading the file */
+	ASYNC_PARSE	/* File has been loaded, a worker parses it */
+};
+
+struct HPCS_AsyncRequest {
+	struct HPCS_AsyncRequest* next;
+	char* filename;
+	struct HPCS_MeasuredData* mdata;
+	enum HPCS_AsyncOp op;
+	void* user_data;
+	enum HPCS_RetCode code;
+	enum HPCS_AsyncState state;
+	int fd;
+	char* bytes;	/* Content of the file loaded by io_uring */
+	size_t size;	/* Number of bytes to load */
+	size_t done;	/* Number of bytes loaded so far */
+	size_t file_size;
+};
+
+#ifdef _HPCS_HAVE_IO_URING
+struct HPCS_Uring {
+	int fd;
+	HPCS_Mutex lock;	/* Protects the submission queue */
+	unsigned int* sq_head;
+	unsigned int* sq_tail_ptr;
+	unsigned int sq_tail;
+	unsigned int sq_mask;
+	unsigned int sq_entries;
+	unsigned int unsubmitted;
+	struct io_uring_sqe* sqes;
+	unsigned int* cq_head;
+	unsigned int* cq_tail;
+	unsigned int cq_mask;
+	struct io_uring_cqe* cqes;
+	void* sq_ring;
+	size_t sq_ring_size;
+	void* cq_ring;
+	size_t cq_ring_size;
+	size_t sqes_size;
+	HPCS_Thread reaper;
+	struct HPCS_ThreadStart reaper_start;
+};
+#endif
+
+struct HPCS_AsyncContext {
+	HPCS_Mutex lock;
+	HPCS_Cond work_cond;
+	HPCS_Cond done_cond;
+	struct HPCS_AsyncRequest* work_head;
+	struct HPCS_AsyncRequest* work_tail;
+	struct HPCS_AsyncRequest* done_head;
+	struct HPCS_AsyncRequest* done_tail;
+	size_t in_flight;	/* Number of submitted requests that have not completed yet */
+	bool stopping;
+	HPCS_Thread* workers;
+	size_t worker_count;
+	struct HPCS_ThreadStart worker_start;
+	int notify_fd[2];	/* Read and write end of the readiness descriptor */
+	enum HPCS_AsyncBackend backend;
+#ifdef _HPCS_HAVE_IO_URING
+	struct HPCS_Uring uring;
+#endif
+};
+
+struct HPCS_BatchIndex {
+	const char** paths;
+	size_t interval;
+	enum HPCS_RetCode* codes;
+};
+
+struct HPCS_BatchRead {
+	const char** paths;
+	struct HPCS_MeasuredData** out;
+	enum HPCS_RetCode* codes;
+};
+
+enum HPCS_DirEntryKind {
+	DIRENT_FILE,
+	DIRENT_DIR,
+	DIRENT_OTHER	/* Special files and links to directories */
+};
+
+struct HPCS_DirEntry {
+	char* name;
+	enum HPCS_DirEntryKind kind;
+};
+
+/* Directory of a run. Its files are opened relative to the directory
+   descriptor so that the path is resolved only once. */
+struct HPCS_RunDir {
+	char* path;
+#ifndef _WIN32
+	int fd;
+#endif
+};
+
+/* File of a run scheduled for loading */
+struct HPCS_RunFile {
+	size_t dir;		/* Index of the directory that contains the file */
+	struct HPCS_Run* run;
+	size_t idx;		/* Index of the trace or the method within the run */
+	size_t name_offset;	/* Offset of the name within the directory in the name reported to the caller */
+	bool is_method;
+};
+
+/* Directories and files of runs that have been scanned but not loaded yet */
+struct HPCS_RunScan {
+	struct HPCS_RunDir* dirs;
+	size_t dir_count;
+	size_t dirs_allocated;
+	struct HPCS_RunFile* files;
+	size_t file_count;
+	size_t files_allocated;
+};
+
+struct HPCS_RunTree {
+	struct HPCS_RunScan scan;
+	struct HPCS_Run** runs;
+	size_t count;
+	size_t allocated;
+	size_t max_dirs;	/* Number of directories the scan may hold open before its runs are loaded */
+	int threads;
+};
 
 /* General data file types */
 enum HPCS_GenType {
@@ -130,6 +372,129 @@ enum HPCS_GenType {
 	GENTYPE_ADC_UV2 = 131
 };
 
+/* Instruction set used to decode signals */
+enum HPCS_SimdLevel {
+	SIMD_NONE,
+	SIMD_SSE2,
+	SIMD_AVX2
+};
+
+/* Signal decoding parameters read from the file header */
+struct HPCS_SignalParams {
+	enum HPCS_GenType gentype;
+	HPCS_offset scans_start;
+	double step;
+	double shift;
+};
+
+/* Resumable state of a 30/130 signal decoder. Decoding can continue from a checkpoint
+   without reading anything that precedes it. */
+struct HPCS_Checkpoint {
+	HPCS_offset offset;	/* Offset of the next segment */
+	size_t sample_idx;	/* Index of the next sample */
+	size_t segments_read;
+	size_t next_marker_idx;
+	double value;		/* Value of the sample that precedes the next one */
+};
+
+struct HPCS_CheckpointList {
+	struct HPCS_Checkpoint* items;
+	size_t count;
+	size_t allocated;
+	bool failed;		/* Set if a checkpoint could not be stored */
+};
+
+/* Checkpoints taken every interval samples of a 30/130 signal. The index is stored in a file
+   next to the data file and is valid as long as the size and the modification time of the data
+   file match. */
+struct HPCS_SignalIndex {
+	uint64_t file_size;
+	int64_t mtime;
+	uint32_t mtime_nsec;	/* Nanoseconds within the second of the modification time */
+	size_t sample_count;
+	size_t interval;	/* Zero if the signal can be seeked to directly and needs no index */
+	struct HPCS_CheckpointList checkpoints;
+};
+
+/* Resumable state of a signal decoder. Samples can be decoded
+   in chunks of arbitrary size. */
+struct HPCS_SignalDecoder {
+	struct HPCS_Cursor* cursor;
+	struct HPCS_SignalParams params;
+	double value;		/* Last decoded value of 30/130 signal */
+	uint32_t counts;	/* Last decoded detector counts of 30/130 signal */
+	size_t segments_read;
+	size_t next_marker_idx;
+	size_t samples;		/* Index of the next sample */
+	struct HPCS_CheckpointList* checkpoints;	/* Value jumps are recorded here unless NULL */
+	bool finished;
+	enum HPCS_SimdLevel simd;
+};
+
+/* Run of samples decoded by one task of read_measurement_values_parallel() */
+struct HPCS_SignalPiece {
+	size_t first;		/* Index of the first sample */
+	size_t count;
+	enum HPCS_ParseCode pret;
+};
+
+struct HPCS_ParallelDecode {
+	struct HPCS_DataSource* src;
+	const struct HPCS_SignalParams* params;
+	const struct HPCS_CheckpointList* checkpoints;	/* Jumps of 30/130 signal the pieces start at */
+	struct HPCS_SignalPiece* pieces;
+	double* values;
+};
+
+/* State of the Largest-Triangle-Three-Buckets downsampling. Samples are collected in the next bucket,
+   a sample of the current bucket is kept once the next bucket is complete. */
+struct HPCS_Lttb {
+	struct HPCS_SampledSignal* sampled;	/* Kept samples, the times hold sample indices until the time axis is known */
+	size_t allocated;
+	size_t bucket_samples;	/* Samples between the first and the last one, split into the buckets */
+	size_t buckets;
+	size_t bucket;		/* Index of the next bucket */
+	size_t next_stop;	/* Index of the sample past the end of the next bucket */
+	double* current;
+	size_t current_start;	/* Index of the first sample of the bucket */
+	size_t current_count;
+	double* next;
+	size_t next_start;
+	size_t next_count;
+	double picked_idx;	/* Last kept sample */
+	double picked_value;
+	size_t samples;		/* Number of samples collected so far */
+};
+
+/* Decimation level of a pyramid. Only complete buckets are stored. */
+struct HPCS_PyramidLevel {
+	double* min;
+	double* max;
+	double* sum;
+	size_t count;
+};
+
+/* Level i of a pyramid holds buckets of PYRAMID_BASE << i samples. Bucket j of the level
+   starts at sample j * (PYRAMID_BASE << i). */
+#define PYRAMID_MAX_LEVELS 48
+
+struct HPCS_Pyramid {
+	const double* values;	/* Values of the signal the pyramid was built from */
+	struct HPCS_TimeAxis time;
+	struct HPCS_PyramidLevel levels[PYRAMID_MAX_LEVELS];
+	size_t levels_count;
+};
+
+struct HPCS_SignalStream {
+	struct HPCS_DataSource src;
+	struct HPCS_Cursor cursor;
+	struct HPCS_SignalDecoder decoder;
+	struct HPCS_TVPair* chunk;
+	size_t chunk_size;
+	double time;		/* Time of the next sample */
+	double time_step;
+};
+
 /* Known file descriptions */
 const char FILE_DESC_LC_DATA_FILE[] = "LC DATA FILE";
 const char FILE_DESC_GC_DATA_FILE[] = "GC DATA FILE";
@@ -159,6 +524,68 @@ const HPCS_segsize SEGMENT_SIZE = 2;
 const HPCS_segsize LARGE_SEGMENT_SIZE = 4;
 const HPCS_segsize DOUBLE_SEGMENT_SIZE = 8;
 
+/* Jump marker read as a little-endian 16-bit word */
+const short JUMP_SEGMENT_LE = 0x0080;
+
+/* Number of deltas converted at once by decode_deltas() */
+#define DELTA_BLOCK_SIZE 256
+
+/* Number of samples decoded at once before they are narrowed to single precision */
+#define NARROW_BLOCK_SIZE 1024
+
+/* Allocations from an arena are aligned for doubles */
+const size_t ARENA_ALIGNMENT = sizeof(double);
+
+/* Size of the first chunk of an arena, it holds the strings of a typical file header */
+const size_t ARENA_CHUNK_SIZE = 1024;
+
+/* Checkpoint index files. The header holds the magic, the size of the data file, its modification
+   time in seconds and the nanoseconds within that second, the number of samples, the interval and
+   the number of checkpoints. Each checkpoint
+   is stored as its offset, sample index, number of segments read, index of the next marker and
+   value. All fields are 64 bits wide and little-endian. */
+const char INDEX_FILE_EXT[] = ".idx";
+const char INDEX_MAGIC[8] = { 'H', 'P', 'C', 'S', 'I', 'D', 'X', '2' };
+#define INDEX_HEADER_SIZE 56
+#define INDEX_RECORD_SIZE 40
+
+/* Number of samples between checkpoints if the caller of hpcs_build_index() does not specify it */
+const size_t INDEX_DEFAULT_INTERVAL = 4096;
+
+/* Number of pieces per thread a signal is split into by read_measurement_values_parallel().
+   Jumps of 30/130 signal are not evenly spaced, smaller pieces balance the work better. */
+const size_t PIECES_PER_THREAD = 4;
+
+/* Number of samples in a bucket of the finest level of a pyramid */
+const size_t PYRAMID_BASE = 16;
+
+/* Size of the read buffer used by the stdio backend */
+const size_t SOURCE_BUFFER_SIZE = 64 * 1024;
+
+/* Size of the io_uring queues and the largest read submitted at once */
+const unsigned int URING_ENTRIES = 256;
+const size_t URING_MAX_READ = 1 << 30;
+
+/* Names of the files and directories that make up a run */
+const char RUN_DIR_EXT[] = ".D";
+const char RUN_METHOD_DIR_EXT[] = ".M";
+const char RUN_METHOD_EXT[] = ".MTH";
+const char RUN_TRACE_EXT[] = ".ch";
+#ifdef _WIN32
+const char PATH_SEPARATOR = '\\';
+#else
+const char PATH_SEPARATOR = '/';
+#endif
+
+/* Number of directories hpcs_read_run_tree() holds open before it loads the runs scanned so far */
+const size_t RUN_TREE_MAX_DIRS = 64;
+
+/* Storage of a signal is shrunk to fit if more than 1/SIGNAL_SHRINK_RATIO of it is unused */
+const size_t SIGNAL_SHRINK_RATIO = 8;
+
+/* Number of samples per chunk if the caller of hpcs_open_stream() does not specify it */
+const size_t STREAM_DEFAULT_CHUNK_SIZE = 4096;
+
 const double SIGSTEP_V1 = 0.1;
 const double SIGSTEP_V2 = 0.00240841663372301;
 
@@ -170,50 +597,210 @@ const char HPCS_E_UNKNOWN_TYPE_STR[] = "The specified file contains an unknown t
 const char HPCS_E_INCOMPATIBLE_FILE_STR[] = "The specified file is of type that is unreadable by libHPCS.";
 const char HPCS_E__UNKNOWN_EC_STR[] = "Unknown error code.";
 
-#ifdef _WIN32
-WCHAR EQUALITY_SIGN[] = { 0x003D, 0x0000 };
-WCHAR CR_LF[] = { 0x000A, 0x0000 }; /* Windows hides the actual end-of-line which is {0x000D, 0x000A} from us */
-#else
-UChar* EQUALITY_SIGN;
-UChar* CR_LF;
-#endif
-
-static enum HPCS_ParseCode autodetect_file_type(FILE* datafile, enum HPCS_FileType* file_type, const bool p_means_pressure, const enum HPCS_GenType gentype);
+static struct HPCS_Allocator allocator = { NULL, NULL, NULL, NULL };
+static enum HPCS_IOBackend io_backend = HPCS_IO_AUTO;
+
+static void* allocator_alloc(const struct HPCS_Allocator* allocator, const size_t size);
+static void allocator_free(const struct HPCS_Allocator* allocator, void* ptr);
+static void* arena_alloc(struct HPCS_Arena** arena, const size_t size);
+static void arena_free(struct HPCS_Arena** arena, void* ptr);
+static void arena_release(struct HPCS_Arena* chunk, const struct HPCS_Arena* keep);
+static size_t arena_round(const size_t size);
+static void async_complete(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncRequest* req);
+static void async_enqueue_work(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncRequest* req);
+static void async_free_request(struct HPCS_AsyncRequest* req);
+static void async_notify_close(struct HPCS_AsyncContext* ctx);
+static void async_notify_drain(struct HPCS_AsyncContext* ctx);
+static bool async_notify_open(struct HPCS_AsyncContext* ctx);
+static void async_notify_signal(struct HPCS_AsyncContext* ctx);
+static void async_process(struct HPCS_AsyncRequest* req);
+static void async_worker(void* arg);
+static enum HPCS_ParseCode autodetect_file_type(struct HPCS_Cursor* cursor, enum HPCS_FileType* file_type, const bool p_means_pressure, const enum HPCS_GenType gentype,
+						struct HPCS_Arena** arena);
+static bool append_bucket(struct HPCS_Envelope* envelope, size_t* allocated, const double lo, const double hi, const double mean);
+static bool append_pair(double** first, double** second, size_t* allocated, const size_t count, const double a, const double b);
+static void batch_index_task(void* ctx, const size_t idx);
+static void batch_read_task(void* ctx, const size_t idx);
+static size_t bucket_end(const size_t samples, const size_t buckets, const size_t idx);
+static size_t bucket_samples_for(const struct HPCS_SignalParams* params, const size_t file_size, size_t* buckets);
+static enum HPCS_RetCode build_signal_index(struct HPCS_DataSource* src, const size_t interval, struct HPCS_SignalIndex* index);
 static enum HPCS_DataCheckCode check_for_marker(const char* segment, size_t* const next_marker_idx, const size_t segments_read);
+static void checkpoints_add(struct HPCS_CheckpointList* list, const struct HPCS_Cursor* cursor, const double value, const size_t sample_idx,
+			    const size_t segments_read, const size_t next_marker_idx);
+static void close_data_source(struct HPCS_DataSource* src);
+static void cond_broadcast(HPCS_Cond* cond);
+static void cond_destroy(HPCS_Cond* cond);
+static bool cond_init(HPCS_Cond* cond);
+static void cond_signal(HPCS_Cond* cond);
+static void cond_wait(HPCS_Cond* cond, HPCS_Mutex* mutex);
+static int compare_dir_entries(const void* a, const void* b);
+static int cpu_count(void);
+static void cursor_init(struct HPCS_Cursor* cursor, struct HPCS_DataSource* src);
+static enum HPCS_ParseCode cursor_read(struct HPCS_Cursor* cursor, void* dst, const size_t length);
+static enum HPCS_ParseCode cursor_read_at(struct HPCS_Cursor* cursor, const HPCS_offset offset, void* dst, const size_t length);
+static enum HPCS_ParseCode cursor_read_cstring(struct HPCS_Cursor* cursor, const char** string, size_t* length);
+static enum HPCS_ParseCode cursor_require(struct HPCS_Cursor* cursor, const size_t length);
+static enum HPCS_ParseCode cursor_seek(struct HPCS_Cursor* cursor, const HPCS_offset offset);
+static enum HPCS_ParseCode decode_counts_30_130(struct HPCS_SignalDecoder* decoder, int32_t* out, const size_t capacity, size_t* decoded);
+static double decode_deltas(const char* raw, size_t count, const double step, const double shift, double value, double* out, const size_t stride,
+			    const enum HPCS_SimdLevel simd);
+static enum HPCS_ParseCode decode_signal_30_130(struct HPCS_SignalDecoder* decoder, double* out, const size_t stride, const size_t capacity, size_t* decoded);
+static enum HPCS_ParseCode decode_segment_30_130(struct HPCS_Cursor* cursor, size_t* next_marker_idx, const size_t segments_read,
+						 enum HPCS_SegmentKind* kind, int32_t* number);
+static enum HPCS_ParseCode decode_signal_179(struct HPCS_SignalDecoder* decoder, double* out, const size_t stride, const size_t capacity, size_t* decoded);
+static enum HPCS_ParseCode decoder_decode(struct HPCS_SignalDecoder* decoder, double* out, const size_t stride, const size_t capacity, size_t* decoded);
+static enum HPCS_ParseCode decoder_init(struct HPCS_SignalDecoder* decoder, struct HPCS_Cursor* cursor, const struct HPCS_SignalParams* params);
+static enum HPCS_ParseCode decoder_resume(struct HPCS_SignalDecoder* decoder, const struct HPCS_Checkpoint* checkpoint);
+static enum HPCS_ParseCode decoder_seek(struct HPCS_SignalDecoder* decoder, const size_t sample_idx, const struct HPCS_CheckpointList* checkpoints);
+static void delta_increments(const char* raw, const size_t count, const double step, const double shift, double* increments,
+			     const enum HPCS_SimdLevel simd);
+static size_t delta_run_length(const char* raw, const size_t count, const enum HPCS_SimdLevel simd);
 static enum HPCS_ChemStationVer detect_chemstation_version(const char*const version_string);
+static enum HPCS_SimdLevel detect_simd_level(void);
+static void dir_close(struct HPCS_RunDir* dir);
+static enum HPCS_ParseCode dir_entries_add(struct HPCS_DirEntry** entries, size_t* count, size_t* allocated, char* name, const enum HPCS_DirEntryKind kind);
+static void dir_entries_free(struct HPCS_DirEntry* entries, const size_t count);
+static enum HPCS_ParseCode dir_list(const struct HPCS_RunDir* dir, struct HPCS_DirEntry** entries, size_t* count);
+static bool dir_open(const struct HPCS_RunDir* parent, const char* name, struct HPCS_RunDir* dir);
+static char* duplicate_string(const char* s);
 static enum HPCS_ParseCode expand_storage(struct HPCS_TVPair** pairs, size_t* const alloc_size);
 static bool gentype_is_readable(const enum HPCS_GenType gentype);
-static enum HPCS_ParseCode fetch_signal_step(FILE * datafile, double *step, double *shift, bool old_format);
+static void* grow_array(void* array, size_t* allocated, const size_t count, const size_t elem_size);
+static bool has_extension(const char* name, const char* ext);
+static uint64_t index_get_u64(const char* bytes);
+static void index_put_u64(char* bytes, uint64_t value);
+static int LIBHPCS_CC io_fd_read(void* handle, void* dst, const size_t length, size_t* bytes_read);
+static int LIBHPCS_CC io_fd_seek(void* handle, const uint64_t offset);
+static int LIBHPCS_CC io_fd_size(void* handle, uint64_t* size);
+static int LIBHPCS_CC io_file_read(void* handle, void* dst, const size_t length, size_t* bytes_read);
+static int LIBHPCS_CC io_file_seek(void* handle, const uint64_t offset);
+static int LIBHPCS_CC io_file_size(void* handle, uint64_t* size);
+static int LIBHPCS_CC io_memory_read(void* handle, void* dst, const size_t length, size_t* bytes_read);
+static int LIBHPCS_CC io_memory_seek(void* handle, const uint64_t offset);
+static int LIBHPCS_CC io_memory_size(void* handle, uint64_t* size);
+static enum HPCS_ParseCode io_read_at(const struct HPCS_IOSource* io, const HPCS_offset offset, char* dst, const size_t length, size_t* bytes_read);
+static enum HPCS_ParseCode fetch_signal_step(struct HPCS_Cursor* cursor, double *step, double *shift, bool old_format);
+static bool file_stamp(const char* filename, uint64_t* size, int64_t* mtime, uint32_t* mtime_nsec);
 static bool file_type_description_is_readable(const char*const description);
-static enum HPCS_ParseCode next_native_line(HPCS_UFH fh, HPCS_NChar* line, int32_t length);
-static HPCS_UFH open_data_file(const char* filename);
+static char* join_path(const char* dir, const char* name);
+static enum HPCS_ParseCode latin1_to_utf8(char** target, const char* s, const size_t length, struct HPCS_Arena** arena);
+static bool load_signal_index(const char* filename, struct HPCS_SignalIndex* index);
+static bool lttb_collect(struct HPCS_Lttb* lttb, const double* values, size_t count);
+static bool lttb_finish(struct HPCS_Lttb* lttb);
+static bool lttb_keep(struct HPCS_Lttb* lttb, const size_t sample_idx, const double value);
+static double lttb_mean(const double* values, const size_t count);
+static bool lttb_pick(struct HPCS_Lttb* lttb, const double next_idx, const double next_value);
+static void lttb_rotate(struct HPCS_Lttb* lttb);
+static bool map_measurement_file(const char* filename, struct HPCS_DataSource* src);
+static bool map_measurement_stream(FILE* fh, struct HPCS_DataSource* src);
+static void* mem_alloc(const size_t size);
+static void* mem_calloc(const size_t count, const size_t size);
+static void mem_free(void* ptr);
+static void* mem_realloc(void* ptr, const size_t size);
+static void method_index_build(struct HPCS_MethodIndex* index, const struct HPCS_MethodInfoBlock* blocks, const size_t count);
+static const struct HPCS_MethodInfoBlock* method_index_find(const struct HPCS_MethodIndex* index, const struct HPCS_MethodInfoBlock* blocks, const char* name);
+static size_t method_index_hash(const char* name);
+static bool method_info_line(const char* text, const size_t units, size_t* pos, struct HPCS_MethodInfoLine* line);
+static void min_max_sum(const double* values, const size_t count, double* lo, double* hi, double* sum, const enum HPCS_SimdLevel simd);
+static enum HPCS_ParseCode open_data_source(const char* filename, struct HPCS_DataSource* src);
+static enum HPCS_ParseCode open_file_source(FILE* fh, struct HPCS_DataSource* src);
+static enum HPCS_ParseCode open_header_block(FILE* fh, struct HPCS_DataSource* src);
+static enum HPCS_ParseCode open_header_source(const char* filename, struct HPCS_DataSource* src);
+static FILE* open_index_file(const char* filename, const bool write);
+static enum HPCS_ParseCode open_io_header_source(const struct HPCS_IOSource* io, struct HPCS_DataSource* src);
+static enum HPCS_ParseCode open_io_source(const struct HPCS_IOSource* io, struct HPCS_DataSource* src);
+static void open_memory_source(const void* bytes, const size_t length, struct HPCS_DataSource* src);
 static FILE* open_measurement_file(const char* filename);
-static enum HPCS_ParseCode parse_native_method_info_line(char** name, char** value, HPCS_NChar* line);
-static enum HPCS_ParseCode read_dad_wavelength(FILE* datafile, struct HPCS_Wavelength* const measured, struct HPCS_Wavelength* const reference, const enum HPCS_GenType gentype);
+static FILE* open_measurement_file_at(const struct HPCS_RunDir* dir, const char* name);
+static enum HPCS_RetCode open_signal_stream(struct HPCS_SignalStream* stream, struct HPCS_MeasuredData* mdata, const size_t chunk_size);
+static enum HPCS_ParseCode open_stdio_source(FILE* fh, struct HPCS_DataSource* src);
+static void parallel_decode_task(void* ctx, const size_t idx);
+static enum HPCS_ParseCode parallel_for(HPCS_ParallelTask task, void* ctx, const size_t n, int threads);
+static void parallel_worker(void* arg);
+static size_t predict_sample_count(const enum HPCS_GenType gentype, const size_t scans_start, const size_t file_size);
+static bool pyramid_add_level(struct HPCS_Pyramid* pyramid, const size_t count);
+static void pyramid_reduce(const struct HPCS_Pyramid* pyramid, size_t first, const size_t end, double* lo, double* hi, double* sum);
+static enum HPCS_ParseCode read_dad_wavelength(struct HPCS_Cursor* cursor, struct HPCS_Wavelength* const measured, struct HPCS_Wavelength* const reference, const enum HPCS_GenType gentype,
+					       struct HPCS_Arena** arena);
 static uint8_t month_to_number(const char* month);
+static void mutex_destroy(HPCS_Mutex* mutex);
+static bool mutex_init(HPCS_Mutex* mutex);
+static void mutex_lock(HPCS_Mutex* mutex);
+static void mutex_unlock(HPCS_Mutex* mutex);
 static bool p_means_pressure(const enum HPCS_ChemStationVer version);
-static enum HPCS_ParseCode read_date(FILE* datafile, struct HPCS_Date* date, const enum HPCS_GenType gentype);
-static enum HPCS_ParseCode read_file_header(FILE* datafile, enum HPCS_ChemStationVer* cs_ver, struct HPCS_MeasuredData* mdata, const enum HPCS_GenType gentype);
-static enum HPCS_ParseCode read_file_type_description(FILE* datafile, char** const description, const enum HPCS_GenType gentype);
-static enum HPCS_ParseCode read_generic_type(FILE* datafile, enum HPCS_GenType* gentype);
-static enum HPCS_ParseCode read_method_info_file(HPCS_UFH fh, struct HPCS_MethodInfo* minfo);
-static enum HPCS_ParseCode read_scans_start(FILE* datafile, size_t *scans_start);
-static enum HPCS_ParseCode read_signal(FILE* datafile, struct HPCS_TVPair** pairs, size_t* pairs_count,
-				       const HPCS_offset scans_start, const double sigal_step, const double signal_shift,
-				       const enum HPCS_GenType gentype);
-static enum HPCS_ParseCode read_signal_30_130(FILE* datafile, struct HPCS_TVPair** pairs, size_t* pairs_count,
-					      const HPCS_offset scans_start, const double sigal_step, const double signal_shift);
-static enum HPCS_ParseCode read_signal_179(FILE* datafile, struct HPCS_TVPair** pairs, size_t* pairs_count,
-					   const HPCS_offset scans_start, const double sigal_step, const double signal_shift);
-static enum HPCS_ParseCode read_string_at_offset(FILE* datafile, const HPCS_offset, char** const result, const bool read_as_wchar);
-static enum HPCS_ParseCode read_timing(FILE* datafile, struct HPCS_TVPair*const pairs, double *sampling_rate, const size_t data_count,
+static enum HPCS_ParseCode read_date(struct HPCS_Cursor* cursor, struct HPCS_Date* date, const enum HPCS_GenType gentype, struct HPCS_Arena** arena);
+static enum HPCS_ParseCode read_file_header(struct HPCS_Cursor* cursor, enum HPCS_ChemStationVer* cs_ver, struct HPCS_MeasuredData* mdata, const enum HPCS_GenType gentype,
+					    struct HPCS_Arena** scratch);
+static enum HPCS_ParseCode read_file_type_description(struct HPCS_Cursor* cursor, char** const description, const enum HPCS_GenType gentype, struct HPCS_Arena** arena);
+static enum HPCS_ParseCode read_generic_type(struct HPCS_Cursor* cursor, enum HPCS_GenType* gentype);
+static enum HPCS_RetCode read_measurement(struct HPCS_DataSource* src, struct HPCS_MeasuredData* mdata, const bool header_only);
+static enum HPCS_RetCode read_measurement_envelope(struct HPCS_DataSource* src, size_t buckets, struct HPCS_MeasuredData* mdata,
+						  struct HPCS_Envelope* envelope);
+static enum HPCS_RetCode read_measurement_float(struct HPCS_DataSource* src, struct HPCS_MeasuredData* mdata, struct HPCS_FloatSignal* signal);
+static enum HPCS_RetCode read_measurement_header(struct HPCS_Cursor* cursor, struct HPCS_MeasuredData* mdata, enum HPCS_GenType* gentype,
+						 struct HPCS_Arena** scratch);
+static enum HPCS_RetCode read_measurement_lttb(struct HPCS_DataSource* src, size_t points, struct HPCS_MeasuredData* mdata,
+					      struct HPCS_SampledSignal* sampled);
+static enum HPCS_RetCode read_measurement_range(struct HPCS_DataSource* src, const double t_start, const double t_end, struct HPCS_MeasuredData* mdata,
+					       struct HPCS_Signal* signal, const struct HPCS_SignalIndex* index);
+static enum HPCS_RetCode read_measurement_raw(struct HPCS_DataSource* src, struct HPCS_MeasuredData* mdata, struct HPCS_RawSignal* raw);
+static enum HPCS_RetCode read_measurement_signal(struct HPCS_Cursor* cursor, struct HPCS_MeasuredData* mdata, const enum HPCS_GenType gentype);
+static enum HPCS_RetCode read_measurement_values(struct HPCS_DataSource* src, struct HPCS_MeasuredData* mdata, struct HPCS_Signal* signal);
+static enum HPCS_RetCode read_measurement_values_parallel(struct HPCS_DataSource* src, struct HPCS_MeasuredData* mdata, struct HPCS_Signal* signal, int threads);
+static enum HPCS_ParseCode read_method_info_file(FILE* fh, struct HPCS_MethodInfo* minfo);
+static enum HPCS_ParseCode read_scans_start(struct HPCS_Cursor* cursor, size_t *scans_start);
+static enum HPCS_ParseCode read_signal(struct HPCS_Cursor* cursor, struct HPCS_TVPair** pairs, size_t* pairs_count,
+				       const struct HPCS_SignalParams* params, struct HPCS_Arena** arena);
+static enum HPCS_ParseCode read_signal_counts(struct HPCS_Cursor* cursor, int32_t** counts, size_t* counts_count,
+					      const struct HPCS_SignalParams* params);
+static enum HPCS_ParseCode read_signal_float(struct HPCS_Cursor* cursor, float** values, size_t* values_count, const struct HPCS_SignalParams* params);
+static enum HPCS_ParseCode read_signal_params(struct HPCS_Cursor* cursor, struct HPCS_SignalParams* params);
+static enum HPCS_ParseCode read_signal_values(struct HPCS_Cursor* cursor, double** values, size_t* values_count, const struct HPCS_SignalParams* params);
+static enum HPCS_ParseCode read_string_at_offset(struct HPCS_Cursor* cursor, const HPCS_offset, char** const result, const bool read_as_wchar, struct HPCS_Arena** arena);
+static enum HPCS_ParseCode read_time_axis(struct HPCS_Cursor* cursor, const enum HPCS_GenType gentype, struct HPCS_TimeAxis* axis, double* sampling_rate);
+static enum HPCS_ParseCode read_time_range(struct HPCS_Cursor* cursor, double* xmin_minutes, double* xmax_minutes, const bool is_type_179);
+static enum HPCS_ParseCode read_timing(struct HPCS_Cursor* cursor, struct HPCS_TVPair*const pairs, double *sampling_rate, const size_t data_count,
 				       const bool is_type_179);
-static void remove_trailing_newline(HPCS_NChar* s);
-static enum HPCS_ParseCode __read_string_at_offset_v1(FILE* datafile, const HPCS_offset offset, char** const result);
-static enum HPCS_ParseCode __read_string_at_offset_v2(FILE* datafile, const HPCS_offset offset, char** const result);
-
-static char* __DEFAULT_CS_REV();
-static char* __DEFAULT_CS_VER();
+static const struct HPCS_Allocator* reader_allocator(const struct HPCS_Reader* reader);
+static struct HPCS_Arena* reader_first_chunk(struct HPCS_Reader* reader);
+static enum HPCS_ParseCode reader_open_source(struct HPCS_Reader* reader, const char* filename, struct HPCS_DataSource* src);
+static enum HPCS_ParseCode run_add_file(struct HPCS_RunScan* scan, struct HPCS_Run* run, const size_t dir_idx, const size_t idx, const size_t name_offset,
+				       const bool is_method);
+static enum HPCS_ParseCode run_add_method(struct HPCS_RunScan* scan, struct HPCS_Run* run, const size_t dir_idx, const char* prefix, const char* name,
+					 size_t* allocated);
+static enum HPCS_ParseCode run_add_trace(struct HPCS_RunScan* scan, struct HPCS_Run* run, const size_t dir_idx, const char* name, size_t* allocated);
+static struct HPCS_Run* run_alloc(const char* path);
+static enum HPCS_ParseCode run_load(struct HPCS_RunScan* scan, int threads);
+static void run_load_task(void* ctx, const size_t idx);
+static void run_read_method(const struct HPCS_RunDir* dir, const char* name, struct HPCS_RunMethod* method);
+static void run_read_trace(const struct HPCS_RunDir* dir, const char* name, struct HPCS_RunTrace* trace);
+static enum HPCS_ParseCode run_scan(struct HPCS_RunScan* scan, const size_t dir_idx, struct HPCS_Run* run);
+static void run_scan_free(struct HPCS_RunScan* scan);
+static enum HPCS_ParseCode run_scan_method_dir(struct HPCS_RunScan* scan, struct HPCS_Run* run, const size_t dir_idx, const char* name,
+					      size_t* allocated);
+static enum HPCS_ParseCode run_scan_open_dir(struct HPCS_RunScan* scan, const struct HPCS_RunDir* parent, const char* name, size_t* dir_idx);
+static enum HPCS_ParseCode run_tree_add(struct HPCS_RunTree* tree, const struct HPCS_RunDir* dir, const char* name);
+static size_t run_tree_max_dirs(void);
+static enum HPCS_ParseCode run_tree_walk(struct HPCS_RunTree* tree, const struct HPCS_RunDir* dir);
+static void scale_doubles(const char* raw, const size_t count, const double step, const double shift, char* dst, const size_t stride,
+			  const enum HPCS_SimdLevel simd);
+static void* shrink_array(void* array, const size_t allocated, const size_t count, const size_t elem_size);
+static enum HPCS_ParseCode source_view(struct HPCS_DataSource* src, const HPCS_offset offset, const size_t length, const char** view, size_t* available);
+static bool thread_create(HPCS_Thread* thread, struct HPCS_ThreadStart* start);
+static void thread_join(HPCS_Thread thread);
+static size_t time_to_sample(const struct HPCS_TimeAxis* axis, const double time);
+static size_t utf16le_put(char* dst, const char* s, const size_t units);
+static enum HPCS_ParseCode utf16le_to_utf8(char** target, const char* s, const size_t units, struct HPCS_Arena** arena);
+static size_t utf8_put(char* dst, const uint32_t cp);
+static void window_samples(const struct HPCS_TimeAxis* axis, const double t_start, const double t_end, size_t* first, size_t* end);
+static bool work_queue_pop(struct HPCS_WorkQueue* queue, size_t* task_idx);
+static bool work_queue_steal(struct HPCS_WorkQueue* queue, size_t* task_idx);
+static bool write_signal_index(const char* filename, const struct HPCS_SignalIndex* index);
+static enum HPCS_ParseCode __read_string_at_offset_v1(struct HPCS_Cursor* cursor, const HPCS_offset offset, char** const result, struct HPCS_Arena** arena);
+static enum HPCS_ParseCode __read_string_at_offset_v2(struct HPCS_Cursor* cursor, const HPCS_offset offset, char** const result, struct HPCS_Arena** arena);
+
+static char* __DEFAULT_CS_REV(struct HPCS_Arena** arena);
+static char* __DEFAULT_CS_VER(struct HPCS_Arena** arena);
 
 static bool OLD_FORMAT(const enum HPCS_GenType gentype)
 {
@@ -225,33 +812,67 @@ static bool OLD_FORMAT(const enum HPCS_GenType gentype)
 	}
 }
 
-#define DEFAULT_CS_REV __DEFAULT_CS_REV()
-#define DEFAULT_CS_VER __DEFAULT_CS_VER()
+#define DEFAULT_CS_REV(arena) __DEFAULT_CS_REV(arena)
+#define DEFAULT_CS_VER(arena) __DEFAULT_CS_VER(arena)
+
+/** Instruction set-specific functions */
+#ifdef HPCS_SIMD_X86
+static HPCS_TARGET_AVX2 size_t __avx2_delta_increments(const char* raw, const size_t count, const double step, const double shift, double* increments);
+static HPCS_TARGET_AVX2 size_t __avx2_delta_run_length(const char* raw, const size_t count);
+static HPCS_TARGET_AVX2 size_t __avx2_min_max_sum(const double* values, const size_t count, double* lo, double* hi, double* sum);
+static HPCS_TARGET_AVX2 size_t __avx2_scale_doubles(const char* raw, const size_t count, const double step, const double shift, char* dst,
+						     const size_t stride);
+static size_t __sse2_delta_increments(const char* raw, const size_t count, const double step, const double shift, double* increments);
+static size_t __sse2_delta_run_length(const char* raw, const size_t count);
+static size_t __sse2_min_max_sum(const double* values, const size_t count, double* lo, double* hi, double* sum);
+static size_t __sse2_scale_doubles(const char* raw, const size_t count, const double step, const double shift, char* dst, const size_t stride);
+#endif
 
 /** Platform-specific functions */
 #ifdef _WIN32
-static enum HPCS_ParseCode __win32_next_native_line(FILE* fh, WCHAR* line, int32_t length);
-static HPCS_UFH __win32_open_data_file(const char* filename);
-static enum HPCS_ParseCode __win32_parse_native_method_info_line(char** name, char** value, WCHAR* line);
-static enum HPCS_ParseCode __win32_latin1_to_utf8(char** target, const char *s);
+static int __win32_cpu_count(void);
+static int __win32_io_fd_read(const int fd, void* dst, const size_t length, size_t* bytes_read);
+static enum HPCS_ParseCode __win32_dir_list(const char* path, struct HPCS_DirEntry** entries, size_t* count);
+static bool __win32_dir_open(const char* path);
+static bool __win32_file_stamp(const char* filename, uint64_t* size, int64_t* mtime, uint32_t* mtime_nsec);
+static bool __win32_map_measurement_file(const char* filename, struct HPCS_DataSource* src);
+static bool __win32_map_measurement_handle(HANDLE fh, struct HPCS_DataSource* src);
+static bool __win32_thread_create(HANDLE* thread, struct HPCS_ThreadStart* start);
+static DWORD WINAPI __win32_thread_entry(LPVOID arg);
+static void __win32_unmap_measurement_file(struct HPCS_DataSource* src);
 static bool __win32_utf8_to_wchar(wchar_t** target, const char* s);
 static enum HPCS_ParseCode __win32_wchar_to_utf8(char** target, const WCHAR* s);
 #else
-static void __attribute((constructor)) __unix_hpcs_initialize();
-static void __attribute((destructor)) __unix_hpcs_destroy();
-static enum HPCS_ParseCode __unix_icu_to_utf8(char** target, const UChar* s);
-static HPCS_UFH __unix_open_data_file(const char* filename);
-static enum HPCS_ParseCode __unix_next_native_line(UFILE* fh, UChar* line, int32_t length);
-static enum HPCS_ParseCode __unix_parse_native_method_info_line(char** name, char** value, UChar* line);
-static enum HPCS_ParseCode __unix_data_to_utf8(char** target, const char* bytes, const char* encoding, const size_t bytes_count);
-
-
-#define __ICU_INIT_STRING(dst, s) do { \
-	UChar temp[64]; \
-	int32_t length = u_unescape(s, temp, sizeof(temp)); \
-	dst = calloc(length + 1, sizeof(UChar)); \
-	u_strcpy(dst, temp); \
-} while(0)
+static int __unix_cpu_count(void);
+static enum HPCS_DirEntryKind __unix_dir_entry_kind(const int fd, const struct dirent* entry);
+static enum HPCS_ParseCode __unix_dir_list(const int fd, struct HPCS_DirEntry** entries, size_t* count);
+static int __unix_dir_open(const int at_fd, const char* name, const bool nofollow);
+static bool __unix_file_stamp(const char* filename, uint64_t* size, int64_t* mtime, uint32_t* mtime_nsec);
+static FILE* __unix_fopen_at(const int dir_fd, const char* name, const char* mode);
+static int __unix_io_fd_read(const int fd, void* dst, const size_t length, size_t* bytes_read);
+static void __unix_notify_close(struct HPCS_AsyncContext* ctx);
+static void __unix_notify_drain(struct HPCS_AsyncContext* ctx);
+static bool __unix_notify_open(struct HPCS_AsyncContext* ctx);
+static void __unix_notify_signal(struct HPCS_AsyncContext* ctx);
+static bool __unix_map_measurement_fd(const int fd, struct HPCS_DataSource* src);
+static bool __unix_map_measurement_file(const char* filename, struct HPCS_DataSource* src);
+static size_t __unix_run_tree_max_dirs(void);
+static bool __unix_thread_create(pthread_t* thread, struct HPCS_ThreadStart* start);
+static void* __unix_thread_entry(void* arg);
+static void __unix_unmap_measurement_file(struct HPCS_DataSource* src);
+#ifdef _HPCS_HAVE_IO_URING
+static int __unix_uring_enter(const int fd, const unsigned int to_submit, const unsigned int min_complete, const unsigned int flags);
+static void __unix_uring_flush(struct HPCS_Uring* ring);
+static struct io_uring_sqe* __unix_uring_get_sqe(struct HPCS_Uring* ring);
+static void __unix_uring_handle(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncRequest* req, const int res);
+static bool __unix_uring_probe(const int fd);
+static void __unix_uring_publish(struct HPCS_Uring* ring);
+static bool __unix_uring_queue_read(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncRequest* req);
+static void __unix_uring_reaper(void* arg);
+static bool __unix_uring_start(struct HPCS_AsyncContext* ctx);
+static void __unix_uring_stop(struct HPCS_AsyncContext* ctx);
+static bool __unix_uring_submit(struct HPCS_AsyncContext* ctx, struct HPCS_AsyncRequest* req);
+#endif
 #endif
 
 void reverse_endianness(char* bytes, size_t sz) {
@@ -268,11 +889,13 @@ void reverse_endianness(char* bytes, size_t sz) {
 #define be_to_cpu(bytes) reverse_endianness((char*)bytes, sizeof(bytes))
 #define be_to_cpu_val(v) do { char *b = (char *)&v; const size_t sz = sizeof(v); reverse_endianness(b, sz); } while (0)
 #define le_to_cpu(bytes)
+#define le_to_cpu_val(v)
 
 #elif defined _HPCS_BIG_ENDIAN
 #define be_to_cpu(bytes)
 #define be_to_cpu_val(v)
 #define le_to_cpu(bytes) reverse_endianness((char*)bytes, sizeof(bytes))
+#define le_to_cpu_val(v) do { char *b = (char *)&v; const size_t sz = sizeof(v); reverse_endianness(b, sz); } while (0)
 #else
 #error "Endiannes has not been determined."
 #endif
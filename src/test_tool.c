@@ -22,7 +22,37 @@ static void print_header(const struct HPCS_MeasuredData *mdata)
 	       mdata->file_description);
 }
 
-static int read_data(const char* path, int raw_output)
+static char* load_file(const char* path, size_t* length)
+{
+	FILE* fh;
+	char* bytes;
+	long size;
+
+	fh = fopen(path, "rb");
+	if (fh == NULL)
+		return NULL;
+
+	fseek(fh, 0, SEEK_END);
+	size = ftell(fh);
+	fseek(fh, 0, SEEK_SET);
+	if (size < 0) {
+		fclose(fh);
+		return NULL;
+	}
+
+	bytes = malloc(size + 1);
+	if (bytes == NULL) {
+		fclose(fh);
+		return NULL;
+	}
+
+	*length = fread(bytes, 1, size, fh);
+	fclose(fh);
+
+	return bytes;
+}
+
+static int read_data(const char* path, int raw_output, int from_buffer)
 {
 	struct HPCS_MeasuredData* mdata;
 	enum HPCS_RetCode hret;
@@ -34,7 +64,18 @@ static int read_data(const char* path, int raw_output)
 		return EXIT_FAILURE;
 	}
 
-	hret = hpcs_read_mdata(path, mdata);
+	if (from_buffer) {
+		size_t length;
+		char* bytes = load_file(path, &length);
+
+		if (bytes == NULL) {
+			printf("Cannot load file\n");
+			return EXIT_FAILURE;
+		}
+		hret = hpcs_read_mdata_buffer(bytes, length, mdata);
+		free(bytes);
+	} else
+		hret = hpcs_read_mdata(path, mdata);
 	if (hret != HPCS_OK) {
 		printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
 		return EXIT_FAILURE;
@@ -78,6 +119,227 @@ static int read_header(const char* path)
 	return EXIT_SUCCESS;
 }
 
+static int read_counts(const char* path)
+{
+	struct HPCS_MeasuredData* mdata;
+	struct HPCS_RawSignal* raw;
+	enum HPCS_RetCode hret;
+	size_t di;
+
+	mdata = hpcs_alloc_mdata();
+	raw = hpcs_alloc_raw_signal();
+	if (mdata == NULL || raw == NULL) {
+		printf("Out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	hret = hpcs_read_mdata_raw(path, mdata, raw);
+	if (hret != HPCS_OK) {
+		printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+		return EXIT_FAILURE;
+	}
+
+	print_header(mdata);
+	printf("Step: %.17lg\n"
+	       "Shift: %.17lg\n"
+	       "Time axis: %.17lg + i * %.17lg\n",
+	       raw->step, raw->shift, raw->time.t0, raw->time.dt);
+
+	for (di = 0; di < raw->time.count; di++)
+		printf("%ld\n", (long)raw->counts[di]);
+
+	hpcs_free_raw_signal(raw);
+	hpcs_free_mdata(mdata);
+
+	return EXIT_SUCCESS;
+}
+
+static int read_signal(const char* path)
+{
+	struct HPCS_MeasuredData* mdata;
+	struct HPCS_Signal* signal;
+	enum HPCS_RetCode hret;
+	double times[256];
+	size_t di;
+
+	mdata = hpcs_alloc_mdata();
+	signal = hpcs_alloc_signal();
+	if (mdata == NULL || signal == NULL) {
+		printf("Out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	hret = hpcs_read_mdata_signal(path, mdata, signal);
+	if (hret != HPCS_OK) {
+		printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+		return EXIT_FAILURE;
+	}
+
+	print_header(mdata);
+
+	for (di = 0; di < signal->time.count; di++) {
+		const size_t ti = di % 256;
+
+		if (ti == 0) {
+			const size_t left = signal->time.count - di;
+			hpcs_time_axis_fill(&signal->time, di, left < 256 ? left : 256, times);
+		}
+		printf("%.17lg; %.17lg\n", times[ti], signal->values[di]);
+	}
+
+	hpcs_free_signal(signal);
+	hpcs_free_mdata(mdata);
+
+	return EXIT_SUCCESS;
+}
+
+static int read_float(const char* path)
+{
+	struct HPCS_MeasuredData* mdata;
+	struct HPCS_FloatSignal* signal;
+	enum HPCS_RetCode hret;
+	size_t di;
+
+	mdata = hpcs_alloc_mdata();
+	signal = hpcs_alloc_float_signal();
+	if (mdata == NULL || signal == NULL) {
+		printf("Out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	hret = hpcs_read_mdata_float(path, mdata, signal);
+	if (hret != HPCS_OK) {
+		printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+		return EXIT_FAILURE;
+	}
+
+	print_header(mdata);
+	printf("Time axis: %.17lg + i * %.17lg\n", signal->time.t0, signal->time.dt);
+
+	for (di = 0; di < signal->time.count; di++)
+		printf("%.9g\n", signal->values[di]);
+
+	hpcs_free_float_signal(signal);
+	hpcs_free_mdata(mdata);
+
+	return EXIT_SUCCESS;
+}
+
+/* Number of buckets and points the envelope and the downsampled trace are reduced to */
+static const size_t PLOT_WIDTH = 2000;
+
+static int read_envelope(const char* path)
+{
+	struct HPCS_MeasuredData* mdata;
+	struct HPCS_Envelope* envelope;
+	enum HPCS_RetCode hret;
+	double times[256];
+	size_t di;
+
+	mdata = hpcs_alloc_mdata();
+	envelope = hpcs_alloc_envelope();
+	if (mdata == NULL || envelope == NULL) {
+		printf("Out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	hret = hpcs_read_envelope(path, PLOT_WIDTH, mdata, envelope);
+	if (hret != HPCS_OK) {
+		printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+		return EXIT_FAILURE;
+	}
+
+	print_header(mdata);
+
+	for (di = 0; di < envelope->time.count; di++) {
+		const size_t ti = di % 256;
+
+		if (ti == 0) {
+			const size_t left = envelope->time.count - di;
+			hpcs_time_axis_fill(&envelope->time, di, left < 256 ? left : 256, times);
+		}
+		printf("%.17lg; %.17lg; %.17lg\n", times[ti], envelope->min[di], envelope->max[di]);
+	}
+
+	hpcs_free_envelope(envelope);
+	hpcs_free_mdata(mdata);
+
+	return EXIT_SUCCESS;
+}
+
+static int read_lttb(const char* path)
+{
+	struct HPCS_MeasuredData* mdata;
+	struct HPCS_SampledSignal* sampled;
+	enum HPCS_RetCode hret;
+	size_t di;
+
+	mdata = hpcs_alloc_mdata();
+	sampled = hpcs_alloc_sampled_signal();
+	if (mdata == NULL || sampled == NULL) {
+		printf("Out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	hret = hpcs_read_lttb(path, PLOT_WIDTH, mdata, sampled);
+	if (hret != HPCS_OK) {
+		printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+		return EXIT_FAILURE;
+	}
+
+	print_header(mdata);
+
+	for (di = 0; di < sampled->count; di++)
+		printf("%.17lg; %.17lg\n", sampled->times[di], sampled->values[di]);
+
+	hpcs_free_sampled_signal(sampled);
+	hpcs_free_mdata(mdata);
+
+	return EXIT_SUCCESS;
+}
+
+static int stream_data(const char* path)
+{
+	struct HPCS_MeasuredData* mdata;
+	struct HPCS_SignalStream* stream;
+	const struct HPCS_TVPair* pairs;
+	enum HPCS_RetCode hret;
+	size_t count;
+	size_t di;
+
+	mdata = hpcs_alloc_mdata();
+	if (mdata == NULL) {
+		printf("Out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	hret = hpcs_open_stream(path, mdata, 1000, &stream);
+	if (hret != HPCS_OK) {
+		printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+		return EXIT_FAILURE;
+	}
+
+	print_header(mdata);
+
+	for (;;) {
+		hret = hpcs_stream_next(stream, &pairs, &count);
+		if (hret != HPCS_OK) {
+			printf("Cannot parse file: %s\n", hpcs_error_to_string(hret));
+			break;
+		}
+		if (count == 0)
+			break;
+
+		for (di = 0; di < count; di++)
+			printf("%.17lg; %.17lg\n", pairs[di].time, pairs[di].value);
+	}
+
+	hpcs_close_stream(stream);
+	hpcs_free_mdata(mdata);
+
+	return hret == HPCS_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 static int read_info(const char* path)
 {
 	struct HPCS_MethodInfo* minfo;
@@ -106,6 +368,40 @@ static int read_info(const char* path)
 	return EXIT_SUCCESS;
 }
 
+static int read_run(const char* path)
+{
+	struct HPCS_Run* run;
+	enum HPCS_RetCode hret;
+	size_t di;
+
+	hret = hpcs_read_run(path, &run, 0);
+	if (hret != HPCS_OK) {
+		printf("Cannot read run: %s\n", hpcs_error_to_string(hret));
+		return EXIT_FAILURE;
+	}
+
+	for (di = 0; di < run->trace_count; di++) {
+		const struct HPCS_RunTrace* t = &run->traces[di];
+
+		if (t->code == HPCS_OK)
+			printf("Trace: %s (type %d, %lu points)\n", t->name, t->file_type, (unsigned long)t->mdata->data_count);
+		else
+			printf("Trace: %s - %s\n", t->name, hpcs_error_to_string(t->code));
+	}
+	for (di = 0; di < run->method_count; di++) {
+		const struct HPCS_RunMethod* m = &run->methods[di];
+
+		if (m->code == HPCS_OK)
+			printf("Method: %s (%lu entries)\n", m->name, (unsigned long)m->minfo->count);
+		else
+			printf("Method: %s - %s\n", m->name, hpcs_error_to_string(m->code));
+	}
+
+	hpcs_free_run(run);
+
+	return EXIT_SUCCESS;
+}
+
 int main(int argc, char** argv)
 {
 	const char* sel;
@@ -115,8 +411,16 @@ int main(int argc, char** argv)
 		printf("Usage: test_tool MODE FILE\n");
 		printf("MODE: d - read data file\n"
 		       "      r - read data file - raw output\n"
+		       "      b - read data file from a memory buffer\n"
+		       "      s - stream data file in chunks - raw output\n"
+		       "      c - read data file as detector counts\n"
+		       "      f - read data file in single precision\n"
+		       "      v - read data file as an array of values - raw output\n"
+		       "      e - read min/max envelope of data file - raw output\n"
+		       "      l - read data file downsampled by LTTB - raw output\n"
 		       "      i - method info\n"
 		       "      h - read header only\n"
+		       "      D - read run directory (.D)\n"
 		       "FILE: path\n");
 		return EXIT_FAILURE;
 	}
@@ -124,11 +428,27 @@ int main(int argc, char** argv)
 	sel = argv[1];
 
 	if (strcmp(sel, "d") == 0 || strcmp(sel, "r") == 0)
-		return read_data(argv[2], strcmp(sel, "r") == 0);
+		return read_data(argv[2], strcmp(sel, "r") == 0, 0);
+	else if (strcmp(sel, "b") == 0)
+		return read_data(argv[2], 0, 1);
+	else if (strcmp(sel, "s") == 0)
+		return stream_data(argv[2]);
+	else if (strcmp(sel, "c") == 0)
+		return read_counts(argv[2]);
+	else if (strcmp(sel, "f") == 0)
+		return read_float(argv[2]);
+	else if (strcmp(sel, "v") == 0)
+		return read_signal(argv[2]);
+	else if (strcmp(sel, "e") == 0)
+		return read_envelope(argv[2]);
+	else if (strcmp(sel, "l") == 0)
+		return read_lttb(argv[2]);
 	else if (strcmp(sel, "h") == 0)
 		return read_header(argv[2]);
 	else if (strcmp(sel, "i") == 0)
 		return read_info(argv[2]);
+	else if (strcmp(sel, "D") == 0)
+		return read_run(argv[2]);
 	else {
 		printf("Invalid mode argument\n");
 		return EXIT_FAILURE;